@@ -10,9 +10,16 @@ int main(void)
     keyInit();
     btim_tim5_init(10000-1,84-1);
     sram_init();                                                                /* SRAM初始化 */
-    my_mem_init(SRAMIN);                                                        /* 初始化内部SRAM内存池 */
-    my_mem_init(SRAMCCM);                                                       /* 初始化内部CCM内存池 */                                                      /* 初始化外部SRAM内存池 */               
-    my_mem_init(SRAMEX);                                                        /* 初始化外部SRAM内存池 */
+    fsmc_cal_init(0);                                                           /* 载入/校准SRAM和LCD的FSMC时序 (须在SRAMEX内存池初始化之前) */
+    dma_m2m_init();                                                             /* DMA2存储器到存储器通道初始化 */
+    xmram_boot_test();                                                          /* 外扩SRAM自检 (XMRAM_MEMTEST), 输出启动耗时 */
+    my_mem_init_lazy(SRAMIN);                                                   /* 初始化内部SRAM内存池 (延迟清零) */
+    my_mem_init_lazy(SRAMCCM);                                                  /* 初始化内部CCM内存池 (延迟清零) */
+    my_mem_init_lazy(SRAMEX);                                                   /* 初始化外部SRAM内存池 (延迟清零) */
+    lcd_fb_reserve(LCD_FB_RESERVE);                                             /* 预留帧缓冲 (默认不预留; 须在调度器启动、heap_bank 划走SRAMEX之前) */
+#if LCD_GLYPH_CACHE_NUM && LCD_GLYPH_CACHE_BOOT
+    lcd_glyph_cache_enable(1);                                                  /* 字形缓存 (CCM, 默认不开) */
+#endif
     
     freertos_demo();
 }
@@ -9,8 +9,12 @@
 #include "../driver/KEY/key.h"
 #include "../driver/delay/delay.h" 
 #include "../driver/LCD/lcd.h"
+#include "../driver/LCD/lcd_fb.h"
 #include "../driver/SRAM/sram.h"
+#include "../driver/FSMC/fsmc_cal.h"
+#include "../driver/DMA/dma.h"
 #include "../middleware/MALLOC/malloc.h"
+#include "../middleware/XMRAM/XMRAM.h"
 #include "./task/freertos_demo.h"
 
 #endif
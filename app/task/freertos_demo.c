@@ -46,6 +46,8 @@ void Start_Task(void *pvParameters)
     btim_tim3_init(10000-1,7200-1);
     btim_tim5_init(10000-1,7200-1);
 
+    my_mem_scrub_start();                                                       /* 后台清零延迟初始化的内存池 */
+
     //动态创建任务1
     xTaskCreate((TaskFunction_t )Task1,
                 (const char *   )"Task1",
@@ -25,6 +25,7 @@
 #include "../../driver/usart/usart.h"
 #include "../../driver/delay/delay.h"
 #include "../../driver/KEY/key.h"
+#include "../../middleware/MALLOC/malloc.h"
 //FreeRTOS
 #include "FreeRTOS.h"
 #include "task.h"
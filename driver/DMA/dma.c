@@ -0,0 +1,342 @@
+/**
+ ****************************************************************************************************
+ * @file        dma.c
+ * @brief       DMA2 存储器到存储器 传输驱动
+ ****************************************************************************************************
+ */
+
+#include "dma.h"
+
+#if SYS_SUPPORT_OS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+#define DMA_M2M_IRQ_PRIO        6                                           /* 中断优先级, 受FreeRTOS管理 (≥configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY) */
+#define DMA_M2M_MAX_ITEMS       0xFFFF                                      /* NDTR单次最大传输项数 */
+
+#if SYS_SUPPORT_OS
+#if (configTASK_NOTIFICATION_ARRAY_ENTRIES <= DMA_M2M_NOTIFY_INDEX)
+#error configTASK_NOTIFICATION_ARRAY_ENTRIES must be greater than DMA_M2M_NOTIFY_INDEX
+#endif
+
+/* 等待者 (在等待任务的栈上, 挂在通道的等待链表里, 完成时整条链表都被唤醒) */
+typedef struct dma_m2m_waiter
+{
+    TaskHandle_t task;                                                      /* 等待的任务 */
+    struct dma_m2m_waiter *next;                                            /* 链表中的下一个 */
+    volatile uint8_t linked;                                                /* 1: 在链表中 */
+} dma_m2m_waiter_t;
+#endif
+
+/* 通道控制块 */
+typedef struct
+{
+    DMA_HandleTypeDef hdma;                                                 /* HAL句柄 (必须放在首位, 回调里由句柄地址找回通道) */
+    uint32_t src;                                                           /* 下一段源地址 */
+    uint32_t des;                                                           /* 下一段目的地址 */
+    uint32_t remain;                                                        /* 剩余传输项数 */
+    uint32_t pattern;                                                       /* 填充值 (dma_m2m_fill的源) */
+    uint8_t flags;                                                          /* 传输标志 */
+    volatile uint8_t busy;                                                  /* 传输进行中 */
+    volatile uint8_t result;                                                /* 上次传输结果 */
+    dma_m2m_cb_t cb;                                                        /* 完成回调 */
+    void *arg;                                                              /* 回调参数 */
+#if SYS_SUPPORT_OS
+    dma_m2m_waiter_t *waiters;                                              /* 阻塞等待完成的任务 (链表) */
+#endif
+} dma_m2m_ch_t;
+
+static dma_m2m_ch_t g_dma_m2m[DMA_M2M_CH_NUM];
+static DMA_Stream_TypeDef *const g_dma_m2m_stream[DMA_M2M_CH_NUM] = {DMA2_Stream0, DMA2_Stream1, DMA2_Stream2, DMA2_Stream3};
+static const IRQn_Type g_dma_m2m_irq[DMA_M2M_CH_NUM] = {DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn};
+
+/**
+ * @brief       启动下一段传输 (每段不超过 DMA_M2M_MAX_ITEMS 项)
+ */
+static void dma_m2m_next(dma_m2m_ch_t *c)
+{
+    uint32_t n = c->remain > DMA_M2M_MAX_ITEMS ? DMA_M2M_MAX_ITEMS : c->remain;
+    uint32_t bytes = n * ((c->flags & DMA_M2M_HALFWORD) ? 2 : 4);
+
+    c->remain -= n;
+    HAL_DMA_Start_IT(&c->hdma, c->src, c->des, n);
+    if (!(c->flags & DMA_M2M_SRC_FIXED)) c->src += bytes;
+    if (!(c->flags & DMA_M2M_DST_FIXED)) c->des += bytes;
+}
+
+/**
+ * @brief       传输结束: 清忙标志, 调用回调, 唤醒等待的任务
+ */
+static void dma_m2m_done(dma_m2m_ch_t *c, uint8_t result)
+{
+    c->result = result;
+    c->busy = 0;
+    if (c->cb) c->cb(c->arg, result);
+#if SYS_SUPPORT_OS
+    if (c->waiters) {
+        BaseType_t woken = pdFALSE;
+        dma_m2m_waiter_t *w = c->waiters, *next;
+        c->waiters = NULL;
+        while (w) {                                                         /* 唤醒全部等待者 */
+            next = w->next;
+            w->linked = 0;
+            vTaskNotifyGiveIndexedFromISR(w->task, DMA_M2M_NOTIFY_INDEX, &woken);
+            w = next;
+        }
+        portYIELD_FROM_ISR(woken);
+    }
+#endif
+}
+
+/**
+ * @brief       HAL传输完成回调: 还有剩余则续传下一段
+ */
+static void dma_m2m_cplt_callback(DMA_HandleTypeDef *hdma)
+{
+    dma_m2m_ch_t *c = (dma_m2m_ch_t *)hdma;
+    if (c->remain) dma_m2m_next(c);
+    else dma_m2m_done(c, DMA_M2M_OK);
+}
+
+/**
+ * @brief       HAL传输错误回调
+ */
+static void dma_m2m_error_callback(DMA_HandleTypeDef *hdma)
+{
+    dma_m2m_ch_t *c = (dma_m2m_ch_t *)hdma;
+    c->remain = 0;
+    dma_m2m_done(c, DMA_M2M_EXFER);
+}
+
+/**
+ * @brief       初始化所有 存储器到存储器 通道
+ * @param       无
+ * @retval      无
+ */
+void dma_m2m_init(void)
+{
+    uint8_t i;
+    dma_m2m_ch_t *c;
+
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    for (i = 0; i < DMA_M2M_CH_NUM; i++) {
+        c = &g_dma_m2m[i];
+        c->hdma.Instance = g_dma_m2m_stream[i];
+        c->hdma.Init.Channel = DMA_CHANNEL_0;
+        c->hdma.Init.Direction = DMA_MEMORY_TO_MEMORY;                      /* 外设端口作源, 存储器端口作目的 */
+        c->hdma.Init.PeriphInc = DMA_PINC_ENABLE;
+        c->hdma.Init.MemInc = DMA_MINC_ENABLE;
+        c->hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+        c->hdma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+        c->hdma.Init.Mode = DMA_NORMAL;
+        c->hdma.Init.Priority = DMA_PRIORITY_LOW;
+        c->hdma.Init.FIFOMode = DMA_FIFOMODE_ENABLE;                        /* 存储器到存储器必须使用FIFO */
+        c->hdma.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+        c->hdma.Init.MemBurst = DMA_MBURST_SINGLE;
+        c->hdma.Init.PeriphBurst = DMA_PBURST_SINGLE;
+        HAL_DMA_DeInit(&c->hdma);
+        HAL_DMA_Init(&c->hdma);
+        c->hdma.XferCpltCallback = dma_m2m_cplt_callback;
+        c->hdma.XferErrorCallback = dma_m2m_error_callback;
+        c->busy = 0;
+        c->result = DMA_M2M_OK;
+
+        HAL_NVIC_SetPriority(g_dma_m2m_irq[i], DMA_M2M_IRQ_PRIO, 0);
+        HAL_NVIC_EnableIRQ(g_dma_m2m_irq[i]);
+    }
+}
+
+/**
+ * @brief       地址能否被DMA2访问
+ * @param       addr : 地址
+ * @retval      1: 可以; 0: 不可以 (CCM)
+ */
+uint8_t dma_m2m_addr_ok(const void *addr)
+{
+    uint32_t a = (uint32_t)addr;
+    return !(a >= CCMDATARAM_BASE && a <= CCMDATARAM_END);
+}
+
+/**
+ * @brief       启动传输 (异步)
+ * @param       ch      : 通道号 DMA_M2M_CH_xxx
+ * @param       des/src : 目的/源地址, 按传输位宽对齐
+ * @param       len     : 字节数, 为传输位宽的整数倍
+ * @param       flags   : DMA_M2M_HALFWORD / DMA_M2M_SRC_FIXED / DMA_M2M_DST_FIXED 的组合
+ * @param       cb      : 完成回调 (中断上下文), 可为NULL
+ * @param       arg     : 回调参数
+ * @retval      DMA_M2M_OK / DMA_M2M_EBUSY / DMA_M2M_EADDR
+ */
+static uint8_t dma_m2m_begin(uint8_t ch, void *des, const void *src, uint32_t len, uint8_t flags,
+                             dma_m2m_cb_t cb, void *arg, const uint32_t *pattern)
+{
+    dma_m2m_ch_t *c;
+    uint32_t unit = (flags & DMA_M2M_HALFWORD) ? 2 : 4;
+    uint32_t cr, primask;
+
+    if (ch >= DMA_M2M_CH_NUM || len == 0 || len % unit) return DMA_M2M_EADDR;
+    if ((uint32_t)des % unit || (uint32_t)src % unit) return DMA_M2M_EADDR;
+    if (!dma_m2m_addr_ok(des) || !dma_m2m_addr_ok((uint8_t *)des + len - 1)) return DMA_M2M_EADDR;
+    if (!pattern && (!dma_m2m_addr_ok(src) || !dma_m2m_addr_ok((const uint8_t *)src + len - 1))) return DMA_M2M_EADDR;
+
+    c = &g_dma_m2m[ch];
+    if (c->hdma.Instance == NULL) return DMA_M2M_EBUSY;                     /* 还未 dma_m2m_init */
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (c->busy) {
+        __set_PRIMASK(primask);
+        return DMA_M2M_EBUSY;
+    }
+    c->busy = 1;
+    __set_PRIMASK(primask);
+
+    if (pattern) {                                                          /* 填充: 源固定指向通道内的填充值 */
+        c->pattern = *pattern;
+        src = &c->pattern;
+        flags |= DMA_M2M_SRC_FIXED;
+    }
+    c->src = (uint32_t)src;
+    c->des = (uint32_t)des;
+    c->remain = len / unit;
+    c->flags = flags;
+    c->cb = cb;
+    c->arg = arg;
+    c->result = DMA_M2M_OK;
+
+    /* 按标志修改位宽和地址递增 (数据流此时处于关闭状态) */
+    cr = (unit == 2) ? (DMA_PDATAALIGN_HALFWORD | DMA_MDATAALIGN_HALFWORD) : (DMA_PDATAALIGN_WORD | DMA_MDATAALIGN_WORD);
+    if (!(flags & DMA_M2M_SRC_FIXED)) cr |= DMA_PINC_ENABLE;
+    if (!(flags & DMA_M2M_DST_FIXED)) cr |= DMA_MINC_ENABLE;
+    MODIFY_REG(c->hdma.Instance->CR, DMA_SxCR_PINC | DMA_SxCR_MINC | DMA_SxCR_PSIZE | DMA_SxCR_MSIZE, cr);
+
+    dma_m2m_next(c);
+    return DMA_M2M_OK;
+}
+
+uint8_t dma_m2m_start(uint8_t ch, void *des, const void *src, uint32_t len, uint8_t flags, dma_m2m_cb_t cb, void *arg)
+{
+    return dma_m2m_begin(ch, des, src, len, flags, cb, arg, NULL);
+}
+
+/**
+ * @brief       通道是否正在传输
+ * @retval      1: 忙; 0: 空闲
+ */
+uint8_t dma_m2m_busy(uint8_t ch)
+{
+    if (ch >= DMA_M2M_CH_NUM) return 0;
+    return g_dma_m2m[ch].busy;
+}
+
+/**
+ * @brief       等待通道传输完成
+ * @note        调度器运行且在任务中调用时, 阻塞在下标为 DMA_M2M_NOTIFY_INDEX 的任务通知上 (期间CPU运行其他任务,
+ *              不占用应用使用的下标0); 多个任务可以同时等待同一通道, 完成时全部唤醒.
+ *              否则查询等待. 完成回调里在同一通道上启动了下一个传输时, 继续等待下一个完成
+ * @retval      传输结果 DMA_M2M_OK / DMA_M2M_EXFER
+ */
+uint8_t dma_m2m_wait(uint8_t ch)
+{
+    dma_m2m_ch_t *c;
+    if (ch >= DMA_M2M_CH_NUM) return DMA_M2M_EADDR;
+    c = &g_dma_m2m[ch];
+
+#if SYS_SUPPORT_OS
+    if (__get_IPSR() == 0 && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        dma_m2m_waiter_t w;
+        uint32_t primask;
+
+        w.task = xTaskGetCurrentTaskHandle();
+        w.linked = 0;
+        for (;;) {
+            primask = __get_PRIMASK();
+            __disable_irq();
+            if (!c->busy) {                                                 /* 完成时链表已被清空, w 不在链表中 */
+                __set_PRIMASK(primask);
+                break;
+            }
+            if (!w.linked) {                                                /* 唤醒后 (或上次遗留的通知) 重新登记 */
+                w.next = c->waiters;
+                c->waiters = &w;
+                w.linked = 1;
+            }
+            __set_PRIMASK(primask);
+            ulTaskNotifyTakeIndexed(DMA_M2M_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+        }
+        return c->result;
+    }
+#endif
+
+    while (c->busy);
+    return c->result;
+}
+
+/**
+ * @brief       同步拷贝 (等待期间让出CPU)
+ * @retval      DMA_M2M_OK / DMA_M2M_EBUSY / DMA_M2M_EADDR / DMA_M2M_EXFER
+ */
+uint8_t dma_m2m_xfer(uint8_t ch, void *des, const void *src, uint32_t len, uint8_t flags)
+{
+    uint8_t res = dma_m2m_begin(ch, des, src, len, flags, NULL, NULL, NULL);
+    if (res != DMA_M2M_OK) return res;
+    return dma_m2m_wait(ch);
+}
+
+/**
+ * @brief       同步填充 (等待期间让出CPU)
+ * @param       pattern : 填充值, 半字传输时取低16位
+ * @retval      DMA_M2M_OK / DMA_M2M_EBUSY / DMA_M2M_EADDR / DMA_M2M_EXFER
+ */
+uint8_t dma_m2m_fill(uint8_t ch, void *des, uint32_t pattern, uint32_t len, uint8_t flags)
+{
+    uint8_t res = dma_m2m_begin(ch, des, NULL, len, flags, NULL, NULL, &pattern);
+    if (res != DMA_M2M_OK) return res;
+    return dma_m2m_wait(ch);
+}
+
+/**
+ * @brief       启动填充 (异步)
+ * @param       pattern : 填充值, 半字传输时取低16位
+ * @param       flags   : 可加 DMA_M2M_DST_FIXED (反复写同一个数据端口, 如 LCD->LCD_RAM)
+ * @param       cb/arg  : 完成回调 (中断上下文) 及参数, 可为NULL
+ * @retval      DMA_M2M_OK / DMA_M2M_EBUSY / DMA_M2M_EADDR
+ */
+uint8_t dma_m2m_fill_start(uint8_t ch, void *des, uint32_t pattern, uint32_t len, uint8_t flags, dma_m2m_cb_t cb, void *arg)
+{
+    return dma_m2m_begin(ch, des, NULL, len, flags, cb, arg, &pattern);
+}
+
+/**
+ * @brief       DMA2_Stream0中断服务函数
+ */
+void DMA2_Stream0_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&g_dma_m2m[DMA_M2M_CH_MEM].hdma);
+}
+
+/**
+ * @brief       DMA2_Stream1中断服务函数
+ */
+void DMA2_Stream1_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&g_dma_m2m[DMA_M2M_CH_SRAM].hdma);
+}
+
+/**
+ * @brief       DMA2_Stream2中断服务函数
+ */
+void DMA2_Stream2_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&g_dma_m2m[DMA_M2M_CH_STAGE].hdma);
+}
+
+/**
+ * @brief       DMA2_Stream3中断服务函数
+ */
+void DMA2_Stream3_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&g_dma_m2m[DMA_M2M_CH_LCD].hdma);
+}
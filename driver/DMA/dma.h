@@ -0,0 +1,62 @@
+/**
+ ****************************************************************************************************
+ * @file        dma.h
+ * @brief       DMA2 存储器到存储器 传输驱动
+ ****************************************************************************************************
+ * @attention
+ *
+ * 只有DMA2支持存储器到存储器传输. 本驱动提供若干个独立通道 (各占一个DMA2数据流),
+ * 单次传输长度不受NDTR(65535)限制, 由中断自动分段续传.
+ *   异步: dma_m2m_start / dma_m2m_fill_start 启动后立即返回, 完成时在中断里调用回调
+ *   同步: dma_m2m_xfer / dma_m2m_fill 等待完成, 调度器运行时调用任务阻塞在任务通知
+ *         (下标 DMA_M2M_NOTIFY_INDEX, 应用的 xTaskNotifyGive 等使用下标0, 互不影响) 上, CPU让给其他任务;
+ *         多个任务可以同时等待同一通道. 调度器启动前 或 在中断里 则查询等待
+ *
+ * 注意: CCM(0x10000000 ~ 0x1000FFFF)只有CPU能访问, DMA传输会被拒绝 (返回 DMA_M2M_EADDR);
+ *       dma_m2m_init 之前启动传输返回 DMA_M2M_EBUSY (调用者按通道不可用处理, 退回CPU)
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __DMA_H
+#define __DMA_H
+
+#ifdef MEM_HOST_BUILD
+#include <stdint.h>                                                         /* 主机编译(test/下的测试用桩实现) */
+#else
+#include "../../core/system/system_hal.h"
+#endif
+
+/* 通道定义 */
+#define DMA_M2M_CH_MEM          0                                           /* DMA2_Stream0: 内存拷贝/填充 */
+#define DMA_M2M_CH_SRAM         1                                           /* DMA2_Stream1: 外扩SRAM 批量读写 (sram_xxx_dma) */
+#define DMA_M2M_CH_STAGE        2                                           /* DMA2_Stream2: 外扩SRAM <-> 内部RAM 分级搬运 (memstage) */
+#define DMA_M2M_CH_LCD          3                                           /* DMA2_Stream3: LCD GRAM 填充 (lcd_xxx_async) */
+#define DMA_M2M_CH_NUM          4                                           /* 通道总数 */
+
+/* 传输标志 */
+#define DMA_M2M_WORD            0x00                                        /* 32位传输 (默认) */
+#define DMA_M2M_HALFWORD        0x01                                        /* 16位传输 */
+#define DMA_M2M_SRC_FIXED       0x02                                        /* 源地址不递增 (填充) */
+#define DMA_M2M_DST_FIXED       0x04                                        /* 目的地址不递增 (写外设数据寄存器) */
+
+#define DMA_M2M_NOTIFY_INDEX    1                                           /* 等待用的任务通知下标 (< configTASK_NOTIFICATION_ARRAY_ENTRIES) */
+
+/* 返回值 */
+#define DMA_M2M_OK              0
+#define DMA_M2M_EBUSY           1                                           /* 通道忙 */
+#define DMA_M2M_EADDR           2                                           /* 地址/长度不满足对齐要求 或 DMA不可访问 */
+#define DMA_M2M_EXFER           3                                           /* 传输错误 */
+
+typedef void (*dma_m2m_cb_t)(void *arg, uint8_t result);                   /* 完成回调 (中断上下文) */
+
+void dma_m2m_init(void);
+uint8_t dma_m2m_addr_ok(const void *addr);
+uint8_t dma_m2m_start(uint8_t ch, void *des, const void *src, uint32_t len, uint8_t flags, dma_m2m_cb_t cb, void *arg);
+uint8_t dma_m2m_busy(uint8_t ch);
+uint8_t dma_m2m_wait(uint8_t ch);
+uint8_t dma_m2m_xfer(uint8_t ch, void *des, const void *src, uint32_t len, uint8_t flags);
+uint8_t dma_m2m_fill(uint8_t ch, void *des, uint32_t pattern, uint32_t len, uint8_t flags);
+uint8_t dma_m2m_fill_start(uint8_t ch, void *des, uint32_t pattern, uint32_t len, uint8_t flags, dma_m2m_cb_t cb, void *arg);
+
+#endif
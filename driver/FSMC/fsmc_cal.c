@@ -0,0 +1,487 @@
+/**
+ ****************************************************************************************************
+ * @file        fsmc_cal.c
+ * @brief       FSMC 时序自动校准 (外扩SRAM / LCD 的 ADDSET、DATAST)
+ ****************************************************************************************************
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include "fsmc_cal.h"
+#include "../SRAM/sram.h"
+#include "../LCD/lcd.h"
+
+#define FSMC_CAL_SRAM_AMAX      3                                           /* SRAM 扫描的最大ADDSET */
+#define FSMC_CAL_LCD_AMAX       15                                          /* LCD读 扫描的最大ADDSET */
+#define FSMC_CAL_DATA_OFS       0x0C00                                      /* SRAM数据线走位区 (不含2的幂地址, 与地址线走位不重叠) */
+#define FSMC_CAL_BURST_OFS      0x3000                                      /* SRAM连续读写区 */
+#define FSMC_CAL_BURST          64                                          /* 连续读写的字数 */
+
+#define FSMC_CAL_BKP            (&RTC->BKP16R)                              /* 保存位置: RTC备份寄存器 BKP16R~BKP19R */
+#define FSMC_CAL_MAGIC          0x46434131                                  /* "FCA1" */
+
+#define SRAM8(ofs)              (*(volatile uint8_t *)(SRAM_BASE_ADDR + (ofs)))
+#define SRAM16(ofs)             (*(volatile uint16_t *)(SRAM_BASE_ADDR + (ofs)))
+#define SRAM32(ofs)             (*(volatile uint32_t *)(SRAM_BASE_ADDR + (ofs)))
+
+typedef uint8_t (*fsmc_cal_test_t)(const fsmc_tim_t *tim);                  /* 用给定时序校验一遍, 返回0: 通过 */
+
+fsmc_cal_t g_fsmc_cal;                                                      /* 当前使用的校准结果 */
+
+static fsmc_tim_t g_fsmc_cal_safe;                                          /* 每次校验后恢复的可靠时序 */
+static uint32_t g_fsmc_cal_seed;                                            /* 每遍不同的图形种子 */
+static uint32_t g_fsmc_cal_rand;                                            /* 伪随机数状态 */
+
+/**
+ * @brief       设置一组时序 (只改 ADDSET/DATAST, 其余位保持)
+ * @param       reg : BTR 或 BWTR 寄存器
+ * @param       tim : 时序
+ * @retval      无
+ */
+static void fsmc_cal_set(volatile uint32_t *reg, const fsmc_tim_t *tim)
+{
+    __DSB();                                                                /* 之前的总线访问全部完成后再改时序 */
+    *reg = (*reg & ~0x0000FF0FU) | tim->addset | ((uint32_t)tim->datast << 8);
+    __DSB();
+}
+
+static void fsmc_cal_get(volatile uint32_t *reg, fsmc_tim_t *tim)
+{
+    tim->addset = *reg & 0x0F;
+    tim->datast = (*reg >> 8) & 0xFF;
+}
+
+static uint32_t fsmc_cal_next(void)
+{
+    g_fsmc_cal_rand = g_fsmc_cal_rand * 1664525 + 1013904223;
+    return g_fsmc_cal_rand;
+}
+
+/**
+ * @brief       写入SRAM校验图形
+ * @param       seed : 连续读写区的随机种子
+ * @param       x    : 所有数据异或的值 (0xFFFF: 写反码, 用于清除上一遍的数据)
+ * @retval      无
+ */
+static void fsmc_cal_sram_fill(uint32_t seed, uint16_t x)
+{
+    uint32_t i, ofs;
+    uint16_t v;
+
+    for (i = 0; i < 16; i++)                                                /* 数据线走1/走0 */
+    {
+        SRAM16(FSMC_CAL_DATA_OFS + i * 4) = (1 << i) ^ x;
+        SRAM16(FSMC_CAL_DATA_OFS + i * 4 + 2) = ~(1 << i) ^ x;
+    }
+    SRAM8(FSMC_CAL_DATA_OFS + 64) = 0xA5 ^ x;                               /* 字节访问 (NBL0/NBL1) */
+    SRAM8(FSMC_CAL_DATA_OFS + 65) = 0x3C ^ x;
+
+    SRAM16(0) = 0xA000 ^ x;                                                 /* 地址线走位: 0地址和每根地址线单独为1的地址 */
+    for (ofs = 2, v = 0xA001; ofs < FSMC_CAL_SRAM_SIZE; ofs <<= 1, v++)
+    {
+        SRAM16(ofs) = v ^ x;
+    }
+
+    g_fsmc_cal_rand = seed;
+    for (i = 0; i < FSMC_CAL_BURST; i++)                                    /* 连续32位写 (每次拆成两个16位总线周期) */
+    {
+        SRAM32(FSMC_CAL_BURST_OFS + i * 4) = fsmc_cal_next() ^ x;
+    }
+}
+
+/**
+ * @brief       校验SRAM图形
+ * @retval      0: 正确; 1: 有错
+ */
+static uint8_t fsmc_cal_sram_check(uint32_t seed, uint16_t x)
+{
+    uint32_t i, ofs;
+    uint16_t v;
+
+    for (i = 0; i < 16; i++)
+    {
+        if (SRAM16(FSMC_CAL_DATA_OFS + i * 4) != (uint16_t)((1 << i) ^ x)) return 1;
+        if (SRAM16(FSMC_CAL_DATA_OFS + i * 4 + 2) != (uint16_t)(~(1 << i) ^ x)) return 1;
+    }
+    if (SRAM16(FSMC_CAL_DATA_OFS + 64) != (uint16_t)(0x3CA5 ^ x)) return 1;
+
+    if (SRAM16(0) != (uint16_t)(0xA000 ^ x)) return 1;
+    for (ofs = 2, v = 0xA001; ofs < FSMC_CAL_SRAM_SIZE; ofs <<= 1, v++)
+    {
+        if (SRAM16(ofs) != (uint16_t)(v ^ x)) return 1;                     /* 地址线开路/短路会造成混叠 */
+    }
+
+    g_fsmc_cal_rand = seed;
+    for (i = 0; i < FSMC_CAL_BURST; i++)
+    {
+        if (SRAM32(FSMC_CAL_BURST_OFS + i * 4) != (fsmc_cal_next() ^ x)) return 1;
+    }
+    return 0;
+}
+
+/* SRAM读: 用可靠的写时序写入, 待测读时序读回 */
+static uint8_t fsmc_cal_sram_rd_test(const fsmc_tim_t *tim)
+{
+    uint8_t err;
+
+    fsmc_cal_sram_fill(g_fsmc_cal_seed, 0);
+    fsmc_cal_set(&SRAM_FSMC_BTRX, tim);
+    err = fsmc_cal_sram_check(g_fsmc_cal_seed, 0);
+    fsmc_cal_set(&SRAM_FSMC_BTRX, &g_fsmc_cal_safe);
+    return err;
+}
+
+/* SRAM写: 先用可靠时序写反码 (避免上一遍的数据掩盖写错误), 再用待测写时序写入, 已校准的读时序读回 */
+static uint8_t fsmc_cal_sram_wr_test(const fsmc_tim_t *tim)
+{
+    fsmc_cal_sram_fill(g_fsmc_cal_seed, 0xFFFF);
+    fsmc_cal_set(&SRAM_FSMC_BWTRX, tim);
+    fsmc_cal_sram_fill(g_fsmc_cal_seed, 0);
+    fsmc_cal_set(&SRAM_FSMC_BWTRX, &g_fsmc_cal_safe);
+    return fsmc_cal_sram_check(g_fsmc_cal_seed, 0);
+}
+
+/* LCD校验图形: 第i个像素, 前16个走1, 后16个走0, 奇数遍取反 */
+static uint16_t fsmc_cal_lcd_pattern(uint32_t i, uint16_t x)
+{
+    uint16_t v = 1 << (i & 15);
+
+    if (i & 16) v = ~v;
+    if (g_fsmc_cal_seed & 1) v = ~v;
+    return v ^ x;
+}
+
+/**
+ * @brief       向GRAM第0行写入校验图形
+ * @note        每个像素单独设置坐标, 不依赖各控制器连续写时的地址递增方向;
+ *              tim非空时只有GRAM数据用待测写时序, 命令和坐标仍用可靠时序
+ * @param       x   : 所有像素异或的值
+ * @param       tim : 待测写时序, NULL: 不切换
+ * @retval      无
+ */
+static void fsmc_cal_lcd_fill(uint16_t x, const fsmc_tim_t *tim)
+{
+    uint32_t i;
+    uint16_t v;
+
+    for (i = 0; i < FSMC_CAL_LCD_PIXELS; i++)
+    {
+        v = fsmc_cal_lcd_pattern(i, x);
+        lcd_set_cursor(i, 0);
+        lcd_write_ram_prepare();
+
+        if (tim)
+        {
+            fsmc_cal_set(&LCD_FSMC_BWTRX, tim);
+            LCD->LCD_RAM = v;
+            fsmc_cal_set(&LCD_FSMC_BWTRX, &g_fsmc_cal_safe);
+        }
+        else
+        {
+            LCD->LCD_RAM = v;
+        }
+    }
+}
+
+static uint8_t fsmc_cal_lcd_check(uint16_t x)
+{
+    uint32_t i;
+
+    for (i = 0; i < FSMC_CAL_LCD_PIXELS; i++)
+    {
+        if ((uint16_t)lcd_read_point(i, 0) != fsmc_cal_lcd_pattern(i, x)) return 1;
+    }
+    return 0;
+}
+
+/* LCD读: 用原写时序写入, 待测读时序读回 (读点时的命令走写时序, 不受影响) */
+static uint8_t fsmc_cal_lcd_rd_test(const fsmc_tim_t *tim)
+{
+    uint8_t err;
+
+    fsmc_cal_lcd_fill(0, NULL);
+    fsmc_cal_set(&LCD_FSMC_BTRX, tim);
+    err = fsmc_cal_lcd_check(0);
+    fsmc_cal_set(&LCD_FSMC_BTRX, &g_fsmc_cal_safe);
+    return err;
+}
+
+/* LCD写: 先写反码, 再用待测写时序写GRAM数据, 已校准的读时序读回 */
+static uint8_t fsmc_cal_lcd_wr_test(const fsmc_tim_t *tim)
+{
+    fsmc_cal_lcd_fill(0xFFFF, NULL);
+    fsmc_cal_lcd_fill(0, tim);
+    return fsmc_cal_lcd_check(0);
+}
+
+/**
+ * @brief       用同一组时序连续校验若干遍
+ * @retval      0: 全部通过; 1: 有错
+ */
+static uint8_t fsmc_cal_try(fsmc_cal_test_t test, const fsmc_tim_t *tim, uint8_t passes)
+{
+    while (passes--)
+    {
+        g_fsmc_cal_seed++;
+
+        if (test(tim)) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief       扫描 ADDSET/DATAST, 取总周期 (ADDSET+DATAST) 最短的通过值, 再加余量
+ * @note        每个ADDSET从DATAST=1往上找, 最小通过值的下一档也要通过 (排除临界点上的偶然通过);
+ *              总周期不可能更短时提前结束. 加余量后的最终时序再校验 4 倍遍数
+ * @param       test : 校验函数
+ * @param       amax : 最大ADDSET
+ * @param       dmax : 最大DATAST (一般取原来的时序, 扫描结果不会比原来慢太多)
+ * @param       out  : 结果
+ * @retval      0: 成功; 1: 没有找到可用时序
+ */
+static uint8_t fsmc_cal_sweep(fsmc_cal_test_t test, uint8_t amax, uint8_t dmax, fsmc_tim_t *out)
+{
+    fsmc_tim_t t, best = {0, 1};
+    uint16_t cost = 0xFFFF;
+    uint16_t m;
+
+    for (t.addset = 0; t.addset <= amax && t.addset + 1 < cost; t.addset++)
+    {
+        for (t.datast = 1; t.datast <= dmax && t.addset + t.datast < cost; t.datast++)
+        {
+            if (fsmc_cal_try(test, &t, FSMC_CAL_PASSES)) continue;
+
+            t.datast++;
+            m = fsmc_cal_try(test, &t, FSMC_CAL_PASSES);
+            t.datast--;
+
+            if (m == 0)
+            {
+                best = t;
+                cost = t.addset + t.datast;
+                break;
+            }
+        }
+    }
+
+    if (cost == 0xFFFF) return 1;
+
+    m = best.datast * FSMC_CAL_MARGIN / 100;
+    m = best.datast + (m ? m : 1);
+    best.datast = m > 255 ? 255 : m;
+
+    if (fsmc_cal_try(test, &best, FSMC_CAL_PASSES * 4)) return 1;
+
+    *out = best;
+    return 0;
+}
+
+/**
+ * @brief       执行校准 (不保存, 不应用; 结束后恢复原来的时序)
+ * @note        改写外扩SRAM内容, 必须在 my_mem_init(SRAMEX) 之前调用
+ * @param       cal : 结果, flags 表示哪些时序有效
+ * @retval      0: SRAM和LCD都校准成功; 1: 有未成功的 (对应时序保持默认)
+ */
+uint8_t fsmc_cal_run(fsmc_cal_t *cal)
+{
+    fsmc_tim_t def_rd, def_wr;
+    uint16_t save[FSMC_CAL_LCD_PIXELS];
+    uint32_t i;
+
+    memset(cal, 0, sizeof(fsmc_cal_t));
+    cal->hclk_mhz = SystemCoreClock / 1000000;
+    cal->lcd_id = lcddev.id;
+
+    /* SRAM: 切换到扩展模式 (读写时序分开), 写时序先取原来的读写时序 */
+    fsmc_cal_get(&SRAM_FSMC_BTRX, &def_rd);
+    SRAM_FSMC_BWTRX = SRAM_FSMC_BTRX & 0x300FFFFF;                          /* ADDSET/ADDHLD/DATAST/BUSTURN/ACCMOD */
+    SRAM_FSMC_BCRX |= FSMC_BCR1_EXTMOD;
+    g_fsmc_cal_safe = def_rd;
+
+    if (fsmc_cal_try(fsmc_cal_sram_rd_test, &def_rd, FSMC_CAL_PASSES) == 0 &&
+        fsmc_cal_sweep(fsmc_cal_sram_rd_test, FSMC_CAL_SRAM_AMAX, def_rd.datast, &cal->sram_rd) == 0)
+    {
+        fsmc_cal_set(&SRAM_FSMC_BTRX, &cal->sram_rd);
+
+        if (fsmc_cal_sweep(fsmc_cal_sram_wr_test, FSMC_CAL_SRAM_AMAX, def_rd.datast, &cal->sram_wr) == 0)
+        {
+            cal->flags |= FSMC_CAL_SRAM;
+        }
+    }
+    fsmc_cal_set(&SRAM_FSMC_BTRX, &def_rd);
+
+    /* LCD: 默认时序下读回GRAM都不对的屏 (或没有接屏) 不校准 */
+    if (lcddev.width >= FSMC_CAL_LCD_PIXELS)
+    {
+        fsmc_cal_get(&LCD_FSMC_BTRX, &def_rd);
+        fsmc_cal_get(&LCD_FSMC_BWTRX, &def_wr);
+
+        for (i = 0; i < FSMC_CAL_LCD_PIXELS; i++)
+        {
+            save[i] = lcd_read_point(i, 0);
+        }
+        g_fsmc_cal_safe = def_rd;
+
+        if (fsmc_cal_try(fsmc_cal_lcd_rd_test, &def_rd, FSMC_CAL_PASSES) == 0 &&
+            fsmc_cal_sweep(fsmc_cal_lcd_rd_test, FSMC_CAL_LCD_AMAX, def_rd.datast, &cal->lcd_rd) == 0)
+        {
+            fsmc_cal_set(&LCD_FSMC_BTRX, &cal->lcd_rd);
+            g_fsmc_cal_safe = def_wr;
+
+            if (fsmc_cal_sweep(fsmc_cal_lcd_wr_test, def_wr.addset, def_wr.datast, &cal->lcd_wr) == 0)
+            {
+                cal->flags |= FSMC_CAL_LCD;
+            }
+        }
+        fsmc_cal_set(&LCD_FSMC_BTRX, &def_rd);
+
+        for (i = 0; i < FSMC_CAL_LCD_PIXELS; i++)                           /* 恢复测试用的像素 */
+        {
+            lcd_draw_point(i, 0, save[i]);
+        }
+    }
+
+    return cal->flags == (FSMC_CAL_SRAM | FSMC_CAL_LCD) ? 0 : 1;
+}
+
+/**
+ * @brief       把校准结果写入FSMC (只应用 flags 中有效的部分)
+ * @param       cal : 校准结果
+ * @retval      无
+ */
+void fsmc_cal_apply(const fsmc_cal_t *cal)
+{
+    if (cal->flags & FSMC_CAL_SRAM)
+    {
+        SRAM_FSMC_BWTRX = SRAM_FSMC_BTRX & 0x300FFFFF;
+        fsmc_cal_set(&SRAM_FSMC_BWTRX, &cal->sram_wr);
+        fsmc_cal_set(&SRAM_FSMC_BTRX, &cal->sram_rd);
+        SRAM_FSMC_BCRX |= FSMC_BCR1_EXTMOD;
+        g_sram_handler.Init.ExtendedMode = FSMC_EXTENDED_MODE_ENABLE;       /* 句柄与寄存器保持一致 */
+    }
+
+    if (cal->flags & FSMC_CAL_LCD)
+    {
+        fsmc_cal_set(&LCD_FSMC_BTRX, &cal->lcd_rd);
+        fsmc_cal_set(&LCD_FSMC_BWTRX, &cal->lcd_wr);
+    }
+}
+
+/* 备份寄存器访问: 使能PWR时钟, 解除备份域写保护 (VBAT有电池时掉电保持) */
+static void fsmc_cal_bkp_enable(void)
+{
+    __HAL_RCC_PWR_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+}
+
+static uint32_t fsmc_cal_sum(const uint32_t *w)
+{
+    uint32_t i, sum = FSMC_CAL_MAGIC;
+
+    for (i = 0; i < sizeof(fsmc_cal_t) / 4; i++)
+    {
+        sum = ((sum << 5) | (sum >> 27)) ^ w[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief       从备份寄存器载入校准结果
+ * @param       cal : 结果
+ * @retval      0: 成功; 1: 没有保存过或已损坏
+ */
+uint8_t fsmc_cal_load(fsmc_cal_t *cal)
+{
+    volatile uint32_t *bkp = FSMC_CAL_BKP;
+    uint32_t w[sizeof(fsmc_cal_t) / 4];
+    uint32_t i;
+
+    fsmc_cal_bkp_enable();
+
+    for (i = 0; i < sizeof(fsmc_cal_t) / 4; i++)
+    {
+        w[i] = bkp[i];
+    }
+
+    if (bkp[i] != fsmc_cal_sum(w)) return 1;
+
+    memcpy(cal, w, sizeof(fsmc_cal_t));
+    return 0;
+}
+
+/**
+ * @brief       保存校准结果到备份寄存器
+ * @param       cal : 校准结果
+ * @retval      无
+ */
+void fsmc_cal_save(const fsmc_cal_t *cal)
+{
+    volatile uint32_t *bkp = FSMC_CAL_BKP;
+    uint32_t w[sizeof(fsmc_cal_t) / 4];
+    uint32_t i;
+
+    memcpy(w, cal, sizeof(fsmc_cal_t));
+    fsmc_cal_bkp_enable();
+
+    for (i = 0; i < sizeof(fsmc_cal_t) / 4; i++)
+    {
+        bkp[i] = w[i];
+    }
+    bkp[i] = fsmc_cal_sum(w);
+}
+
+/**
+ * @brief       清除保存的校准结果 (下次 fsmc_cal_init 重新校准)
+ * @param       无
+ * @retval      无
+ */
+void fsmc_cal_erase(void)
+{
+    fsmc_cal_bkp_enable();
+    FSMC_CAL_BKP[sizeof(fsmc_cal_t) / 4] = 0;
+}
+
+static void fsmc_cal_print(const char *name, const fsmc_tim_t *rd, const fsmc_tim_t *wr, uint8_t ok)
+{
+    if (ok)
+    {
+        printf(" %s rd %u/%u wr %u/%u", name, rd->addset, rd->datast, wr->addset, wr->datast);
+    }
+    else
+    {
+        printf(" %s 默认", name);
+    }
+}
+
+/**
+ * @brief       载入或校准FSMC时序, 并应用
+ * @note        备份寄存器中有结果且 HCLK、LCD ID 未变时直接载入; 否则扫描校准并保存.
+ *              在 lcd_init、sram_init 之后, my_mem_init(SRAMEX) 之前调用
+ * @param       force : 1, 忽略保存的结果, 强制重新校准
+ * @retval      无
+ */
+void fsmc_cal_init(uint8_t force)
+{
+    fsmc_cal_t cal;
+    uint8_t loaded = 0;
+
+    if (!force && fsmc_cal_load(&cal) == 0 &&
+        cal.hclk_mhz == SystemCoreClock / 1000000 && cal.lcd_id == lcddev.id)
+    {
+        loaded = 1;
+    }
+    else
+    {
+        fsmc_cal_run(&cal);
+
+        if (cal.flags) fsmc_cal_save(&cal);                                 /* 全部失败时不保存, 下次上电再试 */
+    }
+
+    fsmc_cal_apply(&cal);
+    g_fsmc_cal = cal;
+
+    printf("FSMC %s (ADDSET/DATAST):", loaded ? "载入" : "校准");
+    fsmc_cal_print("SRAM", &cal.sram_rd, &cal.sram_wr, cal.flags & FSMC_CAL_SRAM);
+    fsmc_cal_print("LCD", &cal.lcd_rd, &cal.lcd_wr, cal.flags & FSMC_CAL_LCD);
+    printf("\r\n");
+}
@@ -0,0 +1,66 @@
+/**
+ ****************************************************************************************************
+ * @file        fsmc_cal.h
+ * @brief       FSMC 时序自动校准 (外扩SRAM / LCD 的 ADDSET、DATAST)
+ ****************************************************************************************************
+ * @attention
+ *
+ * sram_init / lcd_init 使用的是保守的固定时序 (SRAM 0/6, LCD 读 15/60、写 2/2 或 3/3).
+ * fsmc_cal_init 在开机时扫描 ADDSET/DATAST, 每组时序都做走位图形读写校验, 取能通过的最快时序再
+ * 加上余量 (FSMC_CAL_MARGIN), 读和写分别校准 (SRAM改用扩展模式, 读写时序分开).
+ * 结果保存在RTC备份寄存器 (VBAT供电时掉电保持), 之后上电直接载入, 不再扫描;
+ * HCLK 或 LCD ID 变化时自动重新校准.
+ *
+ * 校验方法:
+ *   SRAM: 16根数据线走1/走0, 19根地址线逐根走位查混叠, 再加一段伪随机32位连续读写
+ *   LCD : 在GRAM第0行写入走1/走0图形再读回 (读校准用慢速写, 写校准用已校准的读);
+ *         测试前保存这几个像素, 结束后恢复. 写校准只在写GRAM数据时切换时序, 命令始终用原时序,
+ *         避免错误时序把命令写坏改乱液晶配置. 读不回GRAM的屏 (读回校验在默认时序下就失败) 跳过LCD校准
+ *
+ * 注意: 扫描会改写外扩SRAM内容, 必须在 my_mem_init(SRAMEX) 之前调用.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __FSMC_CAL_H
+#define __FSMC_CAL_H
+
+#include "../../core/system/system_hal.h"
+
+#define FSMC_CAL_PASSES         4                                           /* 每组时序校验的遍数 */
+#define FSMC_CAL_MARGIN         25                                          /* DATAST余量 (%), 至少加1个HCLK */
+#define FSMC_CAL_SRAM_SIZE      (1024 * 1024)                               /* 外扩SRAM容量 (地址线走位范围) */
+#define FSMC_CAL_LCD_PIXELS     32                                          /* LCD校验用的像素数 (第0行) */
+
+#define FSMC_CAL_SRAM           0x01                                        /* flags: SRAM时序有效 */
+#define FSMC_CAL_LCD            0x02                                        /* flags: LCD时序有效 */
+
+/* 一组异步模式A时序 (单位: HCLK) */
+typedef struct
+{
+    uint8_t addset;                                                         /* 地址建立时间 ADDSET, 0~15 */
+    uint8_t datast;                                                         /* 数据建立时间 DATAST, 1~255 */
+} fsmc_tim_t;
+
+/* 校准结果 (12字节, 原样存入备份寄存器) */
+typedef struct
+{
+    fsmc_tim_t sram_rd;                                                     /* SRAM 读 */
+    fsmc_tim_t sram_wr;                                                     /* SRAM 写 */
+    fsmc_tim_t lcd_rd;                                                      /* LCD 读 */
+    fsmc_tim_t lcd_wr;                                                      /* LCD 写 */
+    uint16_t lcd_id;                                                        /* 校准时的LCD ID */
+    uint8_t hclk_mhz;                                                       /* 校准时的HCLK (MHz) */
+    uint8_t flags;                                                          /* FSMC_CAL_SRAM / FSMC_CAL_LCD */
+} fsmc_cal_t;
+
+extern fsmc_cal_t g_fsmc_cal;                                               /* 当前使用的校准结果 */
+
+void fsmc_cal_init(uint8_t force);                                          /* 载入或校准, 并应用 (force=1: 强制重新校准) */
+uint8_t fsmc_cal_run(fsmc_cal_t *cal);                                      /* 执行校准 (不保存) */
+void fsmc_cal_apply(const fsmc_cal_t *cal);                                 /* 把校准结果写入FSMC */
+uint8_t fsmc_cal_load(fsmc_cal_t *cal);                                     /* 从备份寄存器载入, 0: 成功 */
+void fsmc_cal_save(const fsmc_cal_t *cal);                                  /* 保存到备份寄存器 */
+void fsmc_cal_erase(void);                                                  /* 清除保存的结果 (下次上电重新校准) */
+
+#endif
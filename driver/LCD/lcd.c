@@ -20,10 +20,14 @@
 
 #include "stdlib.h"
 #include "lcd.h"
+#include "lcd_fb.h"
 #include "lcdfont.h"
 #include "lcd_ex.c"
 #include "../usart/usart.h"
 #include "../delay/delay.h"
+#if LCD_GLYPH_CACHE_NUM
+#include "../../middleware/MALLOC/malloc.h"
+#endif
 
 SRAM_HandleTypeDef g_sram_handle;   /* SRAM句柄(用于控制LCD) */
 
@@ -34,6 +38,9 @@ uint32_t g_back_color  = 0xFFFF;    /* 背景色 */
 /* 管理LCD重要参数 */
 _lcd_dev lcddev;
 
+/* 当前窗口不是全屏 (lcd_set_window 设置过小窗口), 下次 lcd_set_cursor 时恢复 */
+static uint8_t g_lcd_win_part;
+
 /**
  * @brief       LCD写数据
  * @param       data: 要写入的数据
@@ -115,6 +122,11 @@ uint32_t lcd_read_point(uint16_t x, uint16_t y)
         return 0;   /* 超过了范围,直接返回 */
     }
 
+    if (g_lcd_fb.buf)           /* 帧缓冲模式: 从帧缓冲读 */
+    {
+        return g_lcd_fb.buf[(uint32_t)y * g_lcd_fb.width + x];
+    }
+
     lcd_set_cursor(x, y);       /* 设置坐标 */
 
     if (lcddev.id == 0x5510)
@@ -190,6 +202,11 @@ void lcd_display_off(void)
  */
 void lcd_set_cursor(uint16_t x, uint16_t y)
 {
+    if (g_lcd_win_part && lcddev.id != 0x1963)  /* 除1963外只设置起点, 窗口终点要先恢复到屏幕边缘 */
+    {
+        lcd_set_window(0, 0, lcddev.width, lcddev.height);
+    }
+
     if (lcddev.id == 0x1963)
     {
         if (lcddev.dir == 0)    /* 竖屏模式, x坐标需要变换 */
@@ -401,6 +418,8 @@ void lcd_scan_dir(uint8_t dir)
         lcd_wr_data((lcddev.height - 1) >> 8);
         lcd_wr_data((lcddev.height - 1) & 0xFF);
     }
+
+    g_lcd_win_part = 0;
 }
 
 /**
@@ -411,6 +430,17 @@ void lcd_scan_dir(uint8_t dir)
  */
 void lcd_draw_point(uint16_t x, uint16_t y, uint32_t color)
 {
+    if (g_lcd_fb.buf)           /* 帧缓冲模式: 画到帧缓冲 */
+    {
+        if (x < g_lcd_fb.width && y < g_lcd_fb.height)
+        {
+            g_lcd_fb.buf[(uint32_t)y * g_lcd_fb.width + x] = color;
+            lcd_fb_dirty(x, y, x, y);
+        }
+
+        return;
+    }
+
     lcd_set_cursor(x, y);       /* 设置光标位置 */
     lcd_write_ram_prepare();    /* 开始写入GRAM */
     LCD->LCD_RAM = color;
@@ -523,7 +553,8 @@ void lcd_display_dir(uint8_t dir)
  * @brief       设置窗口(对RGB屏无效), 并自动设置画点坐标到窗口左上角(sx,sy).
  * @param       sx,sy:窗口起始坐标(左上角)
  * @param       width,height:窗口宽度和高度,必须大于0!!
- *   @note      窗体大小:width*height.
+ *   @note      窗体大小:width*height. 之后写GRAM时在窗口内从左到右、从上到下连续写入, 不用再设置坐标.
+ *              小窗口会一直保留到下次 lcd_set_cursor (届时恢复全屏) 或 lcd_scan_dir.
  *
  * @retval      无
  */
@@ -533,6 +564,8 @@ void lcd_set_window(uint16_t sx, uint16_t sy, uint16_t width, uint16_t height)
     twidth = sx + width - 1;
     theight = sy + height - 1;
 
+    g_lcd_win_part = (sx != 0 || sy != 0 || width != lcddev.width || height != lcddev.height);
+
    
    if (lcddev.id == 0x1963 && lcddev.dir != 1)     /* 1963竖屏特殊处理 */
     {
@@ -824,146 +857,440 @@ void lcd_init(void)
     lcd_clear(WHITE);
 }
 
+/* DMA填充/写入状态 */
+static struct
+{
+    const uint16_t *tail;           /* 最后一个像素 (DMA完成后由CPU写入), NULL: 无 */
+    volatile uint8_t busy;          /* 进行中 */
+    uint8_t result;                 /* 结果 */
+    dma_m2m_cb_t cb;                /* 完成回调 */
+    void *arg;                      /* 回调参数 */
+} g_lcd_dma;
+
 /**
- * @brief       清屏函数
- * @param       color: 要清屏的颜色
- * @retval      无
+ * @brief       DMA完成 (中断上下文), 或CPU写完
  */
-void lcd_clear(uint16_t color)
+static void lcd_dma_done(void *arg, uint8_t result)
+{
+    (void)arg;
+
+    if (g_lcd_dma.tail)
+    {
+        LCD->LCD_RAM = *g_lcd_dma.tail;
+        g_lcd_dma.tail = NULL;
+    }
+
+    g_lcd_dma.result = result;
+    g_lcd_dma.busy = 0;
+
+    if (g_lcd_dma.cb)
+    {
+        g_lcd_dma.cb(g_lcd_dma.arg, result);
+    }
+}
+
+/**
+ * @brief       占用LCD的DMA (lcd_xxx_async 和 lcd_fb_flush_async 共用), 完成时调用 lcd_dma_release
+ * @param       cb/arg: 完成回调及参数
+ * @retval      DMA_M2M_OK: 成功; DMA_M2M_EBUSY: 上一次未完成
+ */
+uint8_t lcd_dma_claim(dma_m2m_cb_t cb, void *arg)
 {
-    uint32_t index = 0;
-    uint32_t totalpoint = lcddev.width;
+    uint32_t primask = __get_PRIMASK();
 
-    totalpoint *= lcddev.height;    /* 得到总点数 */
-    lcd_set_cursor(0x00, 0x0000);   /* 设置光标位置 */
-    lcd_write_ram_prepare();        /* 开始写入GRAM */
+    __disable_irq();
 
-    for (index = 0; index < totalpoint; index++)
+    if (g_lcd_dma.busy)
     {
-        LCD->LCD_RAM = color;
+        __set_PRIMASK(primask);
+        return DMA_M2M_EBUSY;
     }
+
+    g_lcd_dma.busy = 1;
+    __set_PRIMASK(primask);
+
+    g_lcd_dma.cb = cb;
+    g_lcd_dma.arg = arg;
+    g_lcd_dma.tail = NULL;
+    return DMA_M2M_OK;
 }
 
 /**
- * @brief       在指定区域内填充单个颜色
- * @param       (sx,sy),(ex,ey):填充矩形对角坐标,区域大小为:(ex - sx + 1) * (ey - sy + 1)
- * @param       color:  要填充的颜色(32位颜色,方便兼容LTDC)
+ * @brief       释放LCD的DMA, 调用完成回调 (可在中断中调用)
+ * @param       result: DMA_M2M_OK / DMA_M2M_EXFER
  * @retval      无
  */
-void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color)
+void lcd_dma_release(uint8_t result)
+{
+    lcd_dma_done(NULL, result);
+}
+
+/**
+ * @brief       开始一次填充/写入: 占用DMA状态, 设置窗口并准备写GRAM
+ * @retval      像素数, 0: 空区域 (已调用回调) 或 上一次未完成 (*res = DMA_M2M_EBUSY)
+ */
+static uint32_t lcd_dma_begin(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, dma_m2m_cb_t cb, void *arg, uint8_t *res)
+{
+    *res = DMA_M2M_OK;
+
+    if (ex < sx || ey < sy)         /* 空区域 */
+    {
+        if (cb)
+        {
+            cb(arg, DMA_M2M_OK);
+        }
+
+        return 0;
+    }
+
+    *res = lcd_dma_claim(cb, arg);
+
+    if (*res != DMA_M2M_OK)
+    {
+        return 0;
+    }
+
+    lcd_set_window(sx, sy, ex - sx + 1, ey - sy + 1);
+    lcd_write_ram_prepare();
+    return (uint32_t)(ex - sx + 1) * (ey - sy + 1);
+}
+
+/**
+ * @brief       在指定区域内填充单个颜色 (DMA, 异步)
+ * @note        设置一次窗口后连续写入全部像素: 32位传输, 每次两个像素, 奇数个时先由CPU写一个
+ * @param       (sx,sy),(ex,ey): 填充矩形对角坐标,区域大小为:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color: 要填充的颜色
+ * @param       cb   : 完成回调 (通常在DMA中断中调用), 可为NULL, 用 lcd_dma_wait 等待
+ * @param       arg  : 回调参数
+ * @retval      DMA_M2M_OK: 已启动(或已由CPU完成); DMA_M2M_EBUSY: 上一次未完成
+ */
+uint8_t lcd_fill_async(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color, dma_m2m_cb_t cb, void *arg)
 {
-    uint16_t i, j;
-    uint16_t xlen = 0;
-    xlen = ex - sx + 1;
+    uint8_t res;
+    uint32_t npix;
 
-    for (i = sy; i <= ey; i++)
+    if (g_lcd_fb.buf)               /* 帧缓冲模式: 画到帧缓冲 */
     {
-        lcd_set_cursor(sx, i);      /* 设置光标位置 */
-        lcd_write_ram_prepare();    /* 开始写入GRAM */
+        lcd_fb_fill(sx, sy, ex, ey, color);
+
+        if (cb)
+        {
+            cb(arg, DMA_M2M_OK);
+        }
+
+        return DMA_M2M_OK;
+    }
+
+    npix = lcd_dma_begin(sx, sy, ex, ey, cb, arg, &res);
+
+    if (npix == 0)
+    {
+        return res;
+    }
+
+    if (npix >= LCD_DMA_MIN_PIXELS)
+    {
+        if (npix & 1)
+        {
+            LCD->LCD_RAM = color;
+            npix--;
+        }
 
-        for (j = 0; j < xlen; j++)
+        if (dma_m2m_fill_start(LCD_DMA_CH, (void *)&LCD->LCD_RAM, color | ((uint32_t)color << 16), npix * 2,
+                               DMA_M2M_WORD | DMA_M2M_DST_FIXED, lcd_dma_done, NULL) == DMA_M2M_OK)
         {
-            LCD->LCD_RAM = color;   /* 显示颜色 */
+            return DMA_M2M_OK;
         }
     }
+
+    while (npix--)                  /* 太小, 或DMA不可用 */
+    {
+        LCD->LCD_RAM = color;
+    }
+
+    lcd_dma_done(NULL, DMA_M2M_OK);
+    return DMA_M2M_OK;
 }
 
 /**
- * @brief       在指定区域内填充指定颜色块
- * @param       (sx,sy),(ex,ey):填充矩形对角坐标,区域大小为:(ex - sx + 1) * (ey - sy + 1)
- * @param       color: 要填充的颜色数组首地址
- * @retval      无
+ * @brief       在指定区域内填充指定颜色块 (DMA, 异步)
+ * @note        设置一次窗口后连续写入全部像素: 颜色数组按32位传输, 首像素不对齐4字节时先由CPU写一个,
+ *              剩奇数个时最后一个在完成中断里写. 数组在CCM时由CPU写
+ * @param       (sx,sy),(ex,ey): 填充矩形对角坐标,区域大小为:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color: 颜色数组 (按行存放), 完成前不能修改
+ * @param       cb/arg: 见 lcd_fill_async
+ * @retval      DMA_M2M_OK: 已启动(或已由CPU完成); DMA_M2M_EBUSY: 上一次未完成
  */
-void lcd_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t *color)
+uint8_t lcd_color_fill_async(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color, dma_m2m_cb_t cb, void *arg)
 {
-    uint16_t height, width;
-    uint16_t i, j;
+    uint8_t res;
+    uint32_t npix;
 
-    width = ex - sx + 1;            /* 得到填充的宽度 */
-    height = ey - sy + 1;           /* 高度 */
+    if (g_lcd_fb.buf)               /* 帧缓冲模式: 写入帧缓冲 */
+    {
+        lcd_fb_blit(sx, sy, ex, ey, color);
 
-    for (i = 0; i < height; i++)
+        if (cb)
+        {
+            cb(arg, DMA_M2M_OK);
+        }
+
+        return DMA_M2M_OK;
+    }
+
+    npix = lcd_dma_begin(sx, sy, ex, ey, cb, arg, &res);
+
+    if (npix == 0)
+    {
+        return res;
+    }
+
+    if (npix >= LCD_DMA_MIN_PIXELS && dma_m2m_addr_ok(color) && dma_m2m_addr_ok(color + npix - 1))
     {
-        lcd_set_cursor(sx, sy + i); /* 设置光标位置 */
-        lcd_write_ram_prepare();    /* 开始写入GRAM */
+        if ((uint32_t)color & 2)
+        {
+            LCD->LCD_RAM = *color++;
+            npix--;
+        }
+
+        if (npix & 1)
+        {
+            g_lcd_dma.tail = color + npix - 1;
+            npix--;
+        }
 
-        for (j = 0; j < width; j++)
+        if (dma_m2m_start(LCD_DMA_CH, (void *)&LCD->LCD_RAM, color, npix * 2,
+                          DMA_M2M_WORD | DMA_M2M_DST_FIXED, lcd_dma_done, NULL) == DMA_M2M_OK)
         {
-            LCD->LCD_RAM = color[i * width + j]; /* 写入数据 */
+            return DMA_M2M_OK;
+        }
+
+        if (g_lcd_dma.tail)
+        {
+            g_lcd_dma.tail = NULL;
+            npix++;
         }
     }
+
+    while (npix--)                  /* 太小, 数组在CCM, 或DMA不可用 */
+    {
+        LCD->LCD_RAM = *color++;
+    }
+
+    lcd_dma_done(NULL, DMA_M2M_OK);
+    return DMA_M2M_OK;
 }
 
 /**
- * @brief       画线
- * @param       x1,y1: 起点坐标
- * @param       x2,y2: 终点坐标
- * @param       color: 线的颜色
- * @retval      无
+ * @brief       清屏 (DMA, 异步)
+ * @param       color: 要清屏的颜色
+ * @param       cb/arg: 见 lcd_fill_async
+ * @retval      DMA_M2M_OK: 已启动(或已由CPU完成); DMA_M2M_EBUSY: 上一次未完成
  */
-void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+uint8_t lcd_clear_async(uint16_t color, dma_m2m_cb_t cb, void *arg)
 {
-    uint16_t t;
-    int xerr = 0, yerr = 0, delta_x, delta_y, distance;
-    int incx, incy, row, col;
-    delta_x = x2 - x1;      /* 计算坐标增量 */
-    delta_y = y2 - y1;
-    row = x1;
-    col = y1;
+    return lcd_fill_async(0, 0, lcddev.width - 1, lcddev.height - 1, color, cb, arg);
+}
+
+/**
+ * @brief       DMA填充/写入是否进行中
+ * @retval      1: 忙; 0: 空闲
+ */
+uint8_t lcd_dma_busy(void)
+{
+    return g_lcd_dma.busy;
+}
+
+/**
+ * @brief       等待DMA填充/写入完成 (任务中调用时阻塞让出CPU)
+ * @retval      DMA_M2M_OK / DMA_M2M_EXFER
+ */
+uint8_t lcd_dma_wait(void)
+{
+    while (g_lcd_dma.busy)
+    {
+        dma_m2m_wait(LCD_DMA_CH);
+    }
+
+    return g_lcd_dma.result;
+}
 
-    if (delta_x > 0)
+/**
+ * @brief       清屏函数
+ * @note        由DMA填充, 等待完成后返回 (帧缓冲模式下画到帧缓冲)
+ * @param       color: 要清屏的颜色
+ * @retval      无
+ */
+void lcd_clear(uint16_t color)
+{
+    if (g_lcd_fb.buf)       /* 帧缓冲模式: 画到帧缓冲, 不用等待刷新完成 */
     {
-        incx = 1;       /* 设置单步方向 */
+        lcd_clear_async(color, NULL, NULL);
+        return;
     }
-    else if (delta_x == 0)
+
+    lcd_dma_wait();
+    lcd_clear_async(color, NULL, NULL);
+    lcd_dma_wait();
+}
+
+/**
+ * @brief       在指定区域内填充单个颜色
+ * @note        由DMA填充, 等待完成后返回 (帧缓冲模式下画到帧缓冲)
+ * @param       (sx,sy),(ex,ey):填充矩形对角坐标,区域大小为:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color:  要填充的颜色(32位颜色,方便兼容LTDC)
+ * @retval      无
+ */
+void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color)
+{
+    if (g_lcd_fb.buf)       /* 帧缓冲模式: 画到帧缓冲, 不用等待刷新完成 */
     {
-        incx = 0;       /* 垂直线 */
+        lcd_fill_async(sx, sy, ex, ey, color, NULL, NULL);
+        return;
     }
-    else
+
+    lcd_dma_wait();
+    lcd_fill_async(sx, sy, ex, ey, color, NULL, NULL);
+    lcd_dma_wait();
+}
+
+/**
+ * @brief       在指定区域内填充指定颜色块
+ * @note        由DMA写入, 等待完成后返回 (帧缓冲模式下写入帧缓冲)
+ * @param       (sx,sy),(ex,ey):填充矩形对角坐标,区域大小为:(ex - sx + 1) * (ey - sy + 1)
+ * @param       color: 要填充的颜色数组首地址
+ * @retval      无
+ */
+void lcd_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t *color)
+{
+    if (g_lcd_fb.buf)       /* 帧缓冲模式: 画到帧缓冲, 不用等待刷新完成 */
     {
-        incx = -1;
-        delta_x = -delta_x;
+        lcd_color_fill_async(sx, sy, ex, ey, color, NULL, NULL);
+        return;
     }
 
-    if (delta_y > 0)
+    lcd_dma_wait();
+    lcd_color_fill_async(sx, sy, ex, ey, color, NULL, NULL);
+    lcd_dma_wait();
+}
+
+/**
+ * @brief       填充矩形, 先裁剪到屏幕内 (坐标可以为负或超出屏幕, 两角顺序任意)
+ * @note        一个窗口 (或帧缓冲中一个矩形), 直线/圆/矩形都拆成这样的段来画;
+ *              只有1~2个点的段设光标后直接写, 设窗口和DMA的开销比写这几个点还大
+ */
+static void lcd_fill_clip(int sx, int sy, int ex, int ey, uint16_t color)
+{
+    int t;
+
+    if (sx > ex)
     {
-        incy = 1;
+        t = sx;
+        sx = ex;
+        ex = t;
     }
-    else if (delta_y == 0)
+
+    if (sy > ey)
     {
-        incy = 0;       /* 水平线 */
+        t = sy;
+        sy = ey;
+        ey = t;
     }
-    else
+
+    if (ex < 0 || ey < 0 || sx >= lcddev.width || sy >= lcddev.height)
     {
-        incy = -1;
-        delta_y = -delta_y;
+        return;
     }
 
-    if ( delta_x > delta_y)
+    if (sx < 0) sx = 0;
+    if (sy < 0) sy = 0;
+    if (ex >= lcddev.width) ex = lcddev.width - 1;
+    if (ey >= lcddev.height) ey = lcddev.height - 1;
+
+    if (g_lcd_fb.buf == NULL && (ex - sx) + (ey - sy) <= 1)    /* 1~2个点 (陡线/45°线/圆接近对角线处): 设光标直接写 */
     {
-        distance = delta_x;  /* 选取基本增量坐标轴 */
+        lcd_dma_wait();
+        lcd_set_cursor(sx, sy);
+        lcd_write_ram_prepare();
+        LCD->LCD_RAM = color;
+
+        if (ey > sy)            /* 同一列的第二个点: 重设光标 */
+        {
+            lcd_set_cursor(sx, ey);
+            lcd_write_ram_prepare();
+            LCD->LCD_RAM = color;
+        }
+        else if (ex > sx)       /* 同一行的第二个点: 地址自动加1 */
+        {
+            LCD->LCD_RAM = color;
+        }
+
+        return;
     }
-    else
+
+    lcd_fill(sx, sy, ex, ey, color);
+}
+
+/**
+ * @brief       画线
+ * @note        水平/垂直线一个窗口填充; 其他方向用Bresenham算法, 沿主轴方向的连续点
+ *              (同一行或同一列) 合成一段, 每段一个窗口 (1~2个点的段直接设光标写)
+ * @param       x1,y1: 起点坐标
+ * @param       x2,y2: 终点坐标
+ * @param       color: 线的颜色
+ * @retval      无
+ */
+void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+    int dx, dy, incx, incy, err, x, y, s, n;
+
+    if (x1 == x2 || y1 == y2)   /* 垂直/水平线 */
     {
-        distance = delta_y;
+        lcd_fill_clip(x1, y1, x2, y2, color);
+        return;
     }
 
-    for (t = 0; t <= distance + 1; t++)     /* 画线输出 */
+    dx = x2 - x1;
+    dy = y2 - y1;
+    incx = (dx > 0) ? 1 : -1;   /* 单步方向 */
+    incy = (dy > 0) ? 1 : -1;
+    dx = (dx > 0) ? dx : -dx;
+    dy = (dy > 0) ? dy : -dy;
+    x = x1;
+    y = y1;
+
+    if (dx >= dy)               /* x为主轴: 同一行的连续点为一段 */
     {
-        lcd_draw_point(row, col, color);    /* 画点 */
-        xerr += delta_x;
-        yerr += delta_y;
+        err = dx / 2;
 
-        if (xerr > distance)
+        for (s = x, n = dx; n >= 0; n--, x += incx)
         {
-            xerr -= distance;
-            row += incx;
+            err -= dy;
+
+            if (err < 0 || n == 0)  /* 下一个点换行, 或终点 */
+            {
+                lcd_fill_clip(s, y, x, y, color);
+                y += incy;
+                err += dx;
+                s = x + incx;
+            }
         }
+    }
+    else                        /* y为主轴: 同一列的连续点为一段 */
+    {
+        err = dy / 2;
 
-        if (yerr > distance)
+        for (s = y, n = dy; n >= 0; n--, y += incy)
         {
-            yerr -= distance;
-            col += incy;
+            err -= dx;
+
+            if (err < 0 || n == 0)
+            {
+                lcd_fill_clip(x, s, x, y, color);
+                x += incx;
+                err += dy;
+                s = y + incy;
+            }
         }
     }
 }
@@ -977,16 +1304,34 @@ void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t
  */
 void lcd_draw_hline(uint16_t x, uint16_t y, uint16_t len, uint16_t color)
 {
-    if ((len == 0) || (x > lcddev.width) || (y > lcddev.height))
+    if (len == 0)
     {
         return;
     }
 
-    lcd_fill(x, y, x + len - 1, y, color);
+    lcd_fill_clip(x, y, x + len - 1, y, color);
+}
+
+/**
+ * @brief       画垂直线
+ * @param       x,y   : 起点坐标
+ * @param       len   : 线长度
+ * @param       color : 线的颜色
+ * @retval      无
+ */
+void lcd_draw_vline(uint16_t x, uint16_t y, uint16_t len, uint16_t color)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    lcd_fill_clip(x, y, x, y + len - 1, color);
 }
 
 /**
  * @brief       画矩形
+ * @note        上下两边各一个窗口, 左右两边不含角各一个窗口
  * @param       x1,y1: 起点坐标
  * @param       x2,y2: 终点坐标
  * @param       color: 矩形的颜色
@@ -994,14 +1339,63 @@ void lcd_draw_hline(uint16_t x, uint16_t y, uint16_t len, uint16_t color)
  */
 void lcd_draw_rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
 {
-    lcd_draw_line(x1, y1, x2, y1, color);
-    lcd_draw_line(x1, y1, x1, y2, color);
-    lcd_draw_line(x1, y2, x2, y2, color);
-    lcd_draw_line(x2, y1, x2, y2, color);
+    uint16_t t;
+
+    if (y1 > y2)
+    {
+        t = y1;
+        y1 = y2;
+        y2 = t;
+    }
+
+    lcd_fill_clip(x1, y1, x2, y1, color);
+
+    if (y2 == y1)
+    {
+        return;
+    }
+
+    lcd_fill_clip(x1, y2, x2, y2, color);
+
+    if (y2 - y1 > 1)
+    {
+        lcd_fill_clip(x1, y1 + 1, x1, y2 - 1, color);
+
+        if (x2 != x1)
+        {
+            lcd_fill_clip(x2, y1 + 1, x2, y2 - 1, color);
+        }
+    }
+}
+
+/**
+ * @brief       画圆的一段: 8个对称位置, a = a0..a1, b不变
+ * @note        上下两段是水平线, 左右两段是垂直线; a0为0时左右对称的两段合成一段
+ */
+static void lcd_circle_arc(int x0, int y0, int a0, int a1, int b, uint16_t color)
+{
+    if (a0 == 0)
+    {
+        lcd_fill_clip(x0 - a1, y0 - b, x0 + a1, y0 - b, color);
+        lcd_fill_clip(x0 - a1, y0 + b, x0 + a1, y0 + b, color);
+        lcd_fill_clip(x0 - b, y0 - a1, x0 - b, y0 + a1, color);
+        lcd_fill_clip(x0 + b, y0 - a1, x0 + b, y0 + a1, color);
+        return;
+    }
+
+    lcd_fill_clip(x0 + a0, y0 - b, x0 + a1, y0 - b, color);
+    lcd_fill_clip(x0 - a0, y0 - b, x0 - a1, y0 - b, color);
+    lcd_fill_clip(x0 + a0, y0 + b, x0 + a1, y0 + b, color);
+    lcd_fill_clip(x0 - a0, y0 + b, x0 - a1, y0 + b, color);
+    lcd_fill_clip(x0 + b, y0 - a0, x0 + b, y0 - a1, color);
+    lcd_fill_clip(x0 + b, y0 + a0, x0 + b, y0 + a1, color);
+    lcd_fill_clip(x0 - b, y0 - a0, x0 - b, y0 - a1, color);
+    lcd_fill_clip(x0 - b, y0 + a0, x0 - b, y0 + a1, color);
 }
 
 /**
  * @brief       画圆
+ * @note        Bresenham算法, b不变的连续点合成一段 (见 lcd_circle_arc), 靠近上下左右的地方一段很长
  * @param       x0,y0 : 圆中心坐标
  * @param       r     : 半径
  * @param       color : 圆的颜色
@@ -1009,40 +1403,45 @@ void lcd_draw_rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint
  */
 void lcd_draw_circle(uint16_t x0, uint16_t y0, uint8_t r, uint16_t color)
 {
-    int a, b;
+    int a, b, s, e;
     int di;
+    uint8_t dec;
 
     a = 0;
     b = r;
+    s = 0;
     di = 3 - (r << 1);       /* 判断下个点位置的标志 */
 
     while (a <= b)
     {
-        lcd_draw_point(x0 + a, y0 - b, color);  /* 5 */
-        lcd_draw_point(x0 + b, y0 - a, color);  /* 0 */
-        lcd_draw_point(x0 + b, y0 + a, color);  /* 4 */
-        lcd_draw_point(x0 + a, y0 + b, color);  /* 6 */
-        lcd_draw_point(x0 - a, y0 + b, color);  /* 1 */
-        lcd_draw_point(x0 - b, y0 + a, color);
-        lcd_draw_point(x0 - a, y0 - b, color);  /* 2 */
-        lcd_draw_point(x0 - b, y0 - a, color);  /* 7 */
-        a++;
+        e = a++;
+        dec = (di >= 0);    /* 下一个点b减1 */
 
         /* 使用Bresenham算法画圆 */
-        if (di < 0)
+        if (dec)
         {
-            di += 4 * a + 6;
+            di += 10 + 4 * (a - b);
         }
         else
         {
-            di += 10 + 4 * (a - b);
-            b--;
+            di += 4 * a + 6;
+
+            if (a <= b)
+            {
+                continue;   /* b不变, 本段继续 */
+            }
         }
+
+        lcd_circle_arc(x0, y0, s, e, b, color);
+        b -= dec;
+        s = a;
     }
 }
 
 /**
  * @brief       填充实心圆
+ * @note        与 lcd_draw_circle 同样的步进: b不变的一段 a = s..e 对应
+ *              距圆心 b 的两行 (半宽 e) 和 距圆心 s..e 的两个矩形 (半宽 b), 每个都是一个窗口填充
  * @param       x,y  : 圆中心坐标
  * @param       r    : 半径
  * @param       color: 圆的颜色
@@ -1050,105 +1449,335 @@ void lcd_draw_circle(uint16_t x0, uint16_t y0, uint8_t r, uint16_t color)
  */
 void lcd_fill_circle(uint16_t x, uint16_t y, uint16_t r, uint16_t color)
 {
-    uint32_t i;
-    uint32_t imax = ((uint32_t)r * 707) / 1000 + 1;
-    uint32_t sqmax = (uint32_t)r * (uint32_t)r + (uint32_t)r / 2;
-    uint32_t xr = r;
+    int a = 0, b = r, s = 0, e;
+    int di = 3 - 2 * (int)r;
+    uint8_t dec;
 
-    lcd_draw_hline(x - r, y, 2 * r, color);
-
-    for (i = 1; i <= imax; i++)
+    while (a <= b)
     {
-        if ((i * i + xr * xr) > sqmax)
+        e = a++;
+        dec = (di >= 0);
+
+        if (dec)
+        {
+            di += 10 + 4 * (a - b);
+        }
+        else
         {
-            /* draw lines from outside */
-            if (xr > imax)
+            di += 4 * a + 6;
+
+            if (a <= b)
             {
-                lcd_draw_hline (x - i + 1, y + xr, 2 * (i - 1), color);
-                lcd_draw_hline (x - i + 1, y - xr, 2 * (i - 1), color);
+                continue;
             }
+        }
 
-            xr--;
+        if (b > e)          /* 距圆心b的两行 (不在下面的矩形内) */
+        {
+            lcd_fill_clip(x - e, y - b, x + e, y - b, color);
+            lcd_fill_clip(x - e, y + b, x + e, y + b, color);
         }
 
-        /* draw lines from inside (center) */
-        lcd_draw_hline(x - xr, y + i, 2 * xr, color);
-        lcd_draw_hline(x - xr, y - i, 2 * xr, color);
+        if (s == 0)         /* 距圆心 s..e 的行 */
+        {
+            lcd_fill_clip(x - b, y - e, x + b, y + e, color);
+        }
+        else
+        {
+            lcd_fill_clip(x - b, y - e, x + b, y - s, color);
+            lcd_fill_clip(x - b, y + s, x + b, y + e, color);
+        }
+
+        b -= dec;
+        s = a;
     }
 }
 
+/* 字形缓存: 展开好的 前景/背景 像素 (按行存放), 放在CCM */
+#if LCD_GLYPH_CACHE_NUM
+typedef struct
+{
+    uint32_t key;                           /* 字符 | 字号<<8, 0: 空 */
+    uint32_t color;                         /* 前景 | 背景<<16 */
+    uint32_t stamp;                         /* 最近使用时间 (LRU) */
+    uint16_t pix[LCD_GLYPH_MAX_PIXELS];     /* 像素 */
+} lcd_glyph_slot_t;
+
+static lcd_glyph_slot_t *g_glyph_cache;     /* NULL: 未启用 */
+static uint32_t g_glyph_stamp;
+lcd_glyph_stats_t g_glyph_stats;
+#endif
+
 /**
- * @brief       在指定位置显示一个字符
- * @param       x,y  : 坐标
- * @param       chr  : 要显示的字符:" "--->"~"
- * @param       size : 字体大小 12/16/24/32
- * @param       mode : 叠加方式(1); 非叠加方式(0);
- * @param       color : 字符的颜色;
- * @retval      无
+ * @brief       取字符的点阵
+ * @note        点阵按列存放: 每列 (size + 7) / 8 字节, 高位在上; 共 size / 2 列
+ * @retval      点阵首地址, NULL: 字号或字符不支持
  */
-void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color)
+static const uint8_t *lcd_glyph_font(char chr, uint8_t size)
 {
-    uint8_t temp, t1, t;
-    uint16_t y0 = y;
-    uint8_t csize = 0;
-    uint8_t *pfont = 0;
+    if (chr < ' ' || chr > '~')
+    {
+        return NULL;
+    }
 
-    csize = (size / 8 + ((size % 8) ? 1 : 0)) * (size / 2); /* 得到字体一个字符对应点阵集所占的字节数 */
-    chr = chr - ' ';    /* 得到偏移后的值（ASCII字库是从空格开始取模，所以-' '就是对应字符的字库） */
+    chr = chr - ' ';    /* ASCII字库是从空格开始取模 */
 
     switch (size)
     {
         case 12:
-            pfont = (uint8_t *)asc2_1206[chr];  /* 调用1206字体 */
-            break;
+            return asc2_1206[(uint8_t)chr];
 
         case 16:
-            pfont = (uint8_t *)asc2_1608[chr];  /* 调用1608字体 */
-            break;
+            return asc2_1608[(uint8_t)chr];
 
         case 24:
-            pfont = (uint8_t *)asc2_2412[chr];  /* 调用2412字体 */
-            break;
+            return asc2_2412[(uint8_t)chr];
 
         case 32:
-            pfont = (uint8_t *)asc2_3216[chr];  /* 调用3216字体 */
-            break;
+            return asc2_3216[(uint8_t)chr];
 
         default:
-            return ;
+            return NULL;
+    }
+}
+
+#if LCD_GLYPH_CACHE_NUM
+/**
+ * @brief       开启/关闭字形缓存
+ * @note        开启时从CCM内存池申请 LCD_GLYPH_CACHE_NUM 个槽 (须在 my_mem_init(SRAMCCM) 之后)
+ * @param       en: 1, 开启; 0, 关闭并释放
+ * @retval      0, 成功; 1, 内存不足
+ */
+uint8_t lcd_glyph_cache_enable(uint8_t en)
+{
+    if (!en)
+    {
+        myfree(SRAMCCM, g_glyph_cache);
+        g_glyph_cache = NULL;
+        return 0;
+    }
+
+    if (g_glyph_cache == NULL)
+    {
+        g_glyph_cache = mycalloc(SRAMCCM, LCD_GLYPH_CACHE_NUM, sizeof(lcd_glyph_slot_t));
+    }
+
+    return g_glyph_cache == NULL;
+}
+
+/**
+ * @brief       从缓存取展开好的字形, 没有时展开到最久未用的槽
+ * @note        一段字符串最多 LCD_GLYPH_RUN_MAX 个字符, 同时用到的槽都是最近使用的, 不会被替换
+ * @retval      按行存放的 (size / 2) * size 个像素
+ */
+static const uint16_t *lcd_glyph_cached(const uint8_t *pfont, char chr, uint8_t size, uint16_t fg, uint16_t bg)
+{
+    lcd_glyph_slot_t *slot, *old = g_glyph_cache;
+    uint32_t key = (uint8_t)chr | ((uint32_t)size << 8);
+    uint32_t color = fg | ((uint32_t)bg << 16);
+    uint16_t i, r, c, w = size / 2, cb = (size + 7) / 8;
+
+    for (i = 0; i < LCD_GLYPH_CACHE_NUM; i++)
+    {
+        slot = &g_glyph_cache[i];
+
+        if (slot->key == key && slot->color == color)
+        {
+            slot->stamp = ++g_glyph_stamp;
+            g_glyph_stats.hits++;
+            return slot->pix;
+        }
+
+        if (slot->stamp < old->stamp)
+        {
+            old = slot;
+        }
+    }
+
+    old->key = key;
+    old->color = color;
+    old->stamp = ++g_glyph_stamp;
+    g_glyph_stats.misses++;
+
+    for (c = 0; c < w; c++)                 /* 列优先点阵 -> 按行存放的像素 */
+    {
+        for (r = 0; r < size; r++)
+        {
+            old->pix[r * w + c] = (pfont[c * cb + (r >> 3)] & (0x80 >> (r & 7))) ? fg : bg;
+        }
+    }
+
+    return old->pix;
+}
+#endif
+
+/**
+ * @brief       非叠加方式显示同一行上的连续字符
+ * @note        每 LCD_GLYPH_RUN_MAX 个字符设置一次窗口 (超出屏幕的部分裁掉), 然后逐行连续写入
+ *              前景/背景像素 (帧缓冲模式下写入帧缓冲); 字形缓存开启时从缓存取展开好的像素, 否则边读点阵边展开
+ * @param       x,y  : 第一个字符的坐标
+ * @param       p    : 字符, 须都是字库中有的字符 (" "--->"~")
+ * @param       n    : 字符数
+ * @param       size : 字体大小 12/16/24/32
+ * @param       fg,bg: 前景色, 背景色
+ * @retval      无
+ */
+static void lcd_show_run(uint16_t x, uint16_t y, const char *p, uint16_t n, uint8_t size, uint16_t fg, uint16_t bg)
+{
+    const uint8_t *font[LCD_GLYPH_RUN_MAX];
+#if LCD_GLYPH_CACHE_NUM
+    const uint16_t *pix[LCD_GLYPH_RUN_MAX];
+#endif
+    uint16_t w = size / 2, cb = (size + 7) / 8;
+    uint16_t h, k, i, r, c, cols, vw;
+    volatile uint16_t *out = &LCD->LCD_RAM;     /* 写入位置: 屏幕数据口 (不递增) 或 帧缓冲 */
+    uint8_t inc = 0, bit;
+
+    if (y >= lcddev.height || lcd_glyph_font(' ', size) == NULL)
+    {
+        return;
     }
 
-    for (t = 0; t < csize; t++)
+    h = (lcddev.height - y < size) ? lcddev.height - y : size;
+
+    if (g_lcd_fb.buf)
     {
-        temp = pfont[t];                            /* 获取字符的点阵数据 */
+        inc = 1;
+    }
+    else
+    {
+        lcd_dma_wait();
+    }
 
-        for (t1 = 0; t1 < 8; t1++)                  /* 一个字节8个点 */
+    while (n && x < lcddev.width)
+    {
+        k = (n < LCD_GLYPH_RUN_MAX) ? n : LCD_GLYPH_RUN_MAX;
+        vw = (lcddev.width - x < k * w) ? lcddev.width - x : k * w;     /* 可见宽度 */
+        k = (vw + w - 1) / w;                                           /* 可见的字符数 */
+
+        for (i = 0; i < k; i++)
+        {
+            font[i] = lcd_glyph_font(p[i], size);
+#if LCD_GLYPH_CACHE_NUM
+            pix[i] = g_glyph_cache ? lcd_glyph_cached(font[i], p[i], size, fg, bg) : NULL;
+#endif
+        }
+
+        if (inc)
         {
-            if (temp & 0x80)                        /* 有效点,需要显示 */
+            lcd_fb_dirty(x, y, x + vw - 1, y + h - 1);
+        }
+        else
+        {
+            lcd_set_window(x, y, vw, h);
+            lcd_write_ram_prepare();
+        }
+
+        for (r = 0; r < h; r++)
+        {
+            bit = 0x80 >> (r & 7);
+
+            if (inc)
             {
-                lcd_draw_point(x, y, color);        /* 画点出来,要显示这个点 */
+                out = g_lcd_fb.buf + (uint32_t)(y + r) * g_lcd_fb.width + x;
             }
-            else if (mode == 0)                     /* 无效点,不显示 */
+
+            for (i = 0; i < k; i++)
             {
-                lcd_draw_point(x, y, g_back_color); /* 画背景色,相当于这个点不显示(注意背景色由全局变量控制) */
+                cols = (i == k - 1) ? vw - i * w : w;                   /* 最后一个字符可能被裁掉一部分 */
+#if LCD_GLYPH_CACHE_NUM
+                if (pix[i])
+                {
+                    const uint16_t *q = pix[i] + r * w;
+
+                    for (c = 0; c < cols; c++, out += inc)
+                    {
+                        *out = q[c];
+                    }
+
+                    continue;
+                }
+#endif
+                for (c = 0; c < cols; c++, out += inc)
+                {
+                    *out = (font[i][c * cb + (r >> 3)] & bit) ? fg : bg;
+                }
             }
+        }
+
+        x += vw;
+        p += k;
+        n -= k;
+    }
+}
+
+/**
+ * @brief       在指定位置显示一个字符
+ * @note        非叠加方式: 设置一次窗口后连续写入整个字符的前景/背景像素;
+ *              叠加方式: 每行的每段连续前景像素设置一次窗口. 超出屏幕的部分裁掉
+ * @param       x,y  : 坐标
+ * @param       chr  : 要显示的字符:" "--->"~"
+ * @param       size : 字体大小 12/16/24/32
+ * @param       mode : 叠加方式(1); 非叠加方式(0);
+ * @param       color : 字符的颜色;
+ * @retval      无
+ */
+void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color)
+{
+    const uint8_t *pfont = lcd_glyph_font(chr, size);
+    uint16_t w = size / 2, cb = (size + 7) / 8;
+    uint16_t r, c, c0;
+
+    if (pfont == NULL || x >= lcddev.width || y >= lcddev.height)
+    {
+        return;
+    }
+
+    if (mode == 0)
+    {
+        lcd_show_run(x, y, &chr, 1, size, color, g_back_color);
+        return;
+    }
 
-            temp <<= 1;                             /* 移位, 以便获取下一个位的状态 */
-            y++;
+    if (w > lcddev.width - x)
+    {
+        w = lcddev.width - x;
+    }
 
-            if (y >= lcddev.height)return;          /* 超区域了 */
+    if (size > lcddev.height - y)
+    {
+        size = lcddev.height - y;
+    }
 
-            if ((y - y0) == size)                   /* 显示完一列了? */
+    if (!g_lcd_fb.buf)
+    {
+        lcd_dma_wait();
+    }
+
+    for (r = 0; r < size; r++)
+    {
+        for (c = 0; c < w; )
+        {
+            if (!(pfont[c * cb + (r >> 3)] & (0x80 >> (r & 7))))
             {
-                y = y0; /* y坐标复位 */
-                x++;    /* x坐标递增 */
+                c++;
+                continue;
+            }
 
-                if (x >= lcddev.width)
-                {
-                    return;       /* x坐标超区域了 */
-                }
+            for (c0 = c; c < w && (pfont[c * cb + (r >> 3)] & (0x80 >> (r & 7))); c++);    /* 一段连续的前景像素 */
 
-                break;
+            if (g_lcd_fb.buf)
+            {
+                lcd_fb_fill(x + c0, y + r, x + c - 1, y + r, color);
+                continue;
+            }
+
+            lcd_set_window(x + c0, y + r, c - c0, 1);
+            lcd_write_ram_prepare();
+
+            for (c0 = c - c0; c0; c0--)
+            {
+                LCD->LCD_RAM = color;
             }
         }
     }
@@ -1266,8 +1895,9 @@ void lcd_show_xnum(uint16_t x, uint16_t y, uint32_t num, uint8_t len, uint8_t si
  */
 void lcd_show_string(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t size, char *p, uint16_t color)
 {
-    uint8_t x0 = x;
-    
+    uint16_t x0 = x;
+    uint16_t n;
+
     width += x;
     height += y;
 
@@ -1284,8 +1914,10 @@ void lcd_show_string(uint16_t x, uint16_t y, uint16_t width, uint16_t height, ui
             break;      /* 退出 */
         }
 
-        lcd_show_char(x, y, *p, size, 0, color);
-        x += size / 2;
-        p++;
+        for (n = 0; p[n] <= '~' && p[n] >= ' ' && x + n * (size / 2) < width; n++);  /* 本行能放下的连续字符 */
+
+        lcd_show_run(x, y, p, n, size, color, g_back_color);
+        x += n * (size / 2);
+        p += n;
     }
 }
@@ -12,6 +12,7 @@
 
 #include "stdlib.h"
 #include "../../core/system/system_hal.h"
+#include "../DMA/dma.h"
 
 /* 修正LCD_RS引脚时钟使能：从GPIOG改为GPIOF */
 #define LCD_RS_GPIO_PORT                GPIOF
@@ -192,12 +193,54 @@ void lcd_clear(uint16_t color);
 void lcd_fill_circle(uint16_t x, uint16_t y, uint16_t r, uint16_t color);                   /* 填充实心圆 */
 void lcd_draw_circle(uint16_t x0, uint16_t y0, uint8_t r, uint16_t color);                  /* 画圆 */
 void lcd_draw_hline(uint16_t x, uint16_t y, uint16_t len, uint16_t color);                  /* 画水平线 */
+void lcd_draw_vline(uint16_t x, uint16_t y, uint16_t len, uint16_t color);                  /* 画垂直线 */
 void lcd_set_window(uint16_t sx, uint16_t sy, uint16_t width, uint16_t height);             /* 设置窗口 */
 void lcd_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint32_t color);          /* 纯色填充矩形(32位颜色,兼容LTDC) */
 void lcd_color_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t *color);   /* 彩色填充矩形 */
+
+/* DMA填充/写入 (DMA2, 目的为固定的 LCD->LCD_RAM): 每个矩形只设置一次窗口 (lcd_set_window), 然后连续写入全部像素;
+ * 源为固定的颜色字 (fill) 或颜色数组 (color_fill, 数组在CCM时由CPU写).
+ * xxx_async 启动后立即返回, 完成时调用回调 (中断上下文), 或用 lcd_dma_wait 阻塞等待 (调度器运行时阻塞在任务通知上);
+ * 像素数不足 LCD_DMA_MIN_PIXELS 的区域、或 dma_m2m_init 之前, 由CPU在调用者中完成并调用回调.
+ * 注意: 完成前不能有其他LCD操作 (包括其他任务), lcd_clear/lcd_fill/lcd_color_fill 会先等待上一次完成 */
+#define LCD_DMA_CH              DMA_M2M_CH_LCD
+#define LCD_DMA_MIN_PIXELS      32          /* 像素数小于该值时由CPU写入 (启动DMA和进中断的开销更大) */
+
+uint8_t lcd_clear_async(uint16_t color, dma_m2m_cb_t cb, void *arg);                                            /* DMA清屏 */
+uint8_t lcd_fill_async(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color, dma_m2m_cb_t cb, void *arg);  /* DMA纯色填充矩形 */
+uint8_t lcd_color_fill_async(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color, dma_m2m_cb_t cb, void *arg);  /* DMA彩色填充矩形 */
+uint8_t lcd_dma_busy(void);                                                                                     /* DMA填充/写入进行中 */
+uint8_t lcd_dma_claim(dma_m2m_cb_t cb, void *arg);                                                              /* 占用LCD的DMA (lcd_fb.c 用) */
+void lcd_dma_release(uint8_t result);                                                                           /* 释放LCD的DMA, 调用完成回调 */
+uint8_t lcd_dma_wait(void);                                                                                     /* 等待DMA填充/写入完成 */
 void lcd_draw_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);     /* 画直线 */
 void lcd_draw_rectangle(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color);/* 画矩形 */
 
+/* 文字: 非叠加方式的字符/字符串, 同一行的连续字符每 LCD_GLYPH_RUN_MAX 个设置一次窗口, 然后连续写入前景/背景像素.
+ * LCD_GLYPH_CACHE_NUM 不为0时可用 lcd_glyph_cache_enable 开启字形缓存: 展开好的像素放在CCM (每槽 LCD_GLYPH_MAX_PIXELS*2 字节),
+ * 按 字符+字号+前景色+背景色 查找, 满了替换最久未用的; 关闭时边读点阵边展开.
+ * 缓存默认不开 (16槽约占CCM 16.6KB, CCM还要放任务栈和 heap_bank), 文字多的应用把 LCD_GLYPH_CACHE_BOOT 改为1, 或自行调用 lcd_glyph_cache_enable(1) */
+#define LCD_GLYPH_RUN_MAX       8           /* 一个窗口最多的字符数 */
+#define LCD_GLYPH_CACHE_NUM     16          /* 字形缓存槽数, 0: 不编译缓存 (须大于 LCD_GLYPH_RUN_MAX) */
+#define LCD_GLYPH_CACHE_BOOT    0           /* 1: main.c 启动时开启字形缓存; 0: 不开 (默认) */
+#define LCD_GLYPH_MAX_PIXELS    (16 * 32)   /* 最大字形 (32号字) 的像素数 */
+
+#if LCD_GLYPH_CACHE_NUM
+#if LCD_GLYPH_CACHE_NUM <= LCD_GLYPH_RUN_MAX
+#error "LCD_GLYPH_CACHE_NUM must be greater than LCD_GLYPH_RUN_MAX"
+#endif
+
+typedef struct
+{
+    uint32_t hits;                          /* 命中次数 */
+    uint32_t misses;                        /* 展开次数 */
+} lcd_glyph_stats_t;
+
+extern lcd_glyph_stats_t g_glyph_stats;
+
+uint8_t lcd_glyph_cache_enable(uint8_t en);                 /* 开启/关闭字形缓存 */
+#endif
+
 void lcd_show_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint8_t mode, uint16_t color);                       /* 显示一个字符 */
 void lcd_show_num(uint16_t x, uint16_t y, uint32_t num, uint8_t len, uint8_t size, uint16_t color);                     /* 显示数字 */
 void lcd_show_xnum(uint16_t x, uint16_t y, uint32_t num, uint8_t len, uint8_t size, uint8_t mode, uint16_t color);      /* 扩展显示数字 */
@@ -0,0 +1,772 @@
+/**
+ ****************************************************************************************************
+ * @file        lcd_fb.c
+ * @brief       LCD 离屏帧缓冲 (外扩SRAM, RGB565) 及脏矩形刷新
+ ****************************************************************************************************
+ */
+
+#include <string.h>
+#include "./lcd_fb.h"
+#include "../../middleware/MALLOC/malloc.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+lcd_fb_t g_lcd_fb = {NULL, NULL, 0, 0, 1, 0, {{0}}};
+
+/* 刷新状态 (DMA逐行/逐矩形续传) */
+static struct
+{
+    lcd_rect_t rect[LCD_FB_DIRTY_MAX];      /* 要由DMA送出的矩形 */
+    uint8_t n;                              /* 矩形个数 */
+    uint8_t i;                              /* 当前矩形 */
+    uint16_t y;                             /* 当前矩形的下一行 */
+    const uint16_t *src;                    /* 送出哪个缓冲 (双缓冲时为显示缓冲) */
+} g_fb_flush;
+
+/* 帧同步/节奏状态 */
+static struct
+{
+    uint8_t vsync;                          /* LCD_VSYNC_xxx */
+    uint8_t interval;                       /* 每帧间隔的vblank数 */
+    volatile uint8_t armed;                 /* 1: 已提交, 等vblank开始送出 */
+    volatile uint32_t vcount;               /* vblank计数 */
+    uint32_t vlast;                         /* 上一帧开始送出时的 vcount */
+    uint32_t tlast;                         /* 上一帧开始送出时的 DWT->CYCCNT */
+    uint64_t cycles;                        /* 第一帧以来的总周期数 */
+    lcd_frame_stats_t st;
+} g_frame = {LCD_VSYNC_NONE, 1};
+
+/* 启动时预留的缓冲 (lcd_fb_reserve), 关闭帧缓冲时不归还内存池 */
+static uint16_t *g_fb_resv[2];
+
+/**
+ * @brief       取一个帧缓冲: 优先用未占用的预留缓冲, 没有时从 SRAMEX 内存池申请
+ */
+static uint16_t *lcd_fb_buf_get(uint32_t size)
+{
+    uint8_t i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (g_fb_resv[i] && g_fb_resv[i] != g_lcd_fb.buf && g_fb_resv[i] != g_lcd_fb.front)
+        {
+            return g_fb_resv[i];
+        }
+    }
+
+    return mymalloc(SRAMEX, size);
+}
+
+/**
+ * @brief       交还一个帧缓冲: 预留缓冲留着下次用, 其余归还内存池
+ */
+static void lcd_fb_buf_put(uint16_t *buf)
+{
+    if (buf != g_fb_resv[0] && buf != g_fb_resv[1])
+    {
+        myfree(SRAMEX, buf);
+    }
+}
+
+static uint32_t lcd_rect_area(const lcd_rect_t *r)
+{
+    return (uint32_t)(r->x1 - r->x0 + 1) * (r->y1 - r->y0 + 1);
+}
+
+static void lcd_rect_union(lcd_rect_t *d, const lcd_rect_t *a, const lcd_rect_t *b)
+{
+    d->x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+    d->y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+    d->x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+    d->y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+}
+
+/**
+ * @brief       启动时预留帧缓冲
+ * @note        在 my_mem_init(SRAMEX) 之后、调度器启动之前调用: heap_bank 第一次 pvPortMalloc 时从 SRAMEX
+ *              划走 configHEAP_EXT_SIZE, 之后 800x480 的屏 (768000 字节) 就申请不到帧缓冲了.
+ *              预留的缓冲之后由 lcd_fb_enable 使用, 关闭帧缓冲时不归还内存池
+ * @param       mode: LCD_FB_OFF, 不预留; LCD_FB_SINGLE, 预留一个缓冲; LCD_FB_DOUBLE, 预留两个
+ * @retval      实际预留的缓冲个数
+ */
+uint8_t lcd_fb_reserve(uint8_t mode)
+{
+    uint32_t size = (uint32_t)lcddev.width * lcddev.height * 2;
+    uint8_t i;
+
+    for (i = 0; i < mode && i < 2; i++)
+    {
+        if (g_fb_resv[i] == NULL)
+        {
+            g_fb_resv[i] = mymalloc(SRAMEX, size);
+
+            if (g_fb_resv[i] == NULL)
+            {
+                break;
+            }
+        }
+    }
+
+    return i;
+}
+
+/**
+ * @brief       开启/关闭帧缓冲
+ * @note        开启时帧缓冲填充背景色 (g_back_color) 并整屏标脏, 第一次刷新会覆盖屏幕原有内容;
+ *              关闭时先把未送出的脏矩形刷新到屏幕.
+ *              LCD_FB_DOUBLE 再申请一个显示缓冲 (lcd_frame_present 交换), 内存不足时退回单缓冲 (front 为NULL);
+ *              已开启时可以在单/双缓冲之间切换
+ * @param       mode: LCD_FB_OFF, 关闭并释放; LCD_FB_SINGLE, 单缓冲; LCD_FB_DOUBLE, 双缓冲
+ * @retval      0, 成功; 1, 内存不足
+ */
+uint8_t lcd_fb_enable(uint8_t mode)
+{
+    uint32_t size;
+    uint16_t *buf;
+
+    if (g_lcd_fb.buf && (mode != LCD_FB_DOUBLE || g_lcd_fb.front == NULL))
+    {
+        lcd_fb_flush();                             /* 送出后 buf 与屏幕 (和 front) 一致 */
+    }
+
+    if (mode != LCD_FB_DOUBLE && g_lcd_fb.front)
+    {
+        buf = g_lcd_fb.front;
+        g_lcd_fb.front = NULL;
+        lcd_fb_buf_put(buf);
+    }
+
+    if (mode == LCD_FB_OFF)
+    {
+        if (g_lcd_fb.buf)
+        {
+            buf = g_lcd_fb.buf;
+            g_lcd_fb.buf = NULL;
+            g_lcd_fb.ndirty = 0;
+            lcd_fb_buf_put(buf);
+        }
+
+        return 0;
+    }
+
+    if (g_lcd_fb.buf == NULL)
+    {
+        lcd_dma_wait();
+        buf = lcd_fb_buf_get((uint32_t)lcddev.width * lcddev.height * 2);
+
+        if (buf == NULL)
+        {
+            return 1;
+        }
+
+        g_lcd_fb.width = lcddev.width;
+        g_lcd_fb.height = lcddev.height;
+        g_lcd_fb.ndirty = 0;
+        g_lcd_fb.buf = buf;
+        lcd_fb_fill(0, 0, g_lcd_fb.width - 1, g_lcd_fb.height - 1, g_back_color);
+    }
+
+    if (mode == LCD_FB_DOUBLE && g_lcd_fb.front == NULL)
+    {
+        size = (uint32_t)g_lcd_fb.width * g_lcd_fb.height * 2;
+        buf = lcd_fb_buf_get(size);
+
+        if (buf == NULL)
+        {
+            return 0;                               /* 仍是单缓冲 */
+        }
+
+        if (dma_m2m_xfer(DMA_M2M_CH_MEM, buf, g_lcd_fb.buf, size, DMA_M2M_WORD) != DMA_M2M_OK)
+        {
+            memcpy(buf, g_lcd_fb.buf, size);
+        }
+
+        g_lcd_fb.front = buf;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       记录脏矩形 (超出屏幕的部分裁掉)
+ * @param       (x0,y0),(x1,y1): 矩形对角坐标 (含两端)
+ * @retval      无
+ */
+void lcd_fb_dirty(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    lcd_rect_t nr, u;
+    uint32_t cost, best;
+    uint8_t i, k;
+
+    if (x0 > x1 || y0 > y1 || x0 >= g_lcd_fb.width || y0 >= g_lcd_fb.height)
+    {
+        return;
+    }
+
+    nr.x0 = x0;
+    nr.y0 = y0;
+    nr.x1 = (x1 < g_lcd_fb.width) ? x1 : g_lcd_fb.width - 1;
+    nr.y1 = (y1 < g_lcd_fb.height) ? y1 : g_lcd_fb.height - 1;
+
+    for (i = 0; i < g_lcd_fb.ndirty; )              /* 合并划算的就合并, 合并结果再从头比较 */
+    {
+        lcd_rect_union(&u, &g_lcd_fb.dirty[i], &nr);
+
+        if (lcd_rect_area(&u) <= lcd_rect_area(&g_lcd_fb.dirty[i]) + lcd_rect_area(&nr) + LCD_FB_MERGE_COST)
+        {
+            nr = u;
+            g_lcd_fb.dirty[i] = g_lcd_fb.dirty[--g_lcd_fb.ndirty];
+            i = 0;
+            continue;
+        }
+
+        i++;
+    }
+
+    if (g_lcd_fb.ndirty < LCD_FB_DIRTY_MAX)
+    {
+        g_lcd_fb.dirty[g_lcd_fb.ndirty++] = nr;
+        return;
+    }
+
+    for (i = 0, k = 0, best = 0xFFFFFFFF; i < LCD_FB_DIRTY_MAX; i++)   /* 已满: 并入面积增加最少的 */
+    {
+        lcd_rect_union(&u, &g_lcd_fb.dirty[i], &nr);
+        cost = lcd_rect_area(&u) - lcd_rect_area(&g_lcd_fb.dirty[i]);
+
+        if (cost < best)
+        {
+            best = cost;
+            k = i;
+        }
+    }
+
+    lcd_rect_union(&g_lcd_fb.dirty[k], &g_lcd_fb.dirty[k], &nr);
+}
+
+/**
+ * @brief       帧缓冲中一段连续像素填充同一颜色 (长的用DMA)
+ */
+static void lcd_fb_span(uint16_t *p, uint32_t n, uint16_t color)
+{
+    uint32_t pat = color | ((uint32_t)color << 16);
+    uint32_t *q;
+
+    if (n && ((uint32_t)p & 2))
+    {
+        *p++ = color;
+        n--;
+    }
+
+    if (n >= LCD_FB_DMA_FILL_MIN && dma_m2m_fill(DMA_M2M_CH_MEM, p, pat, (n & ~1UL) * 2, DMA_M2M_WORD) == DMA_M2M_OK)
+    {
+        p += n & ~1UL;
+        n &= 1;
+    }
+
+    for (q = (uint32_t *)p; n >= 2; n -= 2)
+    {
+        *q++ = pat;
+    }
+
+    if (n)
+    {
+        *(uint16_t *)q = color;
+    }
+}
+
+/**
+ * @brief       在帧缓冲中填充单个颜色, 并记录脏矩形
+ * @param       (sx,sy),(ex,ey): 矩形对角坐标 (超出屏幕的部分裁掉)
+ * @param       color: 颜色
+ * @retval      无
+ */
+void lcd_fb_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color)
+{
+    uint16_t *p;
+    uint16_t w, y;
+
+    if (sx > ex || sy > ey || sx >= g_lcd_fb.width || sy >= g_lcd_fb.height)
+    {
+        return;
+    }
+
+    if (ex >= g_lcd_fb.width) ex = g_lcd_fb.width - 1;
+    if (ey >= g_lcd_fb.height) ey = g_lcd_fb.height - 1;
+
+    w = ex - sx + 1;
+    p = g_lcd_fb.buf + (uint32_t)sy * g_lcd_fb.width + sx;
+
+    if (w == g_lcd_fb.width)                        /* 整行宽: 帧缓冲中是连续的 */
+    {
+        lcd_fb_span(p, (uint32_t)w * (ey - sy + 1), color);
+    }
+    else
+    {
+        for (y = sy; y <= ey; y++, p += g_lcd_fb.width)
+        {
+            lcd_fb_span(p, w, color);
+        }
+    }
+
+    lcd_fb_dirty(sx, sy, ex, ey);
+}
+
+/**
+ * @brief       把颜色数组写入帧缓冲, 并记录脏矩形
+ * @param       (sx,sy),(ex,ey): 矩形对角坐标 (超出屏幕的部分裁掉)
+ * @param       color: 颜色数组, 按行存放, 每行 ex - sx + 1 个像素
+ * @retval      无
+ */
+void lcd_fb_blit(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color)
+{
+    uint16_t *p;
+    uint16_t stride = ex - sx + 1, w, y;
+
+    if (sx > ex || sy > ey || sx >= g_lcd_fb.width || sy >= g_lcd_fb.height)
+    {
+        return;
+    }
+
+    if (ex >= g_lcd_fb.width) ex = g_lcd_fb.width - 1;
+    if (ey >= g_lcd_fb.height) ey = g_lcd_fb.height - 1;
+
+    w = ex - sx + 1;
+    p = g_lcd_fb.buf + (uint32_t)sy * g_lcd_fb.width + sx;
+
+    if (w == g_lcd_fb.width)
+    {
+        memcpy(p, color, (uint32_t)w * (ey - sy + 1) * 2);
+    }
+    else
+    {
+        for (y = sy; y <= ey; y++, p += g_lcd_fb.width, color += stride)
+        {
+            memcpy(p, color, w * 2);
+        }
+    }
+
+    lcd_fb_dirty(sx, sy, ex, ey);
+}
+
+/**
+ * @brief       由CPU把帧缓冲中的一个矩形送到屏幕
+ */
+static void lcd_fb_write_rect(const lcd_rect_t *r)
+{
+    const uint16_t *p = g_fb_flush.src + (uint32_t)r->y0 * g_lcd_fb.width + r->x0;
+    uint16_t w = r->x1 - r->x0 + 1, y, x;
+
+    lcd_set_window(r->x0, r->y0, w, r->y1 - r->y0 + 1);
+    lcd_write_ram_prepare();
+
+    for (y = r->y0; y <= r->y1; y++, p += g_lcd_fb.width)
+    {
+        for (x = 0; x < w; x++)
+        {
+            LCD->LCD_RAM = p[x];
+        }
+    }
+}
+
+/**
+ * @brief       DMA送出下一段 (中断上下文, 第一段在 lcd_frame_start 中)
+ * @note        每个矩形设置一次窗口; 整行宽的矩形在帧缓冲中连续, 一次送完, 否则逐行送
+ */
+static void lcd_fb_flush_next(void *arg, uint8_t result)
+{
+    const lcd_rect_t *r;
+    const uint16_t *src;
+    uint16_t w;
+    uint32_t n;
+
+    (void)arg;
+
+    while (result == DMA_M2M_OK && g_fb_flush.i < g_fb_flush.n)
+    {
+        r = &g_fb_flush.rect[g_fb_flush.i];
+        w = r->x1 - r->x0 + 1;
+
+        if (g_fb_flush.y == r->y0)                  /* 新矩形 */
+        {
+            lcd_set_window(r->x0, r->y0, w, r->y1 - r->y0 + 1);
+            lcd_write_ram_prepare();
+        }
+
+        src = g_fb_flush.src + (uint32_t)g_fb_flush.y * g_lcd_fb.width + r->x0;
+        n = (w == g_lcd_fb.width) ? (uint32_t)w * (r->y1 - g_fb_flush.y + 1) : w;
+        g_fb_flush.y += n / w;
+
+        if (g_fb_flush.y > r->y1 && ++g_fb_flush.i < g_fb_flush.n)
+        {
+            g_fb_flush.y = g_fb_flush.rect[g_fb_flush.i].y0;
+        }
+
+        if (dma_m2m_start(LCD_DMA_CH, (void *)&LCD->LCD_RAM, src, n * 2, DMA_M2M_HALFWORD | DMA_M2M_DST_FIXED,
+                          lcd_fb_flush_next, NULL) == DMA_M2M_OK)
+        {
+            return;
+        }
+
+        while (n--)                                 /* DMA不可用 */
+        {
+            LCD->LCD_RAM = *src++;
+        }
+    }
+
+    lcd_dma_release(result);
+}
+
+/**
+ * @brief       双缓冲: 把一个矩形从显示缓冲拷贝到绘制缓冲 (交换后绘制缓冲缺上一帧的改动)
+ */
+static void lcd_fb_copy_rect(const lcd_rect_t *r)
+{
+    uint32_t off = (uint32_t)r->y0 * g_lcd_fb.width + r->x0;
+    uint16_t *d = g_lcd_fb.buf + off;
+    const uint16_t *s = g_lcd_fb.front + off;
+    uint16_t w = r->x1 - r->x0 + 1, y;
+
+    if (w == g_lcd_fb.width)                        /* 整行宽: 连续, 一次DMA */
+    {
+        off = (uint32_t)w * (r->y1 - r->y0 + 1) * 2;
+
+        if (dma_m2m_xfer(DMA_M2M_CH_MEM, d, s, off, DMA_M2M_HALFWORD) != DMA_M2M_OK)
+        {
+            memcpy(d, s, off);
+        }
+
+        return;
+    }
+
+    for (y = r->y0; y <= r->y1; y++, d += g_lcd_fb.width, s += g_lcd_fb.width)
+    {
+        memcpy(d, s, w * 2);
+    }
+}
+
+/**
+ * @brief       开始送出本帧 (已占用LCD的DMA; vblank中断中, 或不同步时在调用者中)
+ * @note        在调用者中: 窄矩形 (或 g_lcd_fb.dma 为0时全部) 由CPU直接写完, 其余由DMA在后台送出;
+ *              在vblank中断中只启动DMA链, 窄矩形也由DMA逐行送出 (不在中断里由CPU写像素)
+ * @param       isr: 1, 在vblank中断中
+ */
+static void lcd_frame_start(uint8_t isr)
+{
+    uint32_t now = DWT->CYCCNT;
+    uint8_t i, n = 0;
+
+    if (g_frame.st.frames)
+    {
+        g_frame.cycles += now - g_frame.tlast;
+
+        if (g_frame.vsync != LCD_VSYNC_NONE && g_frame.vcount - g_frame.vlast > g_frame.interval)
+        {
+            g_frame.st.missed++;
+            g_frame.st.late_vsyncs += g_frame.vcount - g_frame.vlast - g_frame.interval;
+        }
+    }
+
+    g_frame.tlast = now;
+    g_frame.vlast = g_frame.vcount;
+    g_frame.st.frames++;
+
+    for (i = 0; i < g_fb_flush.n; i++)
+    {
+        if (!isr && (!g_lcd_fb.dma || g_fb_flush.rect[i].x1 - g_fb_flush.rect[i].x0 + 1 < LCD_DMA_MIN_PIXELS))
+        {
+            lcd_fb_write_rect(&g_fb_flush.rect[i]);
+        }
+        else
+        {
+            g_fb_flush.rect[n++] = g_fb_flush.rect[i];
+        }
+    }
+
+    g_fb_flush.n = n;
+    g_fb_flush.i = 0;
+    g_fb_flush.y = g_fb_flush.rect[0].y0;
+    lcd_fb_flush_next(NULL, DMA_M2M_OK);
+}
+
+/**
+ * @brief       vblank (TE中断 或 定时器估计): 有一帧等待且到了目标间隔就开始送出
+ */
+static void lcd_frame_vsync_isr(void)
+{
+    g_frame.vcount++;
+
+    if (g_frame.armed && g_frame.vcount - g_frame.vlast >= g_frame.interval)
+    {
+        g_frame.armed = 0;
+        lcd_frame_start(1);
+    }
+}
+
+/**
+ * @brief       提交本帧 (异步)
+ * @note        取走脏矩形列表; 双缓冲时交换两个缓冲区, 并把本帧改动过的矩形拷贝到新的绘制缓冲,
+ *              之后可以马上画下一帧. 开启vblank同步时在目标vblank开始送出, 否则立即开始
+ * @param       cb/arg: 本帧送完时的回调 (中断上下文), 可为NULL
+ * @retval      DMA_M2M_OK: 已提交; DMA_M2M_EBUSY: 上一帧还没送完 (或LCD的DMA被占用)
+ */
+uint8_t lcd_fb_flush_async(dma_m2m_cb_t cb, void *arg)
+{
+    uint16_t *t;
+    uint8_t i;
+
+    if (g_lcd_fb.buf == NULL)
+    {
+        if (cb)
+        {
+            cb(arg, DMA_M2M_OK);
+        }
+
+        return DMA_M2M_OK;
+    }
+
+    if (g_frame.armed || lcd_dma_claim(cb, arg))
+    {
+        return DMA_M2M_EBUSY;
+    }
+
+    memcpy(g_fb_flush.rect, g_lcd_fb.dirty, g_lcd_fb.ndirty * sizeof(lcd_rect_t));
+    g_fb_flush.n = g_lcd_fb.ndirty;
+    g_lcd_fb.ndirty = 0;
+
+    if (g_lcd_fb.front)                             /* 双缓冲: 交换, 送出刚画好的 */
+    {
+        t = g_lcd_fb.front;
+        g_lcd_fb.front = g_lcd_fb.buf;
+        g_lcd_fb.buf = t;
+
+        for (i = 0; i < g_fb_flush.n; i++)
+        {
+            lcd_fb_copy_rect(&g_fb_flush.rect[i]);
+        }
+    }
+
+    g_fb_flush.src = g_lcd_fb.front ? g_lcd_fb.front : g_lcd_fb.buf;
+
+    if (g_frame.vsync == LCD_VSYNC_NONE)
+    {
+        lcd_frame_start(0);
+    }
+    else
+    {
+        __DMB();                                    /* 状态先于 armed 写入 */
+        g_frame.armed = 1;
+    }
+
+    return DMA_M2M_OK;
+}
+
+/**
+ * @brief       等待时让出CPU (调度器运行时)
+ */
+static void lcd_frame_yield(void)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+        vTaskDelay(1);
+    }
+}
+
+/**
+ * @brief       等待本帧送完 (包括等待vblank)
+ */
+static uint8_t lcd_frame_sync(void)
+{
+    while (g_frame.armed)
+    {
+        lcd_frame_yield();
+    }
+
+    return lcd_dma_wait();
+}
+
+/**
+ * @brief       一帧画完, 提交显示
+ * @note        上一帧还没送出时先等待 (等待时间记入统计). 双缓冲时提交后立即返回, 可以接着画下一帧;
+ *              单缓冲时要等本帧送完才返回 (送出期间不能改帧缓冲)
+ * @param       无
+ * @retval      0, 成功; 1, 帧缓冲未开启
+ */
+uint8_t lcd_frame_present(void)
+{
+    uint32_t t0 = DWT->CYCCNT, us;
+
+    if (g_lcd_fb.buf == NULL)
+    {
+        return 1;
+    }
+
+    while (lcd_fb_flush_async(NULL, NULL) != DMA_M2M_OK)
+    {
+        lcd_frame_sync();
+    }
+
+    us = (DWT->CYCCNT - t0) / (SystemCoreClock / 1000000);
+    g_frame.st.wait_us = us;
+
+    if (us > g_frame.st.wait_max_us)
+    {
+        g_frame.st.wait_max_us = us;
+    }
+
+    if (g_lcd_fb.front == NULL)
+    {
+        lcd_frame_sync();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       把脏矩形送到屏幕, 等待完成后返回
+ * @param       无
+ * @retval      DMA_M2M_OK / DMA_M2M_EXFER
+ */
+uint8_t lcd_fb_flush(void)
+{
+    lcd_frame_present();
+    return lcd_frame_sync();
+}
+
+/**
+ * @brief       设置帧同步
+ * @note        LCD_VSYNC_TE   : 屏的TE引脚 (TEON, 只在vblank输出) 接到 LCD_TE_GPIO, 上升沿中断; 须 LCD_TE_ENABLE 为1.
+ *                               写GRAM的速度要快于屏的扫描速度, 从vblank开始写时才不会被扫描追上.
+ *              LCD_VSYNC_TIMER: TIM7 按 LCD_VSYNC_HZ 产生估计的vblank. 与屏的实际扫描没有相位关系,
+ *                               只能把刷新节奏对齐到屏的刷新率, 不能完全消除撕裂.
+ *              LCD_VSYNC_NONE : 提交后立即送出.
+ *              TIM7 直接操作寄存器 (HAL_TIM_PeriodElapsedCallback 已由 btim.c 实现)
+ * @param       vsync   : LCD_VSYNC_xxx
+ * @param       interval: 每帧间隔的vblank数 (1: 跟屏的刷新率, 2: 一半, ...)
+ * @retval      0, 成功; 1, 不支持 (LCD_TE_ENABLE 为0时选了 LCD_VSYNC_TE)
+ */
+uint8_t lcd_frame_init(uint8_t vsync, uint8_t interval)
+{
+#if LCD_TE_ENABLE
+    GPIO_InitTypeDef gpio_init_struct;
+#endif
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     /* 统计用DWT计时 */
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+#if !LCD_TE_ENABLE
+    if (vsync == LCD_VSYNC_TE)
+    {
+        return 1;
+    }
+#endif
+
+    lcd_frame_sync();                               /* 等在vblank的帧先送出 */
+    g_frame.interval = interval ? interval : 1;
+
+    if (vsync == g_frame.vsync)
+    {
+        return 0;
+    }
+
+    HAL_NVIC_DisableIRQ(TIM7_IRQn);
+    TIM7->CR1 = 0;
+#if LCD_TE_ENABLE
+    HAL_NVIC_DisableIRQ(LCD_TE_IRQn);
+
+    if (vsync == LCD_VSYNC_TE)
+    {
+        LCD_TE_GPIO_CLK_ENABLE();
+        gpio_init_struct.Pin = LCD_TE_GPIO_PIN;
+        gpio_init_struct.Mode = GPIO_MODE_IT_RISING;
+        gpio_init_struct.Pull = GPIO_PULLDOWN;
+        gpio_init_struct.Speed = GPIO_SPEED_FREQ_HIGH;
+        HAL_GPIO_Init(LCD_TE_GPIO_PORT, &gpio_init_struct);
+
+        lcd_wr_regno(lcddev.id == 0x5510 ? 0x3500 : 0x35);  /* TEON: TE只在vblank输出 */
+        lcd_wr_data(0x00);
+
+        HAL_NVIC_SetPriority(LCD_TE_IRQn, LCD_VSYNC_IRQ_PRIO, 0);
+        HAL_NVIC_EnableIRQ(LCD_TE_IRQn);
+    }
+#endif
+
+    if (vsync == LCD_VSYNC_TIMER)
+    {
+        __HAL_RCC_TIM7_CLK_ENABLE();
+        TIM7->PSC = 84 - 1;                         /* APB1定时器时钟84MHz -> 1MHz */
+        TIM7->ARR = 1000000 / LCD_VSYNC_HZ - 1;
+        TIM7->EGR = TIM_EGR_UG;
+        TIM7->SR = 0;
+        TIM7->DIER = TIM_DIER_UIE;
+        TIM7->CR1 = TIM_CR1_CEN;
+        HAL_NVIC_SetPriority(TIM7_IRQn, LCD_VSYNC_IRQ_PRIO, 0);
+        HAL_NVIC_EnableIRQ(TIM7_IRQn);
+    }
+
+    g_frame.vsync = vsync;
+    lcd_frame_stats_clear();
+    return 0;
+}
+
+/**
+ * @brief       取帧统计
+ * @param       st: 输出, fps_x10 为清零以来的平均帧率
+ * @retval      无
+ */
+void lcd_frame_stats(lcd_frame_stats_t *st)
+{
+    *st = g_frame.st;
+    st->vsyncs = g_frame.vcount;
+    st->fps_x10 = 0;
+
+    if (g_frame.st.frames > 1 && g_frame.cycles)
+    {
+        st->fps_x10 = (uint32_t)((uint64_t)(g_frame.st.frames - 1) * SystemCoreClock * 10 / g_frame.cycles);
+    }
+}
+
+/**
+ * @brief       帧统计清零 (静止画面之后的第一帧会记为错过期限, 动画开始前清零)
+ * @param       无
+ * @retval      无
+ */
+void lcd_frame_stats_clear(void)
+{
+    memset(&g_frame.st, 0, sizeof(g_frame.st));
+    g_frame.cycles = 0;
+    g_frame.vcount = 0;
+    g_frame.vlast = 0;
+}
+
+/**
+ * @brief       TIM7中断服务函数 (估计的vblank)
+ * @retval      无
+ */
+void TIM7_IRQHandler(void)
+{
+    if (TIM7->SR & TIM_SR_UIF)
+    {
+        TIM7->SR = ~TIM_SR_UIF;
+        lcd_frame_vsync_isr();
+    }
+}
+
+#if LCD_TE_ENABLE
+/**
+ * @brief       TE中断服务函数 (vblank开始)
+ * @retval      无
+ */
+void LCD_TE_IRQHandler(void)
+{
+    if (__HAL_GPIO_EXTI_GET_IT(LCD_TE_GPIO_PIN))
+    {
+        __HAL_GPIO_EXTI_CLEAR_IT(LCD_TE_GPIO_PIN);
+
+        if (g_frame.vsync == LCD_VSYNC_TE)
+        {
+            lcd_frame_vsync_isr();
+        }
+    }
+}
+#endif
@@ -0,0 +1,121 @@
+/**
+ ****************************************************************************************************
+ * @file        lcd_fb.h
+ * @brief       LCD 离屏帧缓冲 (外扩SRAM, RGB565) 及脏矩形刷新
+ ****************************************************************************************************
+ * @attention
+ *
+ * lcd_fb_enable(1) 从 SRAMEX 内存池申请 width*height*2 字节的帧缓冲 (按行存放, 与屏幕同方向),
+ * 之后 lcd.c 的画点/填充/彩色填充/清屏/文字 都画到帧缓冲里, 不再访问屏幕, 并记录脏矩形;
+ * lcd_fb_flush 把脏矩形送到屏幕: 每个矩形设置一次窗口, 然后连续写入 (宽度不小于 LCD_DMA_MIN_PIXELS 时
+ * 由DMA逐行从帧缓冲送到 LCD->LCD_RAM, 整行宽的矩形一次送完; 窄的由CPU在调用者中写.
+ * 开启vblank同步时在vblank中断里开始送出, 中断里只启动DMA, 窄矩形也由DMA逐行送).
+ *
+ * 脏矩形: 最多 LCD_FB_DIRTY_MAX 个. 新矩形与已有矩形合并后的面积不超过 两者面积之和 + LCD_FB_MERGE_COST
+ * (设置一次窗口的代价, 折合像素数) 时合并 (包括重叠/包含), 合并结果再与其他矩形比较;
+ * 已满时并入 面积增加最少 的那个.
+ *
+ * 内存: SRAMEX 内存池共 768KB (MEM3_MAX_SIZE), 800x480 的屏 (NT35510/SSD1963/ILI9806) 一个缓冲就要
+ * 768000 字节, 只剩约 18KB; 而调度器启动后 heap_bank 第一次 pvPortMalloc 就从 SRAMEX 划走
+ * configHEAP_EXT_SIZE (128KB), 此后再也申请不到整屏缓冲. 因此要在 my_mem_init(SRAMEX) 之后、
+ * 调度器启动之前调用 lcd_fb_reserve 预留, lcd_fb_enable 优先用预留的缓冲.
+ * 帧缓冲是可选的: main.c 按 LCD_FB_RESERVE 预留, 默认 LCD_FB_OFF 不预留, 用帧缓冲的应用改为 SINGLE/DOUBLE.
+ * 800x480 的屏只能单缓冲, 预留后 SRAMEX 只剩约 18KB, 应把 configHEAP_EXT_SIZE 改为0 (否则 heap_bank
+ * 申请不到时输出提示, 外扩SRAM区域不启用, FreeRTOS堆只有SRAMIN/CCM); 320x480 及更小的屏可以双缓冲.
+ *
+ * 注意: 帧缓冲大小按开启时的 lcddev.width/height, 之后不能再改显示方向 (先关闭);
+ *       刷新进行中可以继续画, 刷新开始后画的区域记入新的脏矩形, 下次刷新时送出.
+ *
+ * 双缓冲 (lcd_fb_enable(LCD_FB_DOUBLE), 每个缓冲 width*height*2 字节, 内存不足时仍为单缓冲):
+ * 画在 buf 上, lcd_frame_present 交换 buf/front 后送出 front, 再把本帧的脏矩形从 front 拷回 buf,
+ * 调用者可以马上画下一帧, 不会把画了一半的内容送到屏幕. 上一帧还没送出时 present 等待.
+ *
+ * 帧同步 (lcd_frame_init): 提交的帧等到 vblank 才开始送出, 每 interval 个vblank一帧.
+ * vblank 来自屏的TE引脚 (LCD_VSYNC_TE, 需把TE飞线到 LCD_TE_GPIO) 或按 LCD_VSYNC_HZ 的定时器估计
+ * (LCD_VSYNC_TIMER, TIM7, 与实际扫描没有相位关系). vblank到来时上一帧还没提交的记为错过期限
+ * (lcd_frame_stats_t.missed / late_vsyncs), 连同平均帧率和 present 的等待时间由 lcd_frame_stats 取得.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __LCD_FB_H
+#define __LCD_FB_H
+
+#include "./lcd.h"
+
+#define LCD_FB_DIRTY_MAX        8           /* 脏矩形个数 */
+#define LCD_FB_MERGE_COST       64          /* 设置一次窗口的代价 (折合像素数) */
+#define LCD_FB_DMA_FILL_MIN     256         /* 帧缓冲中连续像素数不小于该值时用DMA填充 */
+
+/* lcd_fb_enable 的 mode */
+#define LCD_FB_OFF              0           /* 关闭 (直接画到屏幕) */
+#define LCD_FB_SINGLE           1           /* 单缓冲 */
+#define LCD_FB_DOUBLE           2           /* 双缓冲 */
+
+#define LCD_FB_RESERVE          LCD_FB_OFF  /* main.c 启动时预留的缓冲个数 (LCD_FB_OFF/SINGLE/DOUBLE), 用帧缓冲的应用改为 SINGLE/DOUBLE */
+
+/* lcd_frame_init 的 vsync */
+#define LCD_VSYNC_NONE          0           /* 不同步, 提交后立即送出 */
+#define LCD_VSYNC_TE            1           /* 屏的TE引脚 */
+#define LCD_VSYNC_TIMER         2           /* TIM7 按 LCD_VSYNC_HZ 估计 */
+
+#define LCD_VSYNC_HZ            60          /* 屏的刷新率 (定时器估计用) */
+#define LCD_VSYNC_IRQ_PRIO      6           /* vblank中断优先级, 与DMA中断相同 (不互相抢占) */
+
+/* TE引脚: 板上LCD插座没有引出TE, 需要飞线; 接好后置1并按实际引脚修改 */
+#define LCD_TE_ENABLE           0
+#define LCD_TE_GPIO_PORT        GPIOC
+#define LCD_TE_GPIO_PIN         GPIO_PIN_5
+#define LCD_TE_GPIO_CLK_ENABLE() do{ __HAL_RCC_GPIOC_CLK_ENABLE(); }while(0)
+#define LCD_TE_IRQn             EXTI9_5_IRQn
+#define LCD_TE_IRQHandler       EXTI9_5_IRQHandler
+
+/* 矩形 (含两端) */
+typedef struct
+{
+    uint16_t x0, y0;
+    uint16_t x1, y1;
+} lcd_rect_t;
+
+/* 帧缓冲 */
+typedef struct
+{
+    uint16_t *buf;                          /* 帧缓冲 (双缓冲时为绘制缓冲), NULL: 未开启 (直接画到屏幕) */
+    uint16_t *front;                        /* 双缓冲的显示缓冲, NULL: 单缓冲 */
+    uint16_t width;                         /* 宽度 (开启时的 lcddev.width) */
+    uint16_t height;                        /* 高度 */
+    uint8_t dma;                            /* 1: 刷新用DMA (默认); 0: 全部由CPU写 (vblank同步时无效, 总是用DMA) */
+    uint8_t ndirty;                         /* 脏矩形个数 */
+    lcd_rect_t dirty[LCD_FB_DIRTY_MAX];     /* 脏矩形 */
+} lcd_fb_t;
+
+/* 帧统计 */
+typedef struct
+{
+    uint32_t frames;                        /* 送出的帧数 */
+    uint32_t missed;                        /* 错过期限的帧数 (晚于 interval 个vblank才开始送出) */
+    uint32_t late_vsyncs;                   /* 错过期限的帧共晚了多少个vblank */
+    uint32_t vsyncs;                        /* vblank数 */
+    uint32_t fps_x10;                       /* 平均帧率 x10 */
+    uint32_t wait_us;                       /* 上一次 lcd_frame_present 的等待时间 */
+    uint32_t wait_max_us;                   /* 最长等待时间 */
+} lcd_frame_stats_t;
+
+extern lcd_fb_t g_lcd_fb;
+
+uint8_t lcd_fb_reserve(uint8_t mode);                                                   /* 启动时预留帧缓冲 */
+uint8_t lcd_fb_enable(uint8_t mode);                                                    /* 开启/关闭帧缓冲 */
+void lcd_fb_dirty(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);                  /* 记录脏矩形 */
+uint8_t lcd_fb_flush_async(dma_m2m_cb_t cb, void *arg);                                 /* 送出脏矩形 (异步) */
+uint8_t lcd_fb_flush(void);                                                             /* 送出脏矩形 */
+
+uint8_t lcd_frame_init(uint8_t vsync, uint8_t interval);                                /* 设置帧同步 */
+uint8_t lcd_frame_present(void);                                                        /* 提交一帧 */
+void lcd_frame_stats(lcd_frame_stats_t *st);                                            /* 取帧统计 */
+void lcd_frame_stats_clear(void);                                                       /* 帧统计清零 */
+
+/* 以下由 lcd.c 在帧缓冲开启时调用 (坐标已在屏幕内) */
+void lcd_fb_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color);
+void lcd_fb_blit(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color);
+
+#endif
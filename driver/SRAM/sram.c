@@ -18,6 +18,8 @@
  * 修改说明
  * V1.0 20211103
  * 第一次发布
+ * V1.1
+ * sram_write/sram_read 改为16/32位批量访问, 支持任意地址和长度; 增加 DMA2 异步读写 (sram_xxx_dma)
  *
  ****************************************************************************************************
  */
@@ -39,7 +41,7 @@ void sram_init(void)
     GPIO_InitTypeDef gpio_init_struct;
     FSMC_NORSRAM_TimingTypeDef fsmc_readwritetim;
 
-    XmRamInit();
+    XmRamInit();                  /* 外扩SRAM芯片配置 (热复位且配置仍在时走快速路径) */
     SRAM_CS_GPIO_CLK_ENABLE();    /* SRAM_CS脚时钟使能 */
     SRAM_WR_GPIO_CLK_ENABLE();    /* SRAM_WR脚时钟使能 */
     SRAM_RD_GPIO_CLK_ENABLE();    /* SRAM_RD脚时钟使能 */
@@ -114,37 +116,178 @@ void sram_init(void)
     HAL_SRAM_Init(&g_sram_handler, &fsmc_readwritetim, &fsmc_readwritetim);
 }
 
+/**
+ * @brief       CPU拷贝, 一端为外扩SRAM
+ * @note        先用字节/半字访问把SRAM端对齐到4字节, 中间按32位访问 (FSMC拆成两次16位总线访问),
+ *              每次循环16字节; 内部SRAM端允许不对齐 (M4硬件支持非对齐LDR/STR), 最后处理半字/字节尾部.
+ *              FSMC使能了 NBL0/NBL1 字节选通, 奇地址字节访问不影响相邻字节
+ * @param       des/src : 目的/源地址
+ * @param       len     : 字节数
+ * @param       to_sram : 1: 写SRAM (des在SRAM); 0: 读SRAM (src在SRAM)
+ * @retval      无
+ */
+static void sram_copy(uint8_t *des, const uint8_t *src, uint32_t len, uint8_t to_sram)
+{
+    uint32_t ext = to_sram ? (uint32_t)des : (uint32_t)src;
+
+    if ((ext & 1) && len) {                                                 /* 奇地址: 1个字节 */
+        *des++ = *src++;
+        ext++;
+        len--;
+    }
+    if ((ext & 2) && len >= 2) {                                            /* 半字对齐: 1个半字 */
+        if (to_sram) *(uint16_t *)des = __UNALIGNED_UINT16_READ(src);
+        else __UNALIGNED_UINT16_WRITE(des, *(const uint16_t *)src);
+        des += 2;
+        src += 2;
+        len -= 2;
+    }
+
+    if (to_sram) {
+        for (; len >= 16; len -= 16, des += 16, src += 16) {
+            ((uint32_t *)des)[0] = __UNALIGNED_UINT32_READ(src);
+            ((uint32_t *)des)[1] = __UNALIGNED_UINT32_READ(src + 4);
+            ((uint32_t *)des)[2] = __UNALIGNED_UINT32_READ(src + 8);
+            ((uint32_t *)des)[3] = __UNALIGNED_UINT32_READ(src + 12);
+        }
+        for (; len >= 4; len -= 4, des += 4, src += 4) *(uint32_t *)des = __UNALIGNED_UINT32_READ(src);
+        if (len >= 2) {
+            *(uint16_t *)des = __UNALIGNED_UINT16_READ(src);
+            des += 2;
+            src += 2;
+            len -= 2;
+        }
+    } else {
+        for (; len >= 16; len -= 16, des += 16, src += 16) {
+            __UNALIGNED_UINT32_WRITE(des, ((const uint32_t *)src)[0]);
+            __UNALIGNED_UINT32_WRITE(des + 4, ((const uint32_t *)src)[1]);
+            __UNALIGNED_UINT32_WRITE(des + 8, ((const uint32_t *)src)[2]);
+            __UNALIGNED_UINT32_WRITE(des + 12, ((const uint32_t *)src)[3]);
+        }
+        for (; len >= 4; len -= 4, des += 4, src += 4) __UNALIGNED_UINT32_WRITE(des, *(const uint32_t *)src);
+        if (len >= 2) {
+            __UNALIGNED_UINT16_WRITE(des, *(const uint16_t *)src);
+            des += 2;
+            src += 2;
+            len -= 2;
+        }
+    }
+    if (len) *des = *src;
+}
+
 /**
  * @brief       往SRAM指定地址写入指定长度数据
  * @param       pbuf    : 数据存储区
- * @param       addr    : 开始写入的地址(最大32bit)
- * @param       datalen : 要写入的字节数(最大32bit)
+ * @param       addr    : 开始写入的地址(相对SRAM_BASE_ADDR, 任意对齐)
+ * @param       datalen : 要写入的字节数(任意长度)
  * @retval      无
  */
 void sram_write(uint8_t *pbuf, uint32_t addr, uint32_t datalen)
 {
-    for (; datalen != 0; datalen--)
-    {
-        *(volatile uint8_t *)(SRAM_BASE_ADDR + addr) = *pbuf;
-        addr++;
-        pbuf++;
-    }
+    sram_copy((uint8_t *)(SRAM_BASE_ADDR + addr), pbuf, datalen, 1);
 }
 
 /**
  * @brief       从SRAM指定地址读取指定长度数据
  * @param       pbuf    : 数据存储区
- * @param       addr    : 开始读取的地址(最大32bit)
- * @param       datalen : 要读取的字节数(最大32bit)
+ * @param       addr    : 开始读取的地址(相对SRAM_BASE_ADDR, 任意对齐)
+ * @param       datalen : 要读取的字节数(任意长度)
  * @retval      无
  */
 void sram_read(uint8_t *pbuf, uint32_t addr, uint32_t datalen)
 {
-    for (; datalen != 0; datalen--)
-    {
-        *pbuf++ = *(volatile uint8_t *)(SRAM_BASE_ADDR + addr);
-        addr++;
+    sram_copy(pbuf, (const uint8_t *)(SRAM_BASE_ADDR + addr), datalen, 0);
+}
+
+/**
+ * @brief       DMA传输 (异步): 首尾不对齐部分由CPU当场拷贝, 中间部分交给 DMA2 (DMA_M2M_CH_SRAM)
+ * @note        两端地址对4同余时按32位传输, 只对2同余时按16位传输;
+ *              两端奇偶不同、中间部分不足 SRAM_DMA_MIN_SIZE 或 缓冲区在CCM时, 全部由CPU拷贝,
+ *              此时回调在本函数返回前 (调用者上下文) 被调用; DMA通道未初始化时同样全部由CPU拷贝.
+ *              返回 DMA_M2M_EBUSY 时没有写入任何数据
+ * @retval      DMA_M2M_OK / DMA_M2M_EBUSY / DMA_M2M_EXFER
+ */
+static uint8_t sram_copy_dma(uint8_t *des, const uint8_t *src, uint32_t len, uint8_t to_sram, dma_m2m_cb_t cb, void *arg)
+{
+    uint32_t ext = to_sram ? (uint32_t)des : (uint32_t)src;
+    uint32_t diff = (uint32_t)des ^ (uint32_t)src;
+    uint32_t unit = (diff & 3) == 0 ? 4 : (diff & 1) == 0 ? 2 : 0;
+    uint32_t head = unit ? (unit - (ext & (unit - 1))) & (unit - 1) : 0;
+    uint32_t body, primask;
+    uint8_t res;
+
+    if (dma_m2m_busy(SRAM_DMA_CH)) return DMA_M2M_EBUSY;
+    body = len > head ? (len - head) & ~(unit - 1) : 0;
+    if (unit == 0 || body < SRAM_DMA_MIN_SIZE || !dma_m2m_addr_ok(to_sram ? src : des) ||
+        !dma_m2m_addr_ok(to_sram ? src + len - 1 : des + len - 1)) {
+        sram_copy(des, src, len, to_sram);
+        if (cb) cb(arg, DMA_M2M_OK);
+        return DMA_M2M_OK;
+    }
+
+    /* 先启动中间部分, 成功后才拷贝首尾 (各不足4字节); 关中断保证首尾写完之前完成回调不会被调用 */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    res = dma_m2m_start(SRAM_DMA_CH, des + head, src + head, body, unit == 2 ? DMA_M2M_HALFWORD : DMA_M2M_WORD, cb, arg);
+    if (res == DMA_M2M_OK) {
+        sram_copy(des, src, head, to_sram);                                 /* 首部 */
+        sram_copy(des + head + body, src + head + body, len - head - body, to_sram);    /* 尾部 */
     }
+    __set_PRIMASK(primask);
+
+    /* 地址不合适, 或通道还未 dma_m2m_init (返回忙但实际空闲): 整段退回CPU, 不让调用者对永远不会成功的请求反复重试 */
+    if (res == DMA_M2M_EADDR || (res == DMA_M2M_EBUSY && !dma_m2m_busy(SRAM_DMA_CH))) {
+        sram_copy(des, src, len, to_sram);
+        if (cb) cb(arg, DMA_M2M_OK);
+        res = DMA_M2M_OK;
+    }
+    return res;
+}
+
+/**
+ * @brief       往SRAM写入数据 (DMA, 异步)
+ * @param       pbuf    : 数据存储区, 传输完成前不能修改
+ * @param       addr    : 开始写入的地址(相对SRAM_BASE_ADDR, 任意对齐)
+ * @param       datalen : 要写入的字节数(任意长度)
+ * @param       cb      : 完成回调 (通常在DMA中断中调用), 可为NULL, 用 sram_dma_wait 等待
+ * @param       arg     : 回调参数
+ * @retval      DMA_M2M_OK: 已启动(或已由CPU完成); DMA_M2M_EBUSY: 上一次传输未完成
+ */
+uint8_t sram_write_dma(const uint8_t *pbuf, uint32_t addr, uint32_t datalen, dma_m2m_cb_t cb, void *arg)
+{
+    return sram_copy_dma((uint8_t *)(SRAM_BASE_ADDR + addr), pbuf, datalen, 1, cb, arg);
+}
+
+/**
+ * @brief       从SRAM读取数据 (DMA, 异步)
+ * @param       pbuf    : 数据存储区, 传输完成前内容不确定
+ * @param       addr    : 开始读取的地址(相对SRAM_BASE_ADDR, 任意对齐)
+ * @param       datalen : 要读取的字节数(任意长度)
+ * @param       cb      : 完成回调 (通常在DMA中断中调用), 可为NULL, 用 sram_dma_wait 等待
+ * @param       arg     : 回调参数
+ * @retval      DMA_M2M_OK: 已启动(或已由CPU完成); DMA_M2M_EBUSY: 上一次传输未完成
+ */
+uint8_t sram_read_dma(uint8_t *pbuf, uint32_t addr, uint32_t datalen, dma_m2m_cb_t cb, void *arg)
+{
+    return sram_copy_dma(pbuf, (const uint8_t *)(SRAM_BASE_ADDR + addr), datalen, 0, cb, arg);
+}
+
+/**
+ * @brief       SRAM DMA传输是否进行中
+ * @retval      1: 忙; 0: 空闲
+ */
+uint8_t sram_dma_busy(void)
+{
+    return dma_m2m_busy(SRAM_DMA_CH);
+}
+
+/**
+ * @brief       等待SRAM DMA传输完成 (任务中调用时阻塞让出CPU)
+ * @retval      DMA_M2M_OK / DMA_M2M_EXFER
+ */
+uint8_t sram_dma_wait(void)
+{
+    return dma_m2m_wait(SRAM_DMA_CH);
 }
 
 /*******************测试函数**********************************/
@@ -26,6 +26,7 @@
 #define __SRAM_H
 
 #include "../../core/system/system_hal.h"
+#include "../DMA/dma.h"
 
 
 /******************************************************************************************/
@@ -69,12 +70,20 @@
  */
 #define SRAM_BASE_ADDR         (0X60000000 + (0X4000000 * (SRAM_FSMC_NEX - 1)))
 
+/* DMA读写: 使用的DMA2通道, 以及小于该字节数的传输直接由CPU完成 (启动DMA的开销更大) */
+#define SRAM_DMA_CH            DMA_M2M_CH_SRAM
+#define SRAM_DMA_MIN_SIZE      64
+
 extern SRAM_HandleTypeDef g_sram_handler;    /* SRAM句柄 */
 
 
 void sram_init(void);
 void sram_write(uint8_t *pbuf, uint32_t addr, uint32_t datalen);
 void sram_read(uint8_t *pbuf, uint32_t addr, uint32_t datalen);
+uint8_t sram_write_dma(const uint8_t *pbuf, uint32_t addr, uint32_t datalen, dma_m2m_cb_t cb, void *arg);
+uint8_t sram_read_dma(uint8_t *pbuf, uint32_t addr, uint32_t datalen, dma_m2m_cb_t cb, void *arg);
+uint8_t sram_dma_busy(void);
+uint8_t sram_dma_wait(void);
 
 uint8_t sram_test_read(uint32_t addr);
 void sram_test_write(uint32_t addr, uint8_t data);
@@ -6,7 +6,24 @@
  */
 
 #include "./malloc.h"
+#include "./mem_lock.h"
+#include "./mem_tag.h"
+#include "../../driver/DMA/dma.h"
+#ifndef MEM_HOST_BUILD
+#include <stdio.h>
+#endif
 
+#ifdef MEM_HOST_BUILD
+/* ==================== 主机编译 (test/下的基准测试): 内存池为普通数组 ==================== */
+uint8_t mem1base[MEM1_MAX_SIZE] __attribute__((aligned(32)));
+uint8_t mem2base[MEM2_MAX_SIZE] __attribute__((aligned(32)));
+uint8_t mem3base[MEM3_MAX_SIZE] __attribute__((aligned(32)));
+uint32_t mem1mapbase[MEM1_MAP_WORDS];
+uint32_t mem2mapbase[MEM2_MAP_WORDS];
+uint32_t mem3mapbase[MEM3_MAP_WORDS];
+pthread_mutex_t memlock[SRAMBANK] = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER};
+__thread void *memtls;
+#else
 /* ==================== 内存池定义 (32字节对齐，地址严格匹配外扩SRAM) ==================== */
 /* 内部SRAM池: 0x20000000，180KB */
 __align(32) uint8_t mem1base[MEM1_MAX_SIZE];
@@ -18,14 +35,15 @@ __align(32) uint8_t mem2base[MEM2_MAX_SIZE] __attribute__((at(0x10000000)));
 __align(32) uint8_t mem3base[MEM3_MAX_SIZE] __attribute__((at(0x68000000)));
 
 /* ==================== 状态表定义 (紧跟内存池，地址连续) ==================== */
-/* 内部SRAM状态表 */
-__align(32) uint16_t mem1mapbase[MEM1_ALLOC_TABLE_SIZE];
+/* 内部SRAM状态表: 1440字节 */
+__align(32) uint32_t mem1mapbase[MEM1_MAP_WORDS];
 
-/* CCM状态表: 0x10000000 + 60KB = 0x1000EA00 */
-__align(32) uint16_t mem2mapbase[MEM2_ALLOC_TABLE_SIZE] __attribute__((at(0x10000000 + MEM2_MAX_SIZE)));
+/* CCM状态表: 0x10000000 + 60KB = 0x1000F000，480字节 */
+__align(32) uint32_t mem2mapbase[MEM2_MAP_WORDS] __attribute__((at(0x10000000 + MEM2_MAX_SIZE)));
 
-/* 外扩SRAM状态表: 0x68000000 + 768KB = 0x680C0000 */
-__align(32) uint16_t mem3mapbase[MEM3_ALLOC_TABLE_SIZE] __attribute__((at(0x68000000 + MEM3_MAX_SIZE)));
+/* 外扩SRAM状态表: 0x68000000 + 768KB = 0x680C0000，6KB */
+__align(32) uint32_t mem3mapbase[MEM3_MAP_WORDS] __attribute__((at(0x68000000 + MEM3_MAX_SIZE)));
+#endif
 
 /* 内存管理参数表 */
 const uint32_t memtblsize[SRAMBANK] = {MEM1_ALLOC_TABLE_SIZE, MEM2_ALLOC_TABLE_SIZE, MEM3_ALLOC_TABLE_SIZE};
@@ -41,123 +59,654 @@ struct _m_mallco_dev mallco_dev = {
     0, 0, 0
 };
 
+/* 各内存池的分配引擎 */
+static mem_tlsf_t memtlsf[SRAMBANK];
+
+/* 已清零水位 (块号): 该块号之前的空闲块已清零, 之后的块在分配时才清零 (延迟初始化) */
+static uint32_t memclean[SRAMBANK];
+
+/* 分配引擎层的 申请/释放/失败 次数 (持锁更新) */
+static uint32_t memallocs[SRAMBANK];
+static uint32_t memfrees[SRAMBANK];
+static uint32_t memfails[SRAMBANK];
+
+/* 每任务缓存 (magazine): 按块数分级, 每级最多缓存 MEM_MAG_DEPTH 个已释放的小内存.
+ * 缓存中的内存在分配引擎看来仍是已分配状态, 只有所属任务访问, 无需加锁 */
+typedef struct
+{
+    void *obj[SRAMBANK][MEM_MAG_CLASSES][MEM_MAG_DEPTH];
+    uint8_t cnt[SRAMBANK][MEM_MAG_CLASSES];
+} mem_mag_t;
+
+static uint8_t memcache_en = MEM_MAG_ENABLE;                                /* 每任务缓存开关 */
+
 /**
  * @brief   内存拷贝
+ * @note    源和目的对4取模相同时, 先逐字节对齐, 再按每次4字(16字节)展开拷贝, 最后补尾部字节;
+ *          仅对2取模相同时按半字拷贝 (外扩SRAM为16位总线); 否则逐字节
  */
 void mymemcpy(void *des, void *src, uint32_t n)
 {
     uint8_t *xdes = (uint8_t *)des;
     uint8_t *xsrc = (uint8_t *)src;
+    uint32_t *wdes, *wsrc;
+    uint16_t *hdes, *hsrc;
+
+    if (n >= 16 && (((uintptr_t)xdes ^ (uintptr_t)xsrc) & 3) == 0) {
+        while ((uintptr_t)xdes & 3) {
+            *xdes++ = *xsrc++;
+            n--;
+        }
+        wdes = (uint32_t *)xdes;
+        wsrc = (uint32_t *)xsrc;
+        while (n >= 16) {
+            wdes[0] = wsrc[0];
+            wdes[1] = wsrc[1];
+            wdes[2] = wsrc[2];
+            wdes[3] = wsrc[3];
+            wdes += 4;
+            wsrc += 4;
+            n -= 16;
+        }
+        while (n >= 4) {
+            *wdes++ = *wsrc++;
+            n -= 4;
+        }
+        xdes = (uint8_t *)wdes;
+        xsrc = (uint8_t *)wsrc;
+    } else if (n >= 16 && (((uintptr_t)xdes ^ (uintptr_t)xsrc) & 1) == 0) {
+        if ((uintptr_t)xdes & 1) {
+            *xdes++ = *xsrc++;
+            n--;
+        }
+        hdes = (uint16_t *)xdes;
+        hsrc = (uint16_t *)xsrc;
+        while (n >= 8) {
+            hdes[0] = hsrc[0];
+            hdes[1] = hsrc[1];
+            hdes[2] = hsrc[2];
+            hdes[3] = hsrc[3];
+            hdes += 4;
+            hsrc += 4;
+            n -= 8;
+        }
+        while (n >= 2) {
+            *hdes++ = *hsrc++;
+            n -= 2;
+        }
+        xdes = (uint8_t *)hdes;
+        xsrc = (uint8_t *)hsrc;
+    }
     while (n--) *xdes++ = *xsrc++;
 }
 
 /**
  * @brief   内存填充
+ * @note    逐字节对齐后按每次4字(16字节)展开写入, 最后补尾部字节
  */
 void mymemset(void *s, uint8_t c, uint32_t count)
 {
     uint8_t *xs = (uint8_t *)s;
+    uint32_t *ws, w;
+
+    if (count >= 16) {
+        while ((uintptr_t)xs & 3) {
+            *xs++ = c;
+            count--;
+        }
+        w = c * 0x01010101U;
+        ws = (uint32_t *)xs;
+        while (count >= 16) {
+            ws[0] = w;
+            ws[1] = w;
+            ws[2] = w;
+            ws[3] = w;
+            ws += 4;
+            count -= 16;
+        }
+        while (count >= 4) {
+            *ws++ = w;
+            count -= 4;
+        }
+        xs = (uint8_t *)ws;
+    }
     while (count--) *xs++ = c;
 }
 
 /**
- * @brief   内存池初始化
+ * @brief   内存拷贝 (大块走DMA2, 等待期间让出CPU)
+ * @note    长度不小于 MEM_DMA_MIN_SIZE 且源/目的对4取模相同、都可被DMA访问时,
+ *          对齐的中间部分交给DMA, 首尾不足一字的字节由CPU在DMA传输期间完成;
+ *          其余情况 或 DMA通道被占用时 退回 mymemcpy
+ */
+void mymemcpy_dma(void *des, void *src, uint32_t n)
+{
+    uint8_t *xdes = (uint8_t *)des;
+    uint8_t *xsrc = (uint8_t *)src;
+    uint32_t head, body;
+
+    if (n >= MEM_DMA_MIN_SIZE && (((uintptr_t)xdes ^ (uintptr_t)xsrc) & 3) == 0) {
+        head = (4 - ((uintptr_t)xdes & 3)) & 3;
+        body = (n - head) & ~3U;
+        if (dma_m2m_start(DMA_M2M_CH_MEM, xdes + head, xsrc + head, body, DMA_M2M_WORD, NULL, NULL) == DMA_M2M_OK) {
+            mymemcpy(xdes, xsrc, head);
+            mymemcpy(xdes + head + body, xsrc + head + body, n - head - body);
+            if (dma_m2m_wait(DMA_M2M_CH_MEM) != DMA_M2M_OK) mymemcpy(xdes + head, xsrc + head, body);
+            return;
+        }
+    }
+    mymemcpy(des, src, n);
+}
+
+/**
+ * @brief   内存填充 (大块走DMA2, 等待期间让出CPU)
+ * @note    条件与 mymemcpy_dma 相同, 不满足时退回 mymemset
+ */
+void mymemset_dma(void *s, uint8_t c, uint32_t count)
+{
+    uint8_t *xs = (uint8_t *)s;
+    uint32_t head, body;
+
+    if (count >= MEM_DMA_MIN_SIZE && dma_m2m_addr_ok(xs)) {
+        head = (4 - ((uintptr_t)xs & 3)) & 3;
+        body = (count - head) & ~3U;
+        if (dma_m2m_fill(DMA_M2M_CH_MEM, xs + head, c * 0x01010101U, body, DMA_M2M_WORD) == DMA_M2M_OK) {
+            mymemset(xs, c, head);
+            mymemset(xs + head + body, c, count - head - body);
+            return;
+        }
+    }
+    mymemset(s, c, count);
+}
+
+/**
+ * @brief   内存池初始化 (整池清零)
+ * @note    只在启动时调用: 重新初始化会使各任务缓存中指向该池的内存失效
  */
 void my_mem_init(uint8_t memx)
 {
     if (memx >= SRAMBANK) return;
-    mymemset(mallco_dev.memmap[memx], 0, memtblsize[memx] * sizeof(uint16_t));
     mymemset(mallco_dev.membase[memx], 0, memsize[memx]);
+    mem_tlsf_init(&memtlsf[memx], mallco_dev.membase[memx], mallco_dev.memmap[memx], memblksize[memx], memtblsize[memx]);
+    memclean[memx] = memtblsize[memx];
+    memallocs[memx] = 0;
+    memfrees[memx] = 0;
+    memfails[memx] = 0;
     mallco_dev.memrdy[memx] = 1;
 }
 
+/**
+ * @brief   内存池初始化 (延迟清零)
+ * @note    只清状态表, 不清内存池. 从未分配过的块在被 mymalloc 分配时才清零,
+ *          因此"新申请到的内存为0"的行为与 my_mem_init 一致;
+ *          剩余部分可在调度器启动后由 my_mem_scrub_start 创建的后台任务逐步清零
+ */
+void my_mem_init_lazy(uint8_t memx)
+{
+    if (memx >= SRAMBANK) return;
+    mem_tlsf_init(&memtlsf[memx], mallco_dev.membase[memx], mallco_dev.memmap[memx], memblksize[memx], memtblsize[memx]);
+    memclean[memx] = 0;
+    memallocs[memx] = 0;
+    memfrees[memx] = 0;
+    memfails[memx] = 0;
+    mallco_dev.memrdy[memx] = 1;
+}
+
+/**
+ * @brief   后台清零一步: 从水位开始清零最多 nblocks 块中的空闲块
+ * @note    持锁执行, nblocks 决定屏蔽中断的最长时间
+ * @retval  1: 整池已清零; 0: 还有剩余
+ */
+uint8_t my_mem_scrub(uint8_t memx, uint32_t nblocks)
+{
+    uint32_t start, lock;
+    if (memx >= SRAMBANK || !mallco_dev.memrdy[memx]) return 1;
+
+    lock = MEM_LOCK(memx);
+    start = memclean[memx];
+    if (start < memtblsize[memx]) {
+        if (nblocks > memtblsize[memx] - start) nblocks = memtblsize[memx] - start;
+        mem_tlsf_scrub(&memtlsf[memx], start, nblocks);
+        memclean[memx] = start + nblocks;
+    }
+    MEM_UNLOCK(memx, lock);
+    return memclean[memx] >= memtblsize[memx];
+}
+
+#ifndef MEM_HOST_BUILD
+/**
+ * @brief   后台清零任务: 依次清零各内存池, 完成后删除自身
+ * @note    优先级与空闲任务相同, 只在没有其他任务就绪时运行
+ */
+static void my_mem_scrub_task(void *pvParameters)
+{
+    uint8_t memx;
+    for (memx = 0; memx < SRAMBANK; memx++) {
+        while (!my_mem_scrub(memx, MEM_SCRUB_CHUNK)) taskYIELD();
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief   创建后台清零任务 (须在调度器启动后调用, 延迟初始化的内存池才需要)
+ */
+void my_mem_scrub_start(void)
+{
+    xTaskCreate(my_mem_scrub_task, "mem_scrub", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
+}
+#endif
+
 /**
  * @brief   获取内存使用率
+ * @note    由引擎维护的已分配块数直接计算, O(1)
  */
 uint16_t my_mem_perused(uint8_t memx)
 {
-    uint32_t used = 0, i;
     if (memx >= SRAMBANK || !mallco_dev.memrdy[memx]) return 0;
-    for (i = 0; i < memtblsize[memx]; i++) {
-        if (mallco_dev.memmap[memx][i]) used++;
+    return (memtlsf[memx].used * 1000) / memtblsize[memx];
+}
+
+/**
+ * @brief   获取内存池统计信息
+ * @note    使用量/峰值/直方图/次数由分配引擎随申请释放增量维护, 这里持锁拷贝一份, 不扫描状态表;
+ *          最大空闲段取最高非空级别链表维护的最大段, O(1).
+ *          每任务缓存中的内存计为已用, 缓存命中的申请/释放不计入 allocs/frees
+ * @retval  0: 成功; 1: 内存池未初始化
+ */
+uint8_t my_mem_stats(uint8_t memx, mem_stats_t *st)
+{
+    uint32_t i, lock;
+    mem_tlsf_t *t;
+
+    if (memx >= SRAMBANK || !mallco_dev.memrdy[memx]) return 1;
+    t = &memtlsf[memx];
+    lock = MEM_LOCK(memx);
+    st->total = memsize[memx];
+    st->used = t->used * memblksize[memx];
+    st->peak = t->peak * memblksize[memx];
+    st->largest_free = mem_tlsf_largest(t) * memblksize[memx];
+    st->free_runs = 0;
+    for (i = 0; i < MEM_TLSF_FL_COUNT; i++) {
+        st->hist[i] = t->runs[i];
+        st->free_runs += t->runs[i];
     }
-    return (used * 1000) / memtblsize[memx];
+    st->allocs = memallocs[memx];
+    st->frees = memfrees[memx];
+    st->fails = memfails[memx];
+    MEM_UNLOCK(memx, lock);
+    return 0;
 }
 
 /**
- * @brief   内存分配 (内部)
+ * @brief   清除峰值和次数统计 (重新开始统计, 峰值从当前使用量算起)
+ */
+void my_mem_stats_clear(uint8_t memx)
+{
+    uint32_t lock;
+    if (memx >= SRAMBANK || !mallco_dev.memrdy[memx]) return;
+    lock = MEM_LOCK(memx);
+    memtlsf[memx].peak = memtlsf[memx].used;
+    memallocs[memx] = 0;
+    memfrees[memx] = 0;
+    memfails[memx] = 0;
+    MEM_UNLOCK(memx, lock);
+}
+
+/**
+ * @brief   内存分配 (内部, 不经过每任务缓存)
  */
 uint32_t my_mem_malloc(uint8_t memx, uint32_t size)
 {
-    signed long offset = 0;
-    uint32_t nmemb, cmemb = 0, i;
+    uint32_t nmemb, index, start = 0, end = 0, lock;
     if (memx >= SRAMBANK || !mallco_dev.memrdy[memx] || size == 0) return 0XFFFFFFFF;
     nmemb = size / memblksize[memx];
     if (size % memblksize[memx]) nmemb++;
-    for (offset = memtblsize[memx] - 1; offset >= 0; offset--) {
-        if (!mallco_dev.memmap[memx][offset]) cmemb++;
-        else cmemb = 0;
-        if (cmemb == nmemb) {
-            for (i = 0; i < nmemb; i++) {
-                mallco_dev.memmap[memx][offset + i] = nmemb;
-            }
-            return offset * memblksize[memx];
-        }
+
+    lock = MEM_LOCK(memx);
+    index = mem_tlsf_alloc(&memtlsf[memx], nmemb);
+    if (index == MEM_TLSF_NONE) memfails[memx]++;
+    else memallocs[memx]++;
+    if (index != MEM_TLSF_NONE && index + nmemb > memclean[memx]) {         /* 延迟初始化: 水位之后的部分需要清零 */
+        start = index > memclean[memx] ? index : memclean[memx];
+        end = index + nmemb;
+        if (index <= memclean[memx]) memclean[memx] = end;
     }
-    return 0XFFFFFFFF;
+    MEM_UNLOCK(memx, lock);
+
+    if (index == MEM_TLSF_NONE) return 0XFFFFFFFF;
+    if (end > start) mymemset(mallco_dev.membase[memx] + start * memblksize[memx], 0, (end - start) * memblksize[memx]);
+    return index * memblksize[memx];
 }
 
 /**
- * @brief   内存释放 (内部)
+ * @brief   内存释放 (内部, 不经过每任务缓存)
  */
 uint8_t my_mem_free(uint8_t memx, uint32_t offset)
 {
-    int i, index, nmemb;
+    uint32_t nmemb, lock;
     if (memx >= SRAMBANK || !mallco_dev.memrdy[memx]) return 1;
-    if (offset >= memsize[memx]) return 2;
-    index = offset / memblksize[memx];
-    nmemb = mallco_dev.memmap[memx][index];
-    for (i = 0; i < nmemb; i++) {
-        mallco_dev.memmap[memx][index + i] = 0;
+    if (offset >= memsize[memx] || offset % memblksize[memx]) return 2;
+    lock = MEM_LOCK(memx);
+    nmemb = mem_tlsf_free(&memtlsf[memx], offset / memblksize[memx]);
+    if (nmemb) memfrees[memx]++;
+    MEM_UNLOCK(memx, lock);
+    return nmemb ? 0 : 2;
+}
+
+/**
+ * @brief   取当前任务的缓存
+ * @param   create : 1: 没有时从 MEM_MAG_BANK 申请一个
+ * @retval  缓存指针, NULL表示不能使用缓存 (中断中、调度器未启动、已关闭 或 申请失败)
+ */
+static mem_mag_t *mem_mag_get(uint8_t create)
+{
+    mem_mag_t *mag;
+    uint32_t offset;
+    if (!memcache_en || !MEM_CACHE_USABLE()) return NULL;
+    mag = (mem_mag_t *)MEM_TLS_GET();
+    if (mag == NULL && create) {
+        offset = my_mem_malloc(MEM_MAG_BANK, sizeof(mem_mag_t));
+        if (offset == 0XFFFFFFFF) return NULL;
+        mag = (mem_mag_t *)(mallco_dev.membase[MEM_MAG_BANK] + offset);
+        mymemset(mag, 0, sizeof(mem_mag_t));
+        MEM_TLS_SET(mag);
     }
-    return 0;
+    return mag;
+}
+
+/**
+ * @brief   把一块内存还给内存池 (不删除标记, 不输出记录)
+ * @note    缓存中的内存在 myfree 放入缓存时已删除标记; 缓存结构本身申请时就没有登记
+ */
+static void mem_free_block(uint8_t memx, void *ptr)
+{
+    my_mem_free(memx, (uint32_t)((uint8_t *)ptr - mallco_dev.membase[memx]));
+}
+
+/**
+ * @brief   把缓存中的内存全部还给内存池
+ */
+static void mem_mag_drain(mem_mag_t *mag)
+{
+    uint8_t memx, c;
+    for (memx = 0; memx < SRAMBANK; memx++) {
+        for (c = 0; c < MEM_MAG_CLASSES; c++) {
+            while (mag->cnt[memx][c]) {
+                mem_free_block(memx, mag->obj[memx][c][mag->cnt[memx][c] - 1]);
+                mag->cnt[memx][c]--;
+            }
+        }
+    }
+}
+
+/**
+ * @brief   开关每任务缓存
+ * @note    关闭时不清空已有缓存, 需要时由各任务调用 my_mem_cache_flush
+ */
+void my_mem_cache_enable(uint8_t en)
+{
+    memcache_en = en;
+}
+
+/**
+ * @brief   清空当前任务的缓存 (缓存的内存和缓存结构都还给内存池, 下次使用时重新申请)
+ */
+void my_mem_cache_flush(void)
+{
+    mem_mag_t *mag;
+    if (!MEM_CACHE_USABLE()) return;
+    mag = (mem_mag_t *)MEM_TLS_GET();
+    if (mag == NULL) return;
+    MEM_TLS_SET(NULL);
+    mem_mag_drain(mag);
+    mem_free_block(MEM_MAG_BANK, mag);
+}
+
+#ifndef MEM_HOST_BUILD
+/**
+ * @brief   任务删除时归还其缓存 (由 FreeRTOSConfig.h 中的 portCLEAN_UP_TCB 调用)
+ * @note    在内核临界区之外调用: 被其他任务删除时在 vTaskDelete 退出临界区后, 自删除时在空闲任务中.
+ *          被其他任务删除时, 若该任务恰好停在缓存存取的中间, 最多泄漏一块内存, 不会破坏内存池
+ * @param   task : 被删除任务的TCB
+ */
+void my_mem_cache_release(void *task)
+{
+    mem_mag_t *mag = (mem_mag_t *)pvTaskGetThreadLocalStoragePointer((TaskHandle_t)task, MEM_MAG_TLS_INDEX);
+    if (mag == NULL) return;
+    vTaskSetThreadLocalStoragePointer((TaskHandle_t)task, MEM_MAG_TLS_INDEX, NULL);
+    mem_mag_drain(mag);
+    mem_free_block(MEM_MAG_BANK, mag);
+}
+#endif
+
+/**
+ * @brief   内存释放 (不经过每任务缓存)
+ */
+void myfree_nocache(uint8_t memx, void *ptr)
+{
+    if (ptr == NULL || memx >= SRAMBANK) return;
+    MEM_TAG_FREE(memx, ptr);
+    mem_free_block(memx, ptr);
 }
 
 /**
  * @brief   内存释放 (用户接口)
+ * @note    1~MEM_MAG_CLASSES 块的小内存先放入当前任务的缓存, 缓存满了才还给内存池
  */
 void myfree(uint8_t memx, void *ptr)
 {
-    uint32_t offset;
-    if (ptr == NULL || memx >= SRAMBANK) return;
-    offset = (uint32_t)ptr - (uint32_t)mallco_dev.membase[memx];
+    uint32_t offset, nmemb;
+    mem_mag_t *mag;
+    if (ptr == NULL || memx >= SRAMBANK || !mallco_dev.memrdy[memx]) return;
+    offset = (uint32_t)((uint8_t *)ptr - mallco_dev.membase[memx]);
+    if (offset >= memsize[memx] || offset % memblksize[memx]) return;
+    MEM_TAG_FREE(memx, ptr);
+
+    mag = mem_mag_get(1);
+    if (mag) {
+        nmemb = mem_tlsf_size_fast(&memtlsf[memx], offset / memblksize[memx], MEM_MAG_CLASSES);
+        if (nmemb && mag->cnt[memx][nmemb - 1] < MEM_MAG_DEPTH) {
+            mag->obj[memx][nmemb - 1][mag->cnt[memx][nmemb - 1]] = ptr;
+            mag->cnt[memx][nmemb - 1]++;
+            return;
+        }
+    }
     my_mem_free(memx, offset);
 }
 
+/**
+ * @brief   内存分配 (不登记标记)
+ * @note    1~MEM_MAG_CLASSES 块的申请先从当前任务的缓存取, 取不到再向内存池申请
+ */
+static void *mem_alloc(uint8_t memx, uint32_t size)
+{
+    uint32_t offset, nmemb;
+    mem_mag_t *mag;
+    if (memx >= SRAMBANK || !mallco_dev.memrdy[memx] || size == 0) return NULL;
+
+    nmemb = size / memblksize[memx];
+    if (size % memblksize[memx]) nmemb++;
+    if (nmemb <= MEM_MAG_CLASSES) {
+        mag = mem_mag_get(0);
+        if (mag && mag->cnt[memx][nmemb - 1]) {
+            mag->cnt[memx][nmemb - 1]--;
+            return mag->obj[memx][nmemb - 1][mag->cnt[memx][nmemb - 1]];
+        }
+    }
+    offset = my_mem_malloc(memx, size);
+    return offset == 0XFFFFFFFF ? NULL : (void *)(mallco_dev.membase[memx] + offset);
+}
+
 /**
  * @brief   内存分配 (用户接口)
+ * @note    只要有不小于 size (按块上取整) 的连续空闲段就能成功, 失败说明最大连续空闲
+ *          (my_mem_stats 的 largest_free) 不够
+ * @param   memx : 所属内存块
+ * @param   size : 要分配的内存大小(字节)
+ * @retval  分配到的内存首地址, 失败返回 NULL
  */
 void *mymalloc(uint8_t memx, uint32_t size)
 {
-    uint32_t offset = my_mem_malloc(memx, size);
-    return offset == 0XFFFFFFFF ? NULL : (void *)((uint32_t)mallco_dev.membase[memx] + offset);
+    void *ptr = mem_alloc(memx, size);
+    MEM_TAG_ALLOC(memx, ptr, size, MEM_CALLER());
+    return ptr;
+}
+
+/**
+ * @brief   分配并清零 nmemb 个 size 字节的元素 (用户接口)
+ */
+void *mycalloc(uint8_t memx, uint32_t nmemb, uint32_t size)
+{
+    void *ptr;
+    if (size && nmemb > 0XFFFFFFFF / size) return NULL;
+    ptr = mem_alloc(memx, nmemb * size);
+    MEM_TAG_ALLOC(memx, ptr, nmemb * size, MEM_CALLER());
+    if (ptr) mymemset(ptr, 0, nmemb * size);
+    return ptr;
 }
 
 /**
  * @brief   内存重分配 (用户接口)
+ * @note    优先原地缩小/扩大 (后面相邻块空闲时), 不行才重新申请, 且只拷贝原有长度
  */
 void *myrealloc(uint8_t memx, void *ptr, uint32_t size)
 {
     void *newptr;
-    if (ptr == NULL) return mymalloc(memx, size);
+    uint32_t offset, index, oldn, nmemb, lock;
+    uint8_t done;
+    if (ptr == NULL) {
+        newptr = mem_alloc(memx, size);
+        MEM_TAG_ALLOC(memx, newptr, size, MEM_CALLER());
+        return newptr;
+    }
     if (size == 0) {
         myfree(memx, ptr);
         return NULL;
     }
-    newptr = mymalloc(memx, size);
+    if (memx >= SRAMBANK || !mallco_dev.memrdy[memx]) return NULL;
+
+    offset = (uint32_t)((uint8_t *)ptr - mallco_dev.membase[memx]);
+    if (offset >= memsize[memx] || offset % memblksize[memx]) return NULL;
+    index = offset / memblksize[memx];
+    nmemb = size / memblksize[memx];
+    if (size % memblksize[memx]) nmemb++;
+
+    lock = MEM_LOCK(memx);
+    oldn = mem_tlsf_size(&memtlsf[memx], index);
+    done = oldn && mem_tlsf_resize(&memtlsf[memx], index, nmemb);
+    MEM_UNLOCK(memx, lock);
+    if (oldn == 0) return NULL;
+    if (done) {
+        MEM_TAG_ALLOC(memx, ptr, size, MEM_CALLER());                       /* 原地调整: 更新原记录 */
+        return ptr;
+    }
+
+    newptr = mem_alloc(memx, size);
+    MEM_TAG_ALLOC(memx, newptr, size, MEM_CALLER());
     if (newptr) {
-        mymemcpy(newptr, ptr, size);
+        mymemcpy(newptr, ptr, oldn * memblksize[memx]);
         myfree(memx, ptr);
     }
     return newptr;
 }
+
+#ifndef MEM_HOST_BUILD
+/* ==================== 任务栈 (configSTACK_ALLOCATION_FROM_SEPARATE_HEAP = 1) ==================== */
+static mem_stack_stats_t memstack;                                          /* 任务栈统计 (持 SRAMCCM 锁更新) */
+
+/**
+ * @brief   为新任务申请栈 (FreeRTOS 创建任务时调用)
+ * @note    优先从 MEM_STACK_BANK(CCM) 申请: 零等待、只有CPU访问, 上下文切换时的压栈出栈不与DMA争用总线;
+ *          CCM 不够时退回 FreeRTOS 堆
+ */
+void *pvPortMallocStack(size_t xSize)
+{
+    void *stack = mymalloc(MEM_STACK_BANK, xSize);
+    uint32_t lock, bytes;
+
+    if (stack) {
+        lock = MEM_LOCK(MEM_STACK_BANK);
+        bytes = mem_tlsf_size(&memtlsf[MEM_STACK_BANK], (uint32_t)((uint8_t *)stack - mallco_dev.membase[MEM_STACK_BANK]) / memblksize[MEM_STACK_BANK]);
+        memstack.bank_bytes += bytes * memblksize[MEM_STACK_BANK];
+        if (memstack.bank_bytes > memstack.bank_peak) memstack.bank_peak = memstack.bank_bytes;
+        memstack.count++;
+        MEM_UNLOCK(MEM_STACK_BANK, lock);
+        return stack;
+    }
+
+    stack = pvPortMalloc(xSize);
+    if (stack) {
+        lock = MEM_LOCK(MEM_STACK_BANK);
+        memstack.heap_bytes += xSize;
+        memstack.count++;
+        memstack.fallback++;
+        MEM_UNLOCK(MEM_STACK_BANK, lock);
+    }
+    return stack;
+}
+
+/**
+ * @brief   释放任务栈 (FreeRTOS 删除任务时调用)
+ * @note    退回 FreeRTOS 堆的栈释放时不知道大小, 因此 heap_bytes 只增不减, 表示累计退回量;
+ *          每个任务的实际栈大小见 my_mem_stack_print
+ */
+void vPortFreeStack(void *pv)
+{
+    uint8_t *p = (uint8_t *)pv;
+    uint32_t lock, bytes;
+
+    if (pv == NULL) return;
+    if (p >= mallco_dev.membase[MEM_STACK_BANK] && p < mallco_dev.membase[MEM_STACK_BANK] + memsize[MEM_STACK_BANK]) {
+        lock = MEM_LOCK(MEM_STACK_BANK);
+        bytes = mem_tlsf_size(&memtlsf[MEM_STACK_BANK], (uint32_t)(p - mallco_dev.membase[MEM_STACK_BANK]) / memblksize[MEM_STACK_BANK]);
+        memstack.bank_bytes -= bytes * memblksize[MEM_STACK_BANK];
+        memstack.count--;
+        MEM_UNLOCK(MEM_STACK_BANK, lock);
+        myfree_nocache(MEM_STACK_BANK, pv);
+    } else {
+        vPortFree(pv);
+        lock = MEM_LOCK(MEM_STACK_BANK);
+        memstack.count--;
+        MEM_UNLOCK(MEM_STACK_BANK, lock);
+    }
+}
+
+/**
+ * @brief   获取任务栈统计
+ */
+void my_mem_stack_stats(mem_stack_stats_t *st)
+{
+    uint32_t lock = MEM_LOCK(MEM_STACK_BANK);
+    *st = memstack;
+    MEM_UNLOCK(MEM_STACK_BANK, lock);
+}
+
+/**
+ * @brief   通过串口打印每个任务的栈: 所在内存、大小、历史最少剩余
+ * @note    栈大小由 TaskStatus_t 的栈底/栈顶地址得出 (需 configRECORD_STACK_HIGH_ADDRESS = 1)
+ */
+void my_mem_stack_print(void)
+{
+    TaskStatus_t *status;
+    UBaseType_t i, n;
+    uint8_t *base;
+    uint32_t bytes, total = 0;
+
+    n = uxTaskGetNumberOfTasks();
+    status = (TaskStatus_t *)mymalloc(SRAMIN, n * sizeof(TaskStatus_t));
+    if (status == NULL) return;
+    n = uxTaskGetSystemState(status, n, NULL);
+
+    printf("%-16s %-6s %8s %8s\r\n", "task", "bank", "stack", "minfree");
+    for (i = 0; i < n; i++) {
+        base = (uint8_t *)status[i].pxStackBase;
+        bytes = (uint32_t)((uint8_t *)status[i].pxEndOfStack - base) + sizeof(StackType_t);
+        total += bytes;
+        printf("%-16s %-6s %8u %8u\r\n", status[i].pcTaskName,
+               (base >= mallco_dev.membase[MEM_STACK_BANK] && base < mallco_dev.membase[MEM_STACK_BANK] + memsize[MEM_STACK_BANK]) ? "CCM" : "heap",
+               bytes, (uint32_t)status[i].usStackHighWaterMark * sizeof(StackType_t));
+    }
+    printf("total %u bytes, CCM %u (peak %u), fallback %u\r\n", total, memstack.bank_bytes, memstack.bank_peak, memstack.fallback);
+    myfree(SRAMIN, status);
+}
+#endif
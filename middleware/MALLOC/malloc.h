@@ -1,7 +1,7 @@
 #ifndef __MALLOC_H
 #define __MALLOC_H
 
-#include "../../core/system/system_hal.h"
+#include "./mem_tlsf.h"
 
 #ifndef NULL
 #define NULL 0
@@ -17,18 +17,76 @@
 /* mem1: 内部SRAM (192KB总容量，预留12KB系统空间) */
 #define     MEM1_BLOCK_SIZE         32                              /* 32字节/块 */
 #define     MEM1_MAX_SIZE           180*1024                         /* 管理180KB */
-#define     MEM1_ALLOC_TABLE_SIZE   MEM1_MAX_SIZE / MEM1_BLOCK_SIZE  /* 180*1024/32=5760项 */
+#define     MEM1_ALLOC_TABLE_SIZE   MEM1_MAX_SIZE / MEM1_BLOCK_SIZE  /* 180*1024/32=5760块 */
+#define     MEM1_MAP_WORDS          MEM_TLSF_MAP_WORDS(MEM1_ALLOC_TABLE_SIZE)   /* 2*5760/32=360字 (1440字节) */
 
 /* mem2: CCM内存 (64KB总容量，预留4KB) */
 #define     MEM2_BLOCK_SIZE         32                              /* 32字节/块 */
 #define     MEM2_MAX_SIZE           60*1024                          /* 管理60KB */
-#define     MEM2_ALLOC_TABLE_SIZE   MEM2_MAX_SIZE / MEM2_BLOCK_SIZE  /* 60*1024/32=1920项 */
+#define     MEM2_ALLOC_TABLE_SIZE   MEM2_MAX_SIZE / MEM2_BLOCK_SIZE  /* 60*1024/32=1920块 */
+#define     MEM2_MAP_WORDS          MEM_TLSF_MAP_WORDS(MEM2_ALLOC_TABLE_SIZE)   /* 2*1920/32=120字 (480字节) */
 
 /* mem3: 外扩SRAM (1MB总容量，预留232KB给其他数据) */
 #define     MEM3_BLOCK_SIZE         32                              /* 32字节/块 */
 #define     MEM3_MAX_SIZE           768*1024                         /* 管理768KB内存池 */
-#define     MEM3_ALLOC_TABLE_SIZE   MEM3_MAX_SIZE / MEM3_BLOCK_SIZE  /* 768*1024/32=24576项 */
-/* 状态表占用：24576项 × 2字节 = 48KB，总占用768+48=816KB ≤ 1024KB */
+#define     MEM3_ALLOC_TABLE_SIZE   MEM3_MAX_SIZE / MEM3_BLOCK_SIZE  /* 768*1024/32=24576块 */
+#define     MEM3_MAP_WORDS          MEM_TLSF_MAP_WORDS(MEM3_ALLOC_TABLE_SIZE)   /* 2*24576/32=1536字 (6KB) */
+/* 状态表占用：6KB (原每块16位计数需48KB)，总占用768+6=774KB ≤ 1024KB，
+ * 0x680C1800之后的250KB外扩SRAM留给应用 */
+
+/* 分配引擎: 各内存池由 mem_tlsf 管理, 分配/释放只需常数次位图查找和位图写入,
+ * 状态表为每块2位 (占用位 + 段尾标记位), 块号用16位保存, 每池不超过 MEM_TLSF_MAX_BLOCKS 块
+ */
+
+/* 长度不小于该值时 mymemcpy_dma/mymemset_dma 才使用DMA2 (更短时DMA启动和等待开销大于收益) */
+#define     MEM_DMA_MIN_SIZE        1024
+
+/* 后台清零任务每次在临界区中处理的块数 (32块 = 1KB) */
+#define     MEM_SCRUB_CHUNK         32
+
+/* 每任务缓存: 1~MEM_MAG_CLASSES 块的小内存释放后先留在本任务缓存, 下次同样块数的申请直接取用,
+ * 不碰内存池锁. 缓存结构 (约200字节) 在任务第一次释放内存时从 MEM_MAG_BANK 申请,
+ * 保存在任务本地存储 MEM_MAG_TLS_INDEX (需 configNUM_THREAD_LOCAL_STORAGE_POINTERS ≥ 1) */
+#define     MEM_MAG_ENABLE          1                               /* 默认开启 */
+#define     MEM_MAG_CLASSES         4                               /* 缓存 1~4 块 (32~128字节) 的内存 */
+#define     MEM_MAG_DEPTH           4                               /* 每级最多缓存个数 */
+#define     MEM_MAG_BANK            SRAMIN                          /* 缓存结构所在内存池 */
+#define     MEM_MAG_TLS_INDEX       0                               /* 任务本地存储序号 */
+
+/* 申请标记: 记录每块内存的所属任务/申请位置/申请时间, my_mem_tag_dump 输出统计 (见 mem_tag.h) */
+#ifndef MEM_TAG_ENABLE
+#define     MEM_TAG_ENABLE          0                               /* 默认关闭, 调试泄漏/热点时置1 */
+#endif
+#ifndef MEM_TRACE_ENABLE
+#define     MEM_TRACE_ENABLE        0                               /* 1: 申请/释放记录输出到串口1, 供主机重放 */
+#endif
+
+/* 任务栈: 创建任务时优先从该内存池申请栈 (需 configSTACK_ALLOCATION_FROM_SEPARATE_HEAP = 1) */
+#define     MEM_STACK_BANK          SRAMCCM
+
+/* 任务栈统计 (my_mem_stack_stats) */
+typedef struct
+{
+    uint32_t bank_bytes;                /* MEM_STACK_BANK 中的栈字节数 (按块取整) */
+    uint32_t bank_peak;                 /* MEM_STACK_BANK 中栈字节数的峰值 */
+    uint32_t heap_bytes;                /* 累计退回 FreeRTOS 堆申请的栈字节数 */
+    uint32_t count;                     /* 当前栈个数 */
+    uint32_t fallback;                  /* 退回 FreeRTOS 堆的次数 */
+} mem_stack_stats_t;
+
+/* 内存池统计 (my_mem_stats), 字节数均按块取整 */
+typedef struct
+{
+    uint32_t total;                     /* 内存池大小 */
+    uint32_t used;                      /* 已用字节数 */
+    uint32_t peak;                      /* 历史最大已用字节数 */
+    uint32_t largest_free;              /* 最大连续空闲字节数 (不超过该值的 mymalloc 一定成功) */
+    uint32_t free_runs;                 /* 空闲段个数 */
+    uint16_t hist[MEM_TLSF_FL_COUNT];   /* 空闲段直方图: hist[0] 为1~7块, hist[k] 为 2^(k+2) ~ 2^(k+3)-1 块 */
+    uint32_t allocs;                    /* 申请成功次数 */
+    uint32_t frees;                     /* 释放次数 */
+    uint32_t fails;                     /* 申请失败次数 */
+} mem_stats_t;
 
 /* 内存管理控制器 */
 struct _m_mallco_dev
@@ -36,7 +94,7 @@ struct _m_mallco_dev
     void (*init)(uint8_t);              /* 初始化函数 */
     uint16_t (*perused)(uint8_t);       /* 使用率函数 (扩大10倍) */
     uint8_t *membase[SRAMBANK];         /* 内存池基地址 */
-    uint16_t *memmap[SRAMBANK];         /* 状态表基地址 */
+    uint32_t *memmap[SRAMBANK];         /* 状态表基地址 (占用位图 + 段尾位图) */
     uint8_t memrdy[SRAMBANK];           /* 就绪标志 */
 };
 
@@ -45,14 +103,28 @@ extern struct _m_mallco_dev mallco_dev;
 /* 底层函数 */
 void mymemset(void *s, uint8_t c, uint32_t count);
 void mymemcpy(void *des, void *src, uint32_t n);
+void mymemset_dma(void *s, uint8_t c, uint32_t count);
+void mymemcpy_dma(void *des, void *src, uint32_t n);
 void my_mem_init(uint8_t memx);
+void my_mem_init_lazy(uint8_t memx);
+uint8_t my_mem_scrub(uint8_t memx, uint32_t nblocks);
+void my_mem_scrub_start(void);
 uint32_t my_mem_malloc(uint8_t memx, uint32_t size);
 uint8_t my_mem_free(uint8_t memx, uint32_t offset);
 uint16_t my_mem_perused(uint8_t memx);
+uint8_t my_mem_stats(uint8_t memx, mem_stats_t *st);
+void my_mem_stats_clear(uint8_t memx);
+void my_mem_cache_enable(uint8_t en);
+void my_mem_cache_flush(void);
+void my_mem_cache_release(void *task);
+void my_mem_stack_stats(mem_stack_stats_t *st);
+void my_mem_stack_print(void);
 
 /* 用户接口 */
 void myfree(uint8_t memx, void *ptr);
+void myfree_nocache(uint8_t memx, void *ptr);
 void *mymalloc(uint8_t memx, uint32_t size);
+void *mycalloc(uint8_t memx, uint32_t nmemb, uint32_t size);
 void *myrealloc(uint8_t memx, void *ptr, uint32_t size);
 
 #endif
@@ -0,0 +1,54 @@
+/**
+ ****************************************************************************************************
+ * @file        mem_lock.h
+ * @brief       内存管理内部使用的锁 与 任务本地存储 (malloc.c / mempool.c 共用)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 板上: 锁为抬高BASEPRI (屏蔽受FreeRTOS管理的中断, 可在任务和中断中使用, 可嵌套),
+ *       只包住常数时间的操作, 大块清零/拷贝都在锁外进行, 因此不影响中断延迟;
+ *       每任务缓存指针保存在任务的线程本地存储中, 中断里和调度器启动前不使用缓存.
+ * 主机: 每个内存池一把pthread互斥锁, 线程局部变量代替任务本地存储 (test/下的竞争基准测试)
+ *
+ * MEM_MUTEX_xxx: 只在任务中使用、可以较长时间持有的互斥锁 (不屏蔽中断), 给要遍历整个结构的模块
+ * (可移动句柄内存区、分配标记) 用. 板上为FreeRTOS互斥信号量 (优先级继承, 调度器启动前也可用), 主机为pthread互斥锁.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEM_LOCK_H
+#define __MEM_LOCK_H
+
+#include "./malloc.h"
+
+#ifdef MEM_HOST_BUILD
+#include <pthread.h>
+extern pthread_mutex_t memlock[SRAMBANK];                                   /* malloc.c */
+extern __thread void *memtls;
+#define MEM_LOCK(memx)          (pthread_mutex_lock(&memlock[memx]), 0U)
+#define MEM_UNLOCK(memx, s)     do{ (void)(s); pthread_mutex_unlock(&memlock[memx]); }while(0)
+#define MEM_CACHE_USABLE()      1
+#define MEM_TLS_GET()           memtls
+#define MEM_TLS_SET(p)          (memtls = (p))
+#define MEM_MUTEX_T             pthread_mutex_t
+#define MEM_MUTEX_INIT(m)       (pthread_mutex_init(&(m), NULL) == 0)
+#define MEM_MUTEX_TAKE(m)       pthread_mutex_lock(&(m))
+#define MEM_MUTEX_GIVE(m)       pthread_mutex_unlock(&(m))
+#define MEM_MUTEX_DELETE(m)     pthread_mutex_destroy(&(m))
+#else
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#define MEM_LOCK(memx)          portSET_INTERRUPT_MASK_FROM_ISR()
+#define MEM_UNLOCK(memx, s)     portCLEAR_INTERRUPT_MASK_FROM_ISR(s)
+#define MEM_CACHE_USABLE()      (__get_IPSR() == 0 && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+#define MEM_TLS_GET()           pvTaskGetThreadLocalStoragePointer(NULL, MEM_MAG_TLS_INDEX)
+#define MEM_TLS_SET(p)          vTaskSetThreadLocalStoragePointer(NULL, MEM_MAG_TLS_INDEX, (p))
+#define MEM_MUTEX_T             SemaphoreHandle_t
+#define MEM_MUTEX_INIT(m)       (((m) = xSemaphoreCreateMutex()) != NULL)
+#define MEM_MUTEX_TAKE(m)       xSemaphoreTake((m), portMAX_DELAY)
+#define MEM_MUTEX_GIVE(m)       xSemaphoreGive(m)
+#define MEM_MUTEX_DELETE(m)     vSemaphoreDelete(m)
+#endif
+
+#endif
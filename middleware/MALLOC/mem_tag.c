@@ -0,0 +1,319 @@
+/**
+ ****************************************************************************************************
+ * @file        mem_tag.c
+ * @brief       内存申请标记 与 泄漏/热点统计
+ ****************************************************************************************************
+ * @attention
+ *
+ * 存活内存表: 开放寻址哈希表, 键为 (内存池 << 16 | 块号), 记录只放在理想位置起的 MEM_TAG_PROBE 个槽内:
+ *   查找/登记/删除都只看这几个槽 (删除直接置空, 不需要补位), 锁内时间有上限; 几个槽都满时不登记 (计入 dropped).
+ * 申请位置表: 按地址线性查找 (最多 MEM_TAG_SITES 项), 满了之后的新位置计入最后一项 "其他".
+ * 两张表由 SRAMIN 的内存池锁 (BASEPRI) 保护, 只包住上面这些有界的操作;
+ * my_mem_tag_dump 每次持锁只拷贝 MEM_TAG_DUMP_CHUNK 条, 统计/排序/打印都在锁外.
+ *
+ ****************************************************************************************************
+ */
+
+#include "./mem_tag.h"
+#include "./mem_lock.h"
+#include <stdio.h>
+
+#if MEM_TAG_ENABLE
+
+#define MEM_TAG_EMPTY           0XFFFFFFFF
+#define MEM_TAG_PROBE           16                                          /* 每条记录最多离理想位置的槽数 */
+#define MEM_TAG_DUMP_CHUNK      32                                          /* 输出时每次持锁拷贝的记录数 */
+#define MEM_TAG_LOCK()          MEM_LOCK(SRAMIN)
+#define MEM_TAG_UNLOCK(s)       MEM_UNLOCK(SRAMIN, s)
+
+#if MEM_TAG_MAX % MEM_TAG_DUMP_CHUNK || MEM_TAG_PROBE > MEM_TAG_MAX
+#error "MEM_TAG_MAX 须为 MEM_TAG_DUMP_CHUNK 的倍数, 且不小于 MEM_TAG_PROBE"
+#endif
+
+/* 存活内存记录 (20字节) */
+typedef struct
+{
+    uint32_t key;                       /* 内存池 << 16 | 块号, MEM_TAG_EMPTY 表示空 */
+    uint32_t size;                      /* 申请字节数 */
+    uint32_t site;                      /* 申请位置 */
+    uint32_t time;                      /* 申请时刻 (ms) */
+    void *owner;                        /* 所属任务, NULL 表示中断或调度器启动前 */
+} mem_tag_t;
+
+/* 申请位置统计 */
+typedef struct
+{
+    uint32_t site;                      /* 申请位置, 0 表示未使用 */
+    uint32_t count;                     /* 申请次数 */
+    uint32_t bytes;                     /* 累计申请字节 */
+    uint32_t live;                      /* 存活字节 */
+} mem_site_t;
+
+static mem_tag_t memtag[MEM_TAG_MAX];
+static mem_site_t memsite[MEM_TAG_SITES];
+static uint8_t memtag_ready;
+static uint32_t memtag_dropped;                                             /* 表满未能登记的次数 */
+static uint32_t memtag_since;                                               /* 开始统计的时刻 (ms) */
+
+extern const uint32_t memblksize[SRAMBANK];
+
+#ifdef MEM_HOST_BUILD
+static uint32_t mem_tag_now(void)
+{
+    return 0;
+}
+#define MEM_TAG_OWNER()         NULL
+#else
+static uint32_t mem_tag_now(void)
+{
+    TickType_t t = (__get_IPSR() == 0) ? xTaskGetTickCount() : xTaskGetTickCountFromISR();
+    return (uint32_t)(t * portTICK_PERIOD_MS);
+}
+#define MEM_TAG_OWNER()         ((__get_IPSR() == 0 && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) ? (void *)xTaskGetCurrentTaskHandle() : NULL)
+#endif
+
+/**
+ * @brief   首次使用时初始化
+ */
+static void mem_tag_init(void)
+{
+    uint32_t i;
+    for (i = 0; i < MEM_TAG_MAX; i++) memtag[i].key = MEM_TAG_EMPTY;
+    for (i = 0; i < MEM_TAG_SITES; i++) memsite[i].site = 0;
+    memtag_dropped = 0;
+    memtag_since = mem_tag_now();
+    memtag_ready = 1;
+}
+
+static uint32_t mem_tag_key(uint8_t memx, void *ptr)
+{
+    return ((uint32_t)memx << 16) | (uint32_t)(((uint8_t *)ptr - mallco_dev.membase[memx]) / memblksize[memx]);
+}
+
+static uint32_t mem_tag_hash(uint32_t key)
+{
+    return (key * 2654435761U) >> 16 & (MEM_TAG_MAX - 1);
+}
+
+/**
+ * @brief   查找申请位置统计项 (没有则新建, 满了用最后一项)
+ */
+static mem_site_t *mem_tag_site(uint32_t site)
+{
+    uint32_t i;
+    for (i = 0; i < MEM_TAG_SITES - 1; i++) {
+        if (memsite[i].site == site) return &memsite[i];
+        if (memsite[i].site == 0) {
+            memsite[i].site = site;
+            memsite[i].count = 0;
+            memsite[i].bytes = 0;
+            memsite[i].live = 0;
+            return &memsite[i];
+        }
+    }
+    memsite[i].site = 1;                                                    /* "其他" */
+    return &memsite[i];
+}
+
+/**
+ * @brief   在理想位置起的 MEM_TAG_PROBE 个槽中找 key (持锁调用)
+ * @param   empty : 输出第一个空槽, MEM_TAG_MAX 表示没有
+ * @retval  key 所在槽, MEM_TAG_MAX 表示没有
+ */
+static uint32_t mem_tag_find(uint32_t key, uint32_t *empty)
+{
+    uint32_t i, n;
+
+    *empty = MEM_TAG_MAX;
+    for (i = mem_tag_hash(key), n = 0; n < MEM_TAG_PROBE; i = (i + 1) & (MEM_TAG_MAX - 1), n++) {
+        if (memtag[i].key == key) return i;
+        if (memtag[i].key == MEM_TAG_EMPTY && *empty == MEM_TAG_MAX) *empty = i;
+    }
+    return MEM_TAG_MAX;
+}
+
+/**
+ * @brief   登记一块内存 (已登记的则更新, 用于 myrealloc 原地调整)
+ */
+void mem_tag_add(uint8_t memx, void *ptr, uint32_t size, uint32_t site)
+{
+    uint32_t i, empty, key, lock;
+    mem_site_t *s;
+
+    key = mem_tag_key(memx, ptr);
+    lock = MEM_TAG_LOCK();
+    if (!memtag_ready) mem_tag_init();
+
+    i = mem_tag_find(key, &empty);
+    if (i < MEM_TAG_MAX) mem_tag_site(memtag[i].site)->live -= memtag[i].size;    /* 原地调整: 先撤销旧记录的存活字节 */
+    else i = empty;
+
+    s = mem_tag_site(site);
+    s->count++;
+    s->bytes += size;
+    if (i == MEM_TAG_MAX) {
+        memtag_dropped++;
+    } else {
+        s->live += size;
+        memtag[i].key = key;
+        memtag[i].size = size;
+        memtag[i].site = site;
+        memtag[i].time = mem_tag_now();
+        memtag[i].owner = MEM_TAG_OWNER();
+    }
+    MEM_TAG_UNLOCK(lock);
+}
+
+/**
+ * @brief   删除一块内存的记录
+ */
+void mem_tag_del(uint8_t memx, void *ptr)
+{
+    uint32_t i, empty, key, lock;
+
+    if (!memtag_ready || ptr == NULL) return;
+    key = mem_tag_key(memx, ptr);
+    lock = MEM_TAG_LOCK();
+    i = mem_tag_find(key, &empty);
+    if (i < MEM_TAG_MAX) {
+        mem_tag_site(memtag[i].site)->live -= memtag[i].size;
+        memtag[i].key = MEM_TAG_EMPTY;
+    }
+    MEM_TAG_UNLOCK(lock);
+}
+
+/**
+ * @brief   清除申请位置统计 (存活内存记录保留), 重新开始计算申请频率
+ */
+void my_mem_tag_clear(void)
+{
+    uint32_t i, lock = MEM_TAG_LOCK();
+    if (!memtag_ready) mem_tag_init();
+    for (i = 0; i < MEM_TAG_SITES; i++) {
+        memsite[i].count = 0;
+        memsite[i].bytes = 0;
+    }
+    memtag_dropped = 0;
+    memtag_since = mem_tag_now();
+    MEM_TAG_UNLOCK(lock);
+}
+
+#ifndef MEM_HOST_BUILD
+static TaskStatus_t memtag_tasks[16];                                       /* 打印时的任务快照 */
+static UBaseType_t memtag_ntasks;
+#endif
+
+/**
+ * @brief   所属任务名 (只比较句柄值, 不访问可能已释放的TCB; 已删除的任务显示 "(deleted)")
+ */
+static const char *mem_tag_owner_name(void *owner)
+{
+#ifndef MEM_HOST_BUILD
+    UBaseType_t i;
+    for (i = 0; i < memtag_ntasks; i++) {
+        if ((void *)memtag_tasks[i].xHandle == owner) return memtag_tasks[i].pcTaskName;
+    }
+#endif
+    return owner ? "(deleted)" : "-";
+}
+
+/**
+ * @brief   通过串口1输出 各任务占用表 / 申请位置直方图 / 最老的存活内存
+ * @note    在任务中调用, 不要在多个任务中同时调用 (共用静态缓冲).
+ *          记录表分段拷贝: 每次持锁只拷贝 MEM_TAG_DUMP_CHUNK 条, 统计和排序在锁外进行;
+ *          各段之间的申请/释放会反映在后面的段中, 结果是近似快照
+ */
+void my_mem_tag_dump(void)
+{
+    static mem_site_t site[MEM_TAG_SITES];
+    static struct { void *owner; uint32_t bytes[SRAMBANK]; uint32_t cnt; } own[16];
+    static mem_tag_t old[MEM_TAG_OLDEST];
+    static mem_tag_t chunk[MEM_TAG_DUMP_CHUNK];
+    uint32_t i, j, k, c, nown = 0, nold = 0, lock, now, elapsed, dropped;
+    mem_site_t tmp;
+    mem_tag_t *t;
+
+    lock = MEM_TAG_LOCK();
+    if (!memtag_ready) mem_tag_init();
+    now = mem_tag_now();
+    elapsed = now - memtag_since;
+    dropped = memtag_dropped;
+    for (i = 0; i < MEM_TAG_SITES; i++) site[i] = memsite[i];
+    MEM_TAG_UNLOCK(lock);
+
+    for (c = 0; c < MEM_TAG_MAX; c += MEM_TAG_DUMP_CHUNK) {
+        lock = MEM_TAG_LOCK();
+        for (i = 0; i < MEM_TAG_DUMP_CHUNK; i++) chunk[i] = memtag[c + i];
+        MEM_TAG_UNLOCK(lock);
+
+        for (i = 0; i < MEM_TAG_DUMP_CHUNK; i++) {
+            t = &chunk[i];
+            if (t->key == MEM_TAG_EMPTY) continue;
+            for (j = 0; j < nown && own[j].owner != t->owner; j++);
+            if (j == nown && nown < 16) {
+                own[j].owner = t->owner;
+                for (k = 0; k < SRAMBANK; k++) own[j].bytes[k] = 0;
+                own[j].cnt = 0;
+                nown++;
+            }
+            if (j < nown) {
+                own[j].bytes[t->key >> 16] += t->size;
+                own[j].cnt++;
+            }
+            for (j = nold; j > 0 && (int32_t)(t->time - old[j - 1].time) < 0; j--) {   /* 按申请时刻插入排序 */
+                if (j < MEM_TAG_OLDEST) old[j] = old[j - 1];
+            }
+            if (j < MEM_TAG_OLDEST) {
+                old[j] = *t;
+                if (nold < MEM_TAG_OLDEST) nold++;
+            }
+        }
+    }
+
+#ifndef MEM_HOST_BUILD
+    memtag_ntasks = uxTaskGetSystemState(memtag_tasks, 16, NULL);           /* 任务多于16个时返回0, 全部显示为 (deleted) */
+#endif
+    printf("\r\n[mem tag] %u ms, dropped %u\r\n", elapsed, dropped);
+    printf("%-16s %10s %10s %10s %6s\r\n", "owner", "SRAMIN", "SRAMCCM", "SRAMEX", "blocks");
+    for (i = 0; i < nown; i++) {
+        printf("%-16s %10u %10u %10u %6u\r\n", mem_tag_owner_name(own[i].owner), own[i].bytes[SRAMIN],
+               own[i].bytes[SRAMCCM], own[i].bytes[SRAMEX], own[i].cnt);
+    }
+
+    for (i = 1; i < MEM_TAG_SITES; i++) {                                   /* 按申请次数降序 */
+        tmp = site[i];
+        for (j = i; j > 0 && site[j - 1].count < tmp.count; j--) site[j] = site[j - 1];
+        site[j] = tmp;
+    }
+    printf("%-10s %10s %10s %10s %10s\r\n", "site", "allocs", "allocs/s", "bytes", "live");
+    for (i = 0; i < MEM_TAG_SITES && site[i].site; i++) {
+        if (site[i].site == 1) printf("%-10s", "other");
+        else printf("0x%08X", site[i].site);
+        printf(" %10u %10u %10u %10u\r\n", site[i].count,
+               elapsed ? (uint32_t)((uint64_t)site[i].count * 1000 / elapsed) : 0, site[i].bytes, site[i].live);
+    }
+
+    printf("%-6s %10s %10s %-10s %s\r\n", "bank", "bytes", "age(ms)", "site", "owner");
+    for (i = 0; i < nold; i++) {
+        printf("%-6u %10u %10u 0x%08X %s\r\n", old[i].key >> 16, old[i].size, now - old[i].time, old[i].site,
+               mem_tag_owner_name(old[i].owner));
+    }
+}
+
+#else
+void mem_tag_add(uint8_t memx, void *ptr, uint32_t size, uint32_t site) { }
+void mem_tag_del(uint8_t memx, void *ptr) { }
+void my_mem_tag_dump(void) { }
+void my_mem_tag_clear(void) { }
+#endif
+
+/**
+ * @brief   输出一行申请/释放记录 (格式见 mem_tag.h)
+ * @param   op   : 'm' 申请, 'f' 释放
+ * @param   heap : 内存池编号, MEM_TRACE_RTOS 表示 FreeRTOS 堆
+ */
+void mem_trace(char op, uint8_t heap, void *ptr, uint32_t size)
+{
+    if (ptr == NULL) return;
+    printf("@%c %u %08X %u\r\n", op, heap, (uint32_t)(uintptr_t)ptr, size);
+}
@@ -0,0 +1,66 @@
+/**
+ ****************************************************************************************************
+ * @file        mem_tag.h
+ * @brief       内存申请标记 (可选): 记录每块内存的 所属任务 / 申请位置 / 申请时间, 统计各申请位置的申请频率
+ ****************************************************************************************************
+ * @attention
+ *
+ * malloc.h 中 MEM_TAG_ENABLE 置1后, mymalloc/mycalloc/myrealloc 申请成功时登记一条记录,
+ * myfree 时删除; 记录放在独立的哈希表中 (每条20字节, 最多 MEM_TAG_MAX 条), 不改变内存池布局.
+ * 每次登记/删除为一次哈希查找 (最多看 16 个槽, 锁内时间有上限), 可以在联调版本中常开.
+ * my_mem_tag_dump 通过串口1(printf) 输出:
+ *   各任务占用表: 每个任务(中断/启动阶段记为 "-") 在各内存池中的存活字节数和块数
+ *   申请位置直方图: 按申请次数排序, 含申请频率(次/秒)、累计字节、存活字节, 地址可在 .map 文件中查到函数
+ *   最老的存活内存: 存活时间最长的若干条, 用于查找泄漏
+ *
+ * MEM_TRACE_ENABLE 置1后, 每次申请/释放向串口1输出一行记录 (轮询发送, 很慢, 只用于采集):
+ *   @m <堆> <地址> <字节数>      申请 (同一地址再次出现 @m 表示 myrealloc 原地调整)
+ *   @f <堆> <地址> 0             释放
+ * <堆> 为内存池编号, MEM_TRACE_RTOS 表示 FreeRTOS 堆 (FreeRTOSConfig.h 中 configHEAP_TRACE 置1).
+ * 串口日志可直接交给主机程序 test/heap/trace_replay 重放, 非 '@' 开头的行被忽略.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEM_TAG_H
+#define __MEM_TAG_H
+
+#include "./malloc.h"
+
+#define MEM_TAG_MAX             512                                         /* 最多记录的存活内存数 (2的幂) */
+#define MEM_TAG_SITES           32                                          /* 最多统计的申请位置数 */
+#define MEM_TAG_OLDEST          8                                           /* 输出的最老存活内存条数 */
+
+/* 调用者地址 (在 mymalloc 等函数体内展开, 得到调用它们的位置) */
+#if defined(__CC_ARM)
+#define MEM_CALLER()            ((uint32_t)__return_address())
+#else
+#define MEM_CALLER()            ((uint32_t)(uintptr_t)__builtin_return_address(0))
+#endif
+
+#define MEM_TRACE_RTOS          SRAMBANK                                    /* 记录行中 FreeRTOS 堆的编号 */
+
+#if MEM_TAG_ENABLE
+#define MEM_TAG_ADD(memx, ptr, size, site)      mem_tag_add((memx), (ptr), (size), (site))
+#define MEM_TAG_DEL(memx, ptr)                  mem_tag_del((memx), (ptr))
+#else
+#define MEM_TAG_ADD(memx, ptr, size, site)
+#define MEM_TAG_DEL(memx, ptr)
+#endif
+
+#if MEM_TRACE_ENABLE
+#define MEM_TRACE(op, memx, ptr, size)          mem_trace((op), (memx), (ptr), (size))
+#else
+#define MEM_TRACE(op, memx, ptr, size)
+#endif
+
+#define MEM_TAG_ALLOC(memx, ptr, size, site)    do{ if (ptr) { MEM_TAG_ADD(memx, ptr, size, site); MEM_TRACE('m', memx, ptr, size); } }while(0)
+#define MEM_TAG_FREE(memx, ptr)                 do{ MEM_TAG_DEL(memx, ptr); MEM_TRACE('f', memx, ptr, 0); }while(0)
+
+void mem_tag_add(uint8_t memx, void *ptr, uint32_t size, uint32_t site);
+void mem_tag_del(uint8_t memx, void *ptr);
+void my_mem_tag_dump(void);
+void my_mem_tag_clear(void);
+void mem_trace(char op, uint8_t heap, void *ptr, uint32_t size);
+
+#endif
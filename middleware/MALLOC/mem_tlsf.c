@@ -0,0 +1,396 @@
+/**
+ ****************************************************************************************************
+ * @file        mem_tlsf.c
+ * @brief       内存池分配引擎 (TLSF两级位图 + 分级空闲链表, 分配/释放时间有界)
+ ****************************************************************************************************
+ */
+
+#include "./mem_tlsf.h"
+
+/* 空闲段头, 存放在空闲段首块的起始处 */
+typedef struct
+{
+    uint32_t nmemb;                                                         /* 空闲段块数 */
+    uint16_t prev;                                                          /* 同级链表前驱块号 */
+    uint16_t next;                                                          /* 同级链表后继块号 */
+} mem_tlsf_free_t;
+
+/**
+ * @brief   最低置位位的序号 (x != 0)
+ */
+static uint32_t mem_tlsf_ctz(uint32_t x)
+{
+    return 31 - MEM_CLZ(x & (0U - x));
+}
+
+/**
+ * @brief   块数 -> (一级, 二级) 索引
+ */
+static void mem_tlsf_mapping(uint32_t n, uint32_t *fl, uint32_t *sl)
+{
+    uint32_t t;
+    if (n < MEM_TLSF_SL_COUNT) {
+        *fl = 0;
+        *sl = n;
+    } else {
+        t = 31 - MEM_CLZ(n);
+        *sl = (n >> (t - MEM_TLSF_SL_LOG2)) - MEM_TLSF_SL_COUNT;
+        *fl = t - MEM_TLSF_SL_LOG2 + 1;
+    }
+}
+
+/**
+ * @brief   空闲段头 / 尾标记 (尾标记占用段尾块最后4字节)
+ */
+static mem_tlsf_free_t *mem_tlsf_hdr(mem_tlsf_t *t, uint32_t index)
+{
+    return (mem_tlsf_free_t *)(t->base + index * t->blksize);
+}
+
+static uint32_t *mem_tlsf_ftr(mem_tlsf_t *t, uint32_t last)
+{
+    return (uint32_t *)(t->base + (last + 1) * t->blksize - sizeof(uint32_t));
+}
+
+/**
+ * @brief   位图操作: 测试 / 置位 / 清零 [index, index + n) 范围的位
+ */
+static uint32_t mem_tlsf_bit(uint32_t *map, uint32_t index)
+{
+    return (map[index >> 5] >> (index & 31)) & 1;
+}
+
+static void mem_tlsf_bits(uint32_t *map, uint32_t index, uint32_t n, uint8_t set)
+{
+    uint32_t w = index >> 5, mask, cnt;
+    index &= 31;
+    while (n) {
+        cnt = 32 - index;
+        if (cnt > n) cnt = n;
+        mask = (cnt == 32) ? 0XFFFFFFFF : (((1U << cnt) - 1) << index);
+        if (set) map[w] |= mask;
+        else map[w] &= ~mask;
+        n -= cnt;
+        index = 0;
+        w++;
+    }
+}
+
+/**
+ * @brief   块是否空闲
+ */
+static uint8_t mem_tlsf_is_free(mem_tlsf_t *t, uint32_t index)
+{
+    return !mem_tlsf_bit(t->usedmap, index);
+}
+
+/**
+ * @brief   重新求一条链表中的最大段 (摘除了原最大段时)
+ * @note    遍历该链表, 遇到级别上限长度的段即停止: 级别宽度为1 (块数 < 16) 时只看链表头;
+ *          更高级别的段较长, 链表中的段数不超过 块总数 / 级别下限
+ */
+static void mem_tlsf_max_update(mem_tlsf_t *t, uint32_t fl, uint32_t sl)
+{
+    uint32_t index, n, top, max = 0, maxi = MEM_TLSF_NIL;
+
+    top = (fl == 0) ? sl : ((sl + MEM_TLSF_SL_COUNT + 1) << (fl - 1)) - 1;  /* 该级别的最大块数 */
+    for (index = t->head[fl][sl]; index != MEM_TLSF_NIL; index = mem_tlsf_hdr(t, index)->next) {
+        n = mem_tlsf_hdr(t, index)->nmemb;
+        if (n > max) {
+            max = n;
+            maxi = index;
+            if (n == top) break;
+        }
+    }
+    t->maxn[fl][sl] = max;
+    t->maxi[fl][sl] = maxi;
+}
+
+/**
+ * @brief   空闲段挂入对应级别链表头部
+ */
+static void mem_tlsf_insert(mem_tlsf_t *t, uint32_t index, uint32_t nmemb)
+{
+    uint32_t fl, sl;
+    mem_tlsf_free_t *hdr = mem_tlsf_hdr(t, index);
+
+    mem_tlsf_mapping(nmemb, &fl, &sl);
+    hdr->nmemb = nmemb;
+    hdr->prev = MEM_TLSF_NIL;
+    hdr->next = t->head[fl][sl];
+    if (hdr->next != MEM_TLSF_NIL) mem_tlsf_hdr(t, hdr->next)->prev = index;
+    t->head[fl][sl] = index;
+    if (hdr->next == MEM_TLSF_NIL || nmemb > t->maxn[fl][sl]) {             /* 维护本链表的最大段 */
+        t->maxn[fl][sl] = nmemb;
+        t->maxi[fl][sl] = index;
+    }
+    *mem_tlsf_ftr(t, index + nmemb - 1) = nmemb;
+    t->runs[fl]++;
+    t->flmap |= 1U << fl;
+    t->slmap[fl] |= 1U << sl;
+}
+
+/**
+ * @brief   空闲段从链表摘除
+ */
+static void mem_tlsf_remove(mem_tlsf_t *t, uint32_t index)
+{
+    uint32_t fl, sl;
+    mem_tlsf_free_t *hdr = mem_tlsf_hdr(t, index);
+
+    mem_tlsf_mapping(hdr->nmemb, &fl, &sl);
+    if (hdr->prev != MEM_TLSF_NIL) mem_tlsf_hdr(t, hdr->prev)->next = hdr->next;
+    else t->head[fl][sl] = hdr->next;
+    if (hdr->next != MEM_TLSF_NIL) mem_tlsf_hdr(t, hdr->next)->prev = hdr->prev;
+    if (t->maxi[fl][sl] == index) mem_tlsf_max_update(t, fl, sl);
+    t->runs[fl]--;
+    if (t->head[fl][sl] == MEM_TLSF_NIL) {
+        t->slmap[fl] &= ~(1U << sl);
+        if (!t->slmap[fl]) t->flmap &= ~(1U << fl);
+    }
+}
+
+/**
+ * @brief   查找能容纳 nmemb 块的空闲段
+ * @note    先把请求上取整到下一级别, 该级别及以上的任一空闲段都必然够用, 两次__CLZ即可定位;
+ *          找不到时再看请求本身所在级别链表的最大段 (插入/摘除时维护), 够用就取它.
+ *          只要有够用的空闲段就不会失败
+ * @retval  空闲段首块号, MEM_TLSF_NIL表示没有
+ */
+static uint32_t mem_tlsf_find(mem_tlsf_t *t, uint32_t nmemb)
+{
+    uint32_t fl, sl, n = nmemb, map;
+
+    if (n >= MEM_TLSF_SL_COUNT) n += (1U << (31 - MEM_CLZ(n) - MEM_TLSF_SL_LOG2)) - 1;
+    mem_tlsf_mapping(n, &fl, &sl);
+    if (fl < MEM_TLSF_FL_COUNT) {
+        map = t->slmap[fl] & (~0U << sl);
+        if (!map) {
+            map = t->flmap & (~0U << (fl + 1));
+            if (map) {
+                fl = mem_tlsf_ctz(map);
+                map = t->slmap[fl];
+            }
+        }
+        if (map) return t->head[fl][mem_tlsf_ctz(map)];
+    }
+
+    mem_tlsf_mapping(nmemb, &fl, &sl);
+    if (t->maxn[fl][sl] >= nmemb) return t->maxi[fl][sl];
+    return MEM_TLSF_NIL;
+}
+
+/**
+ * @brief   初始化引擎, 整个内存池作为一个空闲段
+ * @param   base    : 内存池基地址
+ * @param   map     : 状态表 (MEM_TLSF_MAP_WORDS(nblocks)个字, 本函数清零)
+ * @param   blksize : 块大小, 至少16字节 (需容纳空闲段头和尾标记)
+ * @param   nblocks : 块总数, 不超过 MEM_TLSF_MAX_BLOCKS
+ */
+void mem_tlsf_init(mem_tlsf_t *t, uint8_t *base, uint32_t *map, uint32_t blksize, uint32_t nblocks)
+{
+    uint32_t i, j;
+    t->base = base;
+    t->usedmap = map;
+    t->endmap = map + MEM_TLSF_MAP_WORDS(nblocks) / 2;
+    t->blksize = blksize;
+    t->nblocks = nblocks;
+    t->used = 0;
+    t->peak = 0;
+    t->flmap = 0;
+    for (i = 0; i < MEM_TLSF_FL_COUNT; i++) {
+        t->slmap[i] = 0;
+        t->runs[i] = 0;
+        for (j = 0; j < MEM_TLSF_SL_COUNT; j++) {
+            t->head[i][j] = MEM_TLSF_NIL;
+            t->maxi[i][j] = MEM_TLSF_NIL;
+            t->maxn[i][j] = 0;
+        }
+    }
+    for (i = 0; i < MEM_TLSF_MAP_WORDS(nblocks); i++) map[i] = 0;
+    mem_tlsf_insert(t, 0, nblocks);
+}
+
+/**
+ * @brief   分配 nmemb 个连续块
+ * @note    取用空闲段的前部, 剩余部分重新挂回链表; 被取走部分中的段头/尾标记清零,
+ *          保证从未用过的内存分配出去时仍为0 (与原线性扫描实现行为一致)
+ * @retval  首块号, MEM_TLSF_NONE表示失败
+ */
+uint32_t mem_tlsf_alloc(mem_tlsf_t *t, uint32_t nmemb)
+{
+    uint32_t index, total;
+    mem_tlsf_free_t *hdr;
+
+    if (nmemb == 0 || nmemb > t->nblocks - t->used) return MEM_TLSF_NONE;
+    index = mem_tlsf_find(t, nmemb);
+    if (index == MEM_TLSF_NIL) return MEM_TLSF_NONE;
+
+    mem_tlsf_remove(t, index);
+    hdr = mem_tlsf_hdr(t, index);
+    total = hdr->nmemb;
+    hdr->nmemb = 0;
+    hdr->prev = 0;
+    hdr->next = 0;
+    if (total > nmemb) mem_tlsf_insert(t, index + nmemb, total - nmemb);
+    else *mem_tlsf_ftr(t, index + total - 1) = 0;
+
+    mem_tlsf_bits(t->usedmap, index, nmemb, 1);
+    mem_tlsf_bits(t->endmap, index + nmemb - 1, 1, 1);
+    t->used += nmemb;
+    if (t->used > t->peak) t->peak = t->used;
+    return index;
+}
+
+/**
+ * @brief   释放以 index 开头的已分配段, 并与前后相邻空闲段合并
+ * @retval  释放的块数, 0表示 index 不是已分配段的首块
+ */
+uint32_t mem_tlsf_free(mem_tlsf_t *t, uint32_t index)
+{
+    uint32_t nmemb, start, end, n;
+    mem_tlsf_free_t *hdr;
+
+    nmemb = mem_tlsf_size(t, index);
+    if (nmemb == 0) return 0;
+    mem_tlsf_bits(t->usedmap, index, nmemb, 0);
+    mem_tlsf_bits(t->endmap, index + nmemb - 1, 1, 0);
+    t->used -= nmemb;
+
+    start = index;
+    end = index + nmemb;
+    if (start > 0 && mem_tlsf_is_free(t, start - 1)) {                     /* 与前一空闲段合并 */
+        n = *mem_tlsf_ftr(t, start - 1);
+        *mem_tlsf_ftr(t, start - 1) = 0;
+        start -= n;
+        mem_tlsf_remove(t, start);
+    }
+    if (end < t->nblocks && mem_tlsf_is_free(t, end)) {                     /* 与后一空闲段合并 */
+        hdr = mem_tlsf_hdr(t, end);
+        mem_tlsf_remove(t, end);
+        n = hdr->nmemb;
+        hdr->nmemb = 0;
+        hdr->prev = 0;
+        hdr->next = 0;
+        end += n;
+    }
+    mem_tlsf_insert(t, start, end - start);
+    return nmemb;
+}
+
+/**
+ * @brief   清零 [index, index + n) 中的空闲块, 保留空闲段头和尾标记
+ * @note    用于延迟初始化的内存池在后台逐步清零; 已分配块不动
+ */
+void mem_tlsf_scrub(mem_tlsf_t *t, uint32_t index, uint32_t n)
+{
+    uint32_t i, j, from, to;
+    uint32_t *p;
+
+    if (index + n > t->nblocks) n = t->nblocks - index;
+    for (i = index; i < index + n; i++) {
+        if (!mem_tlsf_is_free(t, i)) continue;
+        from = 0;
+        to = t->blksize;
+        if (i == 0 || !mem_tlsf_is_free(t, i - 1)) from = sizeof(mem_tlsf_free_t);
+        if (i == t->nblocks - 1 || !mem_tlsf_is_free(t, i + 1)) to -= sizeof(uint32_t);
+        p = (uint32_t *)(t->base + i * t->blksize);
+        for (j = from / 4; j < to / 4; j++) p[j] = 0;
+    }
+}
+
+/**
+ * @brief   最大空闲段的块数
+ * @note    最高非空级别由两级位图直接得到, 取该级别链表维护的最大段, O(1)
+ * @retval  块数, 0表示没有空闲块
+ */
+uint32_t mem_tlsf_largest(mem_tlsf_t *t)
+{
+    uint32_t fl, sl;
+
+    if (!t->flmap) return 0;
+    fl = 31 - MEM_CLZ(t->flmap);
+    sl = 31 - MEM_CLZ(t->slmap[fl]);
+    return t->maxn[fl][sl];
+}
+
+/**
+ * @brief   原地调整已分配段的大小
+ * @note    缩小: 尾部多余的块作为一个段释放 (与后面空闲段合并);
+ *          扩大: 仅当紧随其后的空闲段足够大时, 从其前部取用所需块
+ * @retval  1: 成功 (段首块号不变); 0: 无法原地调整 或 index 不是已分配段的首块
+ */
+uint8_t mem_tlsf_resize(mem_tlsf_t *t, uint32_t index, uint32_t nmemb)
+{
+    uint32_t oldn, right, need, total;
+    mem_tlsf_free_t *hdr;
+
+    oldn = mem_tlsf_size(t, index);
+    if (oldn == 0 || nmemb == 0) return 0;
+    if (nmemb == oldn) return 1;
+
+    if (nmemb < oldn) {                                                     /* 缩小: 尾部拆成独立段后释放 */
+        mem_tlsf_bits(t->endmap, index + nmemb - 1, 1, 1);
+        mem_tlsf_free(t, index + nmemb);
+        return 1;
+    }
+
+    right = index + oldn;                                                   /* 扩大: 检查后一段 */
+    need = nmemb - oldn;
+    if (right >= t->nblocks || !mem_tlsf_is_free(t, right)) return 0;
+    hdr = mem_tlsf_hdr(t, right);
+    total = hdr->nmemb;
+    if (total < need) return 0;
+
+    mem_tlsf_remove(t, right);
+    hdr->nmemb = 0;
+    hdr->prev = 0;
+    hdr->next = 0;
+    if (total > need) mem_tlsf_insert(t, right + need, total - need);
+    else *mem_tlsf_ftr(t, right + total - 1) = 0;
+
+    mem_tlsf_bits(t->usedmap, right, need, 1);
+    mem_tlsf_bits(t->endmap, right - 1, 1, 0);
+    mem_tlsf_bits(t->endmap, index + nmemb - 1, 1, 1);
+    t->used += need;
+    if (t->used > t->peak) t->peak = t->used;
+    return 1;
+}
+
+/**
+ * @brief   已分配段的块数
+ * @note    index 必须是已占用块, 且前一块空闲或是另一段的段尾; 块数 = 到下一个段尾标记的距离,
+ *          按32位字扫描段尾位图
+ * @retval  块数, 0表示 index 不是已分配段的首块
+ */
+uint32_t mem_tlsf_size(mem_tlsf_t *t, uint32_t index)
+{
+    uint32_t w, bits, words;
+    if (index >= t->nblocks || !mem_tlsf_bit(t->usedmap, index)) return 0;
+    if (index > 0 && mem_tlsf_bit(t->usedmap, index - 1) && !mem_tlsf_bit(t->endmap, index - 1)) return 0;
+
+    words = MEM_TLSF_MAP_WORDS(t->nblocks) / 2;
+    w = index >> 5;
+    bits = t->endmap[w] & (0XFFFFFFFF << (index & 31));
+    while (!bits) {
+        if (++w >= words) return 0;
+        bits = t->endmap[w];
+    }
+    return (w << 5) + mem_tlsf_ctz(bits) - index + 1;
+}
+
+/**
+ * @brief   已分配段的块数 (不校验 index 是否为段首, 最多查 max 块)
+ * @note    只读取该段自身的占用位和段尾位, 段被持有期间这些位不会被其他任务改动,
+ *          因此可以不加锁调用 (用于每任务缓存的快速释放路径)
+ * @retval  块数, 0表示 index 未占用 或 段长超过 max
+ */
+uint32_t mem_tlsf_size_fast(mem_tlsf_t *t, uint32_t index, uint32_t max)
+{
+    uint32_t i;
+    if (index >= t->nblocks || !mem_tlsf_bit(t->usedmap, index)) return 0;
+    for (i = 0; i < max && index + i < t->nblocks; i++) {
+        if (mem_tlsf_bit(t->endmap, index + i)) return i + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ ****************************************************************************************************
+ * @file        mem_tlsf.h
+ * @brief       内存池分配引擎 (TLSF两级位图 + 分级空闲链表, 分配/释放时间有界)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 以"块"为单位管理一个内存池, 空闲段按块数分级挂在 FL x SL 个空闲链表上:
+ *   一级(FL): 块数的最高位位置, 用 __CLZ 一条指令求得
+ *   二级(SL): 最高位之后的 MEM_TLSF_SL_LOG2 位, 把每个一级区间再等分
+ * 两级均有位图, 查找合适空闲段只需两次 __CLZ, 与内存池大小无关.
+ * 上取整后的级别及以上都没有空闲段时, 再看请求本身所在级别链表的最大段 (每条链表在插入/摘除时维护
+ * 最大段的块数和块号), 够用就取它: 查找仍为 O(1), 只要有够用的空闲段分配就不会失败.
+ * 摘除链表的最大段时要重新求最大段, 遍历该链表 (块数 < 16 的级别宽度为1, 只看链表头; 更高级别中
+ * 遇到级别上限长度的段即停止, 且段数不超过 块总数 / 级别下限). 最大空闲段 (mem_tlsf_largest) 也是 O(1).
+ *
+ * 空闲段的链表指针和块数就存放在空闲内存本身 (段首块存头, 段尾块存尾标记).
+ * 状态表为两张位图, 每块各占1位:
+ *   占用位图: 1 = 块已分配
+ *   段尾位图: 1 = 块是某个已分配段的最后一块 (边界标记)
+ * 已分配段的块数由段尾位图按字扫描得出, 不再为每块保存16位计数.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEM_TLSF_H
+#define __MEM_TLSF_H
+
+#ifdef MEM_HOST_BUILD
+#include <stdint.h>                                                         /* 主机编译(test/下的基准测试) */
+#define MEM_CLZ(x)              ((x) ? (uint32_t)__builtin_clz(x) : 32)
+#else
+#include "../../core/system/system_hal.h"
+#define MEM_CLZ(x)              __CLZ(x)
+#endif
+
+/* 分级参数 */
+#define MEM_TLSF_SL_LOG2        3                                           /* 每个一级区间细分为 2^3 = 8 个二级区间 */
+#define MEM_TLSF_SL_COUNT       (1 << MEM_TLSF_SL_LOG2)
+#define MEM_TLSF_FL_COUNT       13                                          /* 支持的最大块数 < 2^(13 + 3 - 1) = 32768 */
+#define MEM_TLSF_MAX_BLOCKS     0xFFFE                                      /* 块号用16位保存 */
+
+#define MEM_TLSF_NIL            0xFFFF                                      /* 空链表 */
+#define MEM_TLSF_NONE           0XFFFFFFFF                                  /* 分配失败 */
+
+/* 状态表字数 (两张位图, 每张 nblocks 位) */
+#define MEM_TLSF_MAP_WORDS(n)   ((((n) + 31) / 32) * 2)
+
+/* 单个内存池的引擎控制块 */
+typedef struct
+{
+    uint8_t  *base;                                                         /* 内存池基地址 */
+    uint32_t *usedmap;                                                      /* 占用位图 */
+    uint32_t *endmap;                                                       /* 段尾位图 */
+    uint32_t blksize;                                                       /* 块大小 (>=16字节) */
+    uint32_t nblocks;                                                       /* 块总数 */
+    uint32_t used;                                                          /* 已分配块数 */
+    uint32_t peak;                                                          /* 历史最大已分配块数 */
+    uint32_t flmap;                                                         /* 一级位图 */
+    uint8_t  slmap[MEM_TLSF_FL_COUNT];                                      /* 二级位图 */
+    uint16_t head[MEM_TLSF_FL_COUNT][MEM_TLSF_SL_COUNT];                    /* 空闲链表头 (块号) */
+    uint16_t maxi[MEM_TLSF_FL_COUNT][MEM_TLSF_SL_COUNT];                    /* 各链表最大段的首块号 */
+    uint16_t maxn[MEM_TLSF_FL_COUNT][MEM_TLSF_SL_COUNT];                    /* 各链表最大段的块数, 0: 链表空 */
+    uint16_t runs[MEM_TLSF_FL_COUNT];                                       /* 各一级区间的空闲段个数 (碎片直方图) */
+} mem_tlsf_t;
+
+void mem_tlsf_init(mem_tlsf_t *t, uint8_t *base, uint32_t *map, uint32_t blksize, uint32_t nblocks);
+uint32_t mem_tlsf_alloc(mem_tlsf_t *t, uint32_t nmemb);
+uint32_t mem_tlsf_free(mem_tlsf_t *t, uint32_t index);
+uint32_t mem_tlsf_size(mem_tlsf_t *t, uint32_t index);
+uint32_t mem_tlsf_size_fast(mem_tlsf_t *t, uint32_t index, uint32_t max);
+uint8_t mem_tlsf_resize(mem_tlsf_t *t, uint32_t index, uint32_t nmemb);
+void mem_tlsf_scrub(mem_tlsf_t *t, uint32_t index, uint32_t n);
+uint32_t mem_tlsf_largest(mem_tlsf_t *t);
+
+#endif
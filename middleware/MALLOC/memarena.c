@@ -0,0 +1,133 @@
+/**
+ ****************************************************************************************************
+ * @file        memarena.c
+ * @brief       帧/临时内存区 (arena)
+ ****************************************************************************************************
+ */
+
+#include "./memarena.h"
+
+/**
+ * @brief       创建 arena
+ * @param       memx : 所属内存池
+ * @param       size : 数据区大小(字节)
+ * @retval      arena 句柄, NULL 表示参数错误或内存不足
+ * @note        控制块与数据区一起申请, 数据区起始地址按内存块(32字节)对齐
+ */
+mymem_arena_t *mymem_arena_create(uint8_t memx, uint32_t size)
+{
+    mymem_arena_t *arena;
+    uint32_t head = (sizeof(mymem_arena_t) + 31) & ~31U;
+
+    if (memx >= SRAMBANK || size == 0 || size > 0xFFFFFFFFU - head) return NULL;
+
+    arena = (mymem_arena_t *)mymalloc(memx, head + size);
+    if (arena == NULL) return NULL;
+
+    arena->base = (uint8_t *)arena + head;
+    arena->size = size;
+    arena->top = 0;
+    arena->peak = 0;
+    arena->fail = 0;
+    arena->memx = memx;
+    return arena;
+}
+
+/**
+ * @brief       删除 arena (其中的内存全部作废)
+ * @param       arena : arena 句柄
+ * @retval      无
+ */
+void mymem_arena_delete(mymem_arena_t *arena)
+{
+    if (arena == NULL) return;
+    myfree(arena->memx, arena);
+}
+
+/**
+ * @brief       从 arena 申请内存
+ * @param       arena : arena 句柄
+ * @param       size  : 字节数
+ * @param       align : 对齐字节数 (2的幂, 0 按4字节对齐, 最大32)
+ * @retval      内存地址, NULL 表示空间不足 (内容未初始化)
+ */
+void *mymem_arena_alloc(mymem_arena_t *arena, uint32_t size, uint32_t align)
+{
+    uint32_t offset;
+
+    if (align == 0) align = 4;
+    if ((align & (align - 1)) || align > 32) return NULL;
+
+    offset = (arena->top + align - 1) & ~(align - 1);
+    if (offset > arena->size || size > arena->size - offset) {
+        arena->fail++;
+        return NULL;
+    }
+
+    arena->top = offset + size;
+    if (arena->top > arena->peak) arena->peak = arena->top;
+    return arena->base + offset;
+}
+
+/**
+ * @brief       记录当前位置, 之后可用 mymem_arena_release 回退到此处
+ * @param       arena : arena 句柄
+ * @retval      回退标记
+ */
+mymem_arena_mark_t mymem_arena_mark(mymem_arena_t *arena)
+{
+    return arena->top;
+}
+
+/**
+ * @brief       回退到标记位置, 释放标记之后申请的全部内存
+ * @param       arena : arena 句柄
+ * @param       mark  : mymem_arena_mark 的返回值
+ * @retval      无
+ * @note        嵌套使用时应按与标记相反的顺序回退; 比当前位置还靠后的标记被忽略
+ */
+void mymem_arena_release(mymem_arena_t *arena, mymem_arena_mark_t mark)
+{
+    if (mark < arena->top) arena->top = mark;
+}
+
+/**
+ * @brief       清空 arena (帧结束时调用)
+ * @param       arena : arena 句柄
+ * @retval      无
+ */
+void mymem_arena_reset(mymem_arena_t *arena)
+{
+    arena->top = 0;
+}
+
+/**
+ * @brief       获取当前使用量
+ * @param       arena : arena 句柄
+ * @retval      已用字节数 (含对齐填充)
+ */
+uint32_t mymem_arena_used(mymem_arena_t *arena)
+{
+    return arena->top;
+}
+
+/**
+ * @brief       获取历史最高使用量
+ * @param       arena : arena 句柄
+ * @retval      最高使用字节数
+ */
+uint32_t mymem_arena_peak(mymem_arena_t *arena)
+{
+    return arena->peak;
+}
+
+/**
+ * @brief       清除最高使用量和失败次数 (重新开始统计)
+ * @param       arena : arena 句柄
+ * @retval      无
+ */
+void mymem_arena_peak_clear(mymem_arena_t *arena)
+{
+    arena->peak = arena->top;
+    arena->fail = 0;
+}
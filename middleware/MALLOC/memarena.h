@@ -0,0 +1,47 @@
+/**
+ ****************************************************************************************************
+ * @file        memarena.h
+ * @brief       帧/临时内存区 (arena): 顺序分配, 一次性整体释放
+ ****************************************************************************************************
+ * @attention
+ *
+ * 适用于 LCD重绘、报文解析 等 "一帧内大量申请, 帧结束时全部作废" 的场合:
+ *   创建时从指定内存池申请一整块, 之后的申请只是把顶部指针向后移动 (按要求对齐),
+ *   不单独释放; 帧结束调用 mymem_arena_reset 一次性清空.
+ *   mymem_arena_mark / mymem_arena_release 可嵌套使用, 只回退到某个位置.
+ * 统计: 历史最高使用量 peak 和 申请失败次数, 用于确定 arena 大小.
+ *
+ * 注意: arena 不加锁, 只能由一个任务使用 (通常每个任务/每个处理流程各建一个).
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEMARENA_H
+#define __MEMARENA_H
+
+#include "./malloc.h"
+
+/* arena 控制块 */
+typedef struct
+{
+    uint8_t *base;                      /* 数据区起始 */
+    uint32_t size;                      /* 数据区大小 */
+    uint32_t top;                       /* 当前使用量 (下一次分配的偏移) */
+    uint32_t peak;                      /* 历史最高使用量 */
+    uint32_t fail;                      /* 申请失败次数 */
+    uint8_t memx;                       /* 所在内存池 */
+} mymem_arena_t;
+
+typedef uint32_t mymem_arena_mark_t;    /* 回退标记 */
+
+mymem_arena_t *mymem_arena_create(uint8_t memx, uint32_t size);
+void mymem_arena_delete(mymem_arena_t *arena);
+void *mymem_arena_alloc(mymem_arena_t *arena, uint32_t size, uint32_t align);
+mymem_arena_mark_t mymem_arena_mark(mymem_arena_t *arena);
+void mymem_arena_release(mymem_arena_t *arena, mymem_arena_mark_t mark);
+void mymem_arena_reset(mymem_arena_t *arena);
+uint32_t mymem_arena_used(mymem_arena_t *arena);
+uint32_t mymem_arena_peak(mymem_arena_t *arena);
+void mymem_arena_peak_clear(mymem_arena_t *arena);
+
+#endif
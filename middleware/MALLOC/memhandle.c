@@ -0,0 +1,410 @@
+/**
+ ****************************************************************************************************
+ * @file        memhandle.c
+ * @brief       可移动句柄内存区
+ ****************************************************************************************************
+ * @attention
+ *
+ * 整理状态: cur 之前的部分已处理完, [dst, cur) 是一个空洞 (写有空闲块头, 区域始终可按块头遍历);
+ * 搬移一个块时若超过本次 budget 则分段完成. 分段搬移途中 [dst, mv_src + mv_len) 不能按块头遍历,
+ * 遍历 (申请/最大空闲) 走到 dst 时把这一段整体当作已用块跳过 (mem_h_next), 不必先做完搬移.
+ * 申请时合并空闲块、占用空洞, 会相应调整 cur/dst (mem_h_merged); 释放只把块标为空闲, 由后续整理或申请合并.
+ * 所有接口持区域互斥锁 (不屏蔽中断).
+ *
+ ****************************************************************************************************
+ */
+
+#include "./memhandle.h"
+#include "./mem_lock.h"
+
+/* 块头 */
+typedef struct
+{
+    uint32_t size;                      /* 块长度, 含块头, 8的倍数 */
+    uint16_t handle;                    /* 所属句柄, 0 表示空闲块 */
+    uint16_t lock;                      /* 钉住计数 */
+} mem_hblk_t;
+
+#define MEM_H_HDR               sizeof(mem_hblk_t)
+#define MEM_H_HOP_COST          16                                          /* 跳过一个块折算的拷贝字节数 */
+
+static mem_hblk_t *mem_h_blk(mymem_hheap_t *hp, uint32_t off)
+{
+    return (mem_hblk_t *)(hp->base + off);
+}
+
+/**
+ * @brief   off 处的块是否空闲 (分段搬移中的那一段不算)
+ */
+static uint8_t mem_h_is_free(mymem_hheap_t *hp, uint32_t off)
+{
+    if (hp->mv_src != MEM_H_NONE && off == hp->dst) return 0;
+    return mem_h_blk(hp, off)->handle == 0;
+}
+
+/**
+ * @brief   off 处的块之后的下一个块 (分段搬移中的那一段整体跳过)
+ */
+static uint32_t mem_h_next(mymem_hheap_t *hp, uint32_t off)
+{
+    if (hp->mv_src != MEM_H_NONE && off == hp->dst) return hp->mv_src + hp->mv_len;
+    return off + mem_h_blk(hp, off)->size;
+}
+
+/**
+ * @brief   在 off 处写一个长度为 size 的空闲块
+ */
+static void mem_h_set_free(mymem_hheap_t *hp, uint32_t off, uint32_t size)
+{
+    mem_hblk_t *b = mem_h_blk(hp, off);
+    b->size = size;
+    b->handle = 0;
+    b->lock = 0;
+}
+
+/**
+ * @brief   向低地址拷贝 (目的在源之前, 允许重叠), 按字进行
+ */
+static void mem_h_copy_down(uint8_t *des, const uint8_t *src, uint32_t n)
+{
+    uint32_t *d = (uint32_t *)des;
+    const uint32_t *s = (const uint32_t *)src;
+    n >>= 2;
+    while (n >= 4) {
+        d[0] = s[0];
+        d[1] = s[1];
+        d[2] = s[2];
+        d[3] = s[3];
+        d += 4;
+        s += 4;
+        n -= 4;
+    }
+    while (n--) *d++ = *s++;
+}
+
+/**
+ * @brief   申请时把 [off, next) 的空闲块合并成一块后, 保持整理状态一致
+ * @note    合并区间含空洞起点: 空洞扩大为整个合并块; 合并区间跨过扫描位置: 扫描位置退回到合并块起点
+ */
+static void mem_h_merged(mymem_hheap_t *hp, uint32_t off, uint32_t next)
+{
+    if (hp->dst != MEM_H_NONE) {
+        if (off <= hp->dst && hp->dst < next) {
+            hp->dst = off;
+            hp->cur = next;
+        }
+    } else if (off < hp->cur && hp->cur < next) {
+        hp->cur = off;
+    }
+}
+
+/**
+ * @brief   一个块搬移完成: 更新句柄表, 空洞跟在块后面
+ */
+static void mem_h_move_done(mymem_hheap_t *hp)
+{
+    mem_hblk_t *b = mem_h_blk(hp, hp->dst);
+
+    hp->tab[b->handle - 1] = (uint8_t *)b;
+    hp->cur = hp->mv_src + hp->mv_len;
+    hp->dst += hp->mv_len;
+    mem_h_set_free(hp, hp->dst, hp->cur - hp->dst);
+    hp->mv_src = MEM_H_NONE;
+    hp->moved = 1;
+    hp->moves++;
+    hp->moved_bytes += hp->mv_len;
+}
+
+/**
+ * @brief   做完分段搬移的剩余部分 (钉住正在搬移的块时)
+ */
+static void mem_h_finish(mymem_hheap_t *hp)
+{
+    mem_h_copy_down(hp->base + hp->dst + hp->mv_done, hp->base + hp->mv_src + hp->mv_done, hp->mv_len - hp->mv_done);
+    mem_h_move_done(hp);
+}
+
+/**
+ * @brief   放弃分段搬移 (正在搬移的块被释放): 空洞连同原块成为一个空闲块
+ */
+static void mem_h_move_abort(mymem_hheap_t *hp)
+{
+    hp->cur = hp->mv_src + hp->mv_len;
+    mem_h_set_free(hp, hp->dst, hp->cur - hp->dst);
+    hp->mv_src = MEM_H_NONE;
+}
+
+/**
+ * @brief       创建可移动内存区
+ * @param       memx     : 所属内存池
+ * @param       size     : 区域大小(字节)
+ * @param       nhandles : 最多同时存在的句柄数
+ * @retval      控制块, NULL 表示参数错误或内存不足
+ */
+mymem_hheap_t *mymem_hheap_create(uint8_t memx, uint32_t size, uint16_t nhandles)
+{
+    mymem_hheap_t *hp;
+    uint32_t head;
+
+    if (memx >= SRAMBANK || nhandles == 0 || nhandles == 0xFFFF) return NULL;
+    size &= ~7U;
+    head = (sizeof(mymem_hheap_t) + nhandles * sizeof(uint8_t *) + 31) & ~31U;
+    if (size < 2 * MEM_H_HDR || size > 0XFFFFFFFF - head) return NULL;
+
+    hp = (mymem_hheap_t *)mymalloc(memx, head + size);                     /* 内容未初始化 (可能是别人用过的) */
+    if (hp == NULL) return NULL;
+    mymemset(hp, 0, head);                                                  /* 控制块和句柄表 */
+    if (!MEM_MUTEX_INIT(hp->mutex)) {
+        myfree(memx, hp);
+        return NULL;
+    }
+
+    hp->base = (uint8_t *)hp + head;
+    hp->size = size;
+    hp->free = size;
+    hp->tab = (uint8_t **)(hp + 1);
+    hp->nhandles = nhandles;
+    hp->hnext = 0;
+    hp->memx = memx;
+    hp->compact = 1;
+    hp->moved = 0;
+    hp->cur = 0;
+    hp->dst = MEM_H_NONE;
+    hp->mv_src = MEM_H_NONE;
+    hp->mv_len = 0;
+    hp->mv_done = 0;
+    hp->moves = 0;
+    hp->moved_bytes = 0;
+    mem_h_set_free(hp, 0, size);
+    return hp;
+}
+
+/**
+ * @brief       删除可移动内存区 (其中的块全部作废)
+ */
+void mymem_hheap_delete(mymem_hheap_t *hp)
+{
+    if (hp == NULL) return;
+    MEM_MUTEX_DELETE(hp->mutex);
+    myfree(hp->memx, hp);
+}
+
+/**
+ * @brief       申请可移动内存块
+ * @param       hp   : 可移动内存区
+ * @param       size : 字节数
+ * @retval      句柄, 0 表示失败 (句柄用完 或 没有足够大的连续空闲; 后者可先整理再试)
+ * @note        首次适配, 扫描时顺便合并相邻空闲块; 内容未初始化
+ */
+mymem_handle_t mymem_halloc(mymem_hheap_t *hp, uint32_t size)
+{
+    uint32_t need, off, next, h;
+    mem_hblk_t *b;
+
+    if (size == 0 || size > hp->size) return 0;
+    need = (size + MEM_H_HDR + 7) & ~7U;
+
+    MEM_MUTEX_TAKE(hp->mutex);
+    for (h = hp->hnext; h < hp->nhandles && hp->tab[h]; h++);
+    hp->hnext = h;
+    if (h == hp->nhandles || need > hp->free) {
+        MEM_MUTEX_GIVE(hp->mutex);
+        return 0;
+    }
+
+    for (off = 0; off < hp->size; off = mem_h_next(hp, off)) {
+        if (!mem_h_is_free(hp, off)) continue;
+        b = mem_h_blk(hp, off);
+        for (next = off + b->size; next < hp->size && mem_h_is_free(hp, next); next += mem_h_blk(hp, next)->size);
+        b->size = next - off;                                               /* 合并后面的空闲块 */
+        mem_h_merged(hp, off, next);
+        if (b->size < need) continue;
+
+        if (b->size - need >= 2 * MEM_H_HDR) mem_h_set_free(hp, off + need, b->size - need);
+        else need = b->size;
+        b->size = need;
+        b->handle = h + 1;
+        b->lock = 0;
+        hp->tab[h] = (uint8_t *)b;
+        hp->free -= need;
+        if (off == hp->dst) {                                               /* 占用了整理中的空洞: 从新块之后继续 */
+            hp->dst = MEM_H_NONE;
+            hp->cur = off + need;
+        }
+        hp->hnext = h + 1;
+        hp->compact = 0;
+        hp->moved = 1;
+        MEM_MUTEX_GIVE(hp->mutex);
+        return h + 1;
+    }
+    MEM_MUTEX_GIVE(hp->mutex);
+    return 0;
+}
+
+/**
+ * @brief       释放可移动内存块 (块被钉住时也释放; 正在分段搬移时放弃搬移)
+ */
+void mymem_hfree(mymem_hheap_t *hp, mymem_handle_t h)
+{
+    mem_hblk_t *b;
+
+    if (h == 0 || h > hp->nhandles) return;
+    MEM_MUTEX_TAKE(hp->mutex);
+    b = (mem_hblk_t *)hp->tab[h - 1];
+    if (b) {
+        hp->tab[h - 1] = NULL;
+        if (h - 1 < hp->hnext) hp->hnext = h - 1;
+        if (hp->mv_src != MEM_H_NONE && (uint8_t *)b == hp->base + hp->mv_src) {
+            hp->free += hp->mv_len;                                         /* 原块头可能已被拷贝覆盖 */
+            mem_h_move_abort(hp);
+        } else {
+            hp->free += b->size;
+            b->handle = 0;
+            b->lock = 0;
+        }
+        hp->compact = 0;
+        hp->moved = 1;
+    }
+    MEM_MUTEX_GIVE(hp->mutex);
+}
+
+/**
+ * @brief       钉住内存块并取得地址 (可嵌套)
+ * @retval      数据地址, NULL 表示句柄无效; 在对应的 mymem_hunlock 之前地址保持有效
+ * @note        若该块正被分段搬移, 先把剩余部分拷贝完 (持区域互斥锁, 不屏蔽中断)
+ */
+void *mymem_hlock(mymem_hheap_t *hp, mymem_handle_t h)
+{
+    mem_hblk_t *b;
+
+    if (h == 0 || h > hp->nhandles) return NULL;
+    MEM_MUTEX_TAKE(hp->mutex);
+    b = (mem_hblk_t *)hp->tab[h - 1];
+    if (b && hp->mv_src != MEM_H_NONE && (uint8_t *)b == hp->base + hp->mv_src) {
+        mem_h_finish(hp);
+        b = (mem_hblk_t *)hp->tab[h - 1];
+    }
+    if (b) b->lock++;
+    MEM_MUTEX_GIVE(hp->mutex);
+    return b ? (uint8_t *)b + MEM_H_HDR : NULL;
+}
+
+/**
+ * @brief       解除钉住, 之后该块可能被整理搬移
+ */
+void mymem_hunlock(mymem_hheap_t *hp, mymem_handle_t h)
+{
+    mem_hblk_t *b;
+
+    if (h == 0 || h > hp->nhandles) return;
+    MEM_MUTEX_TAKE(hp->mutex);
+    b = (mem_hblk_t *)hp->tab[h - 1];
+    if (b && b->lock) b->lock--;
+    MEM_MUTEX_GIVE(hp->mutex);
+}
+
+/**
+ * @brief       增量整理一步
+ * @param       hp     : 可移动内存区
+ * @param       budget : 本次最多拷贝的字节数 (跳过一个块按 MEM_H_HOP_COST 字节计), 决定持互斥锁的最长时间
+ * @retval      1: 区域已紧凑 (上一整轮没有可搬移的块); 0: 还需继续
+ */
+uint8_t mymem_hcompact(mymem_hheap_t *hp, uint32_t budget)
+{
+    mem_hblk_t *b;
+    uint32_t n;
+    uint8_t done;
+
+    MEM_MUTEX_TAKE(hp->mutex);
+    while (budget && !hp->compact) {
+        if (hp->mv_src != MEM_H_NONE) {                                     /* 继续分段搬移 */
+            n = hp->mv_len - hp->mv_done;
+            if (n > budget) n = budget & ~3U;
+            if (n == 0) break;
+            mem_h_copy_down(hp->base + hp->dst + hp->mv_done, hp->base + hp->mv_src + hp->mv_done, n);
+            hp->mv_done += n;
+            budget -= n;
+            if (hp->mv_done == hp->mv_len) mem_h_move_done(hp);
+            continue;
+        }
+
+        if (hp->cur >= hp->size) {                                          /* 一轮结束 */
+            hp->compact = !hp->moved;
+            hp->cur = 0;
+            hp->dst = MEM_H_NONE;
+            hp->moved = 0;
+            continue;
+        }
+
+        b = mem_h_blk(hp, hp->cur);
+        budget = budget > MEM_H_HOP_COST ? budget - MEM_H_HOP_COST : 0;
+        if (b->handle == 0) {                                               /* 空闲块并入空洞 */
+            if (hp->dst == MEM_H_NONE) hp->dst = hp->cur;
+            hp->cur += b->size;
+            mem_h_set_free(hp, hp->dst, hp->cur - hp->dst);
+        } else if (b->lock || hp->dst == MEM_H_NONE) {                      /* 钉住的块 或 前面没有空洞: 跳过 */
+            hp->dst = MEM_H_NONE;
+            hp->cur += b->size;
+        } else {                                                            /* 向下滑入空洞 */
+            hp->mv_src = hp->cur;
+            hp->mv_len = b->size;
+            hp->mv_done = 0;
+        }
+    }
+    done = hp->compact;
+    MEM_MUTEX_GIVE(hp->mutex);
+    return done;
+}
+
+/**
+ * @brief       最大连续空闲字节数 (可申请的最大块 = 返回值 - 8)
+ * @note        遍历整个区域 (持区域互斥锁, 不屏蔽中断), 用于监视, 不要频繁调用
+ */
+uint32_t mymem_hheap_largest(mymem_hheap_t *hp)
+{
+    uint32_t off, next, run = 0, max = 0;
+
+    MEM_MUTEX_TAKE(hp->mutex);
+    for (off = 0; off < hp->size; off = next) {
+        next = mem_h_next(hp, off);
+        run = mem_h_is_free(hp, off) ? run + (next - off) : 0;
+        if (run > max) max = run;
+    }
+    MEM_MUTEX_GIVE(hp->mutex);
+    return max;
+}
+
+#ifndef MEM_HOST_BUILD
+typedef struct
+{
+    mymem_hheap_t *hp;
+    uint32_t budget;
+} mem_h_task_arg_t;
+
+/**
+ * @brief   空闲时整理任务: 每步最多拷贝 budget 字节, 步与步之间让出CPU; 紧凑后每100ms检查一次
+ */
+static void mem_h_compact_task(void *pvParameters)
+{
+    mem_h_task_arg_t *arg = (mem_h_task_arg_t *)pvParameters;
+
+    while (1) {
+        if (mymem_hcompact(arg->hp, arg->budget)) vTaskDelay(100);
+        else taskYIELD();
+    }
+}
+
+/**
+ * @brief       为可移动内存区创建空闲优先级的整理任务 (调度器启动前后均可调用)
+ * @param       hp     : 可移动内存区
+ * @param       budget : 每步最多拷贝字节数, 如 512 (每步持区域互斥锁约数微秒)
+ */
+void mymem_hcompact_start(mymem_hheap_t *hp, uint32_t budget)
+{
+    mem_h_task_arg_t *arg = (mem_h_task_arg_t *)mymalloc(SRAMIN, sizeof(mem_h_task_arg_t));
+    if (arg == NULL) return;
+    arg->hp = hp;
+    arg->budget = budget;
+    xTaskCreate(mem_h_compact_task, "mem_compact", configMINIMAL_STACK_SIZE, arg, tskIDLE_PRIORITY, NULL);
+}
+#endif
@@ -0,0 +1,67 @@
+/**
+ ****************************************************************************************************
+ * @file        memhandle.h
+ * @brief       可移动句柄内存区: 通过句柄访问的内存块可在空闲时被搬移整理, 消除长期运行产生的碎片
+ ****************************************************************************************************
+ * @attention
+ *
+ * 长期运行后 mymalloc 的内存池(尤其SRAMEX)会逐渐碎片化, 总空闲足够却申请不到大块 (如图像缓冲).
+ * 本模块从指定内存池申请一整块区域自行管理, 其中的内存块只通过句柄引用:
+ *   mymem_halloc 得到句柄; 访问前 mymem_hlock 取得地址并钉住该块, 用完 mymem_hunlock;
+ *   未钉住的块随时可能被整理程序搬到更低地址 (之前取得的地址作废).
+ * 整理 (mymem_hcompact) 从区域起始向后扫描, 把未钉住的块依次向下滑动填补空洞, 钉住的块原地不动;
+ * 每调用一次最多拷贝 budget 字节, 可在空闲任务中反复调用 (mymem_hcompact_start 创建空闲优先级任务).
+ *
+ * 每个区域一把互斥锁 (mem_lock.h 的 MEM_MUTEX, 不屏蔽中断), 所有接口只能在任务中 (或调度器启动前) 调用.
+ * 整理每步只持锁 budget 字节拷贝的时间; 申请 (首次适配) 和 mymem_hheap_largest 遍历整个区域, 也只是持互斥锁.
+ * 分段搬移中的块: 钉住它的 mymem_hlock 要等剩余部分拷贝完 (持互斥锁, 最多一个块长); 释放它则直接放弃这次搬移;
+ * 其他块的 钉住/释放 不受影响.
+ *
+ * 块布局: 8字节块头 + 数据, 数据8字节对齐; 区域内的块 (含空闲块) 首尾相接铺满整个区域.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEMHANDLE_H
+#define __MEMHANDLE_H
+
+#include "./malloc.h"
+#include "./mem_lock.h"
+
+typedef uint16_t mymem_handle_t;        /* 句柄, 0 表示无效 */
+
+/* 可移动内存区控制块 */
+typedef struct
+{
+    uint8_t *base;                      /* 区域起始 */
+    uint32_t size;                      /* 区域大小 (8的倍数) */
+    uint32_t free;                      /* 空闲字节数 (含空闲块块头) */
+    uint8_t **tab;                      /* 句柄表: tab[h - 1] 为块头地址, NULL 表示句柄未使用 */
+    uint16_t nhandles;                  /* 句柄表大小 */
+    uint16_t hnext;                     /* 找空闲句柄的起点 (之前的句柄都在用) */
+    uint8_t memx;                       /* 所在内存池 */
+    uint8_t compact;                    /* 1: 上一轮整理没有搬动任何块 (已紧凑) */
+    uint8_t moved;                      /* 本轮整理期间布局是否变过 (搬移/申请/释放) */
+    uint32_t cur;                       /* 整理扫描位置 (偏移) */
+    uint32_t dst;                       /* 当前空洞起始 (偏移), MEM_H_NONE 表示没有空洞 */
+    uint32_t mv_src;                    /* 正在分段搬移的块 (偏移), MEM_H_NONE 表示没有 */
+    uint32_t mv_len;                    /* 正在搬移的块长度 */
+    uint32_t mv_done;                   /* 已搬移字节数 */
+    uint32_t moves;                     /* 累计搬移块数 */
+    uint32_t moved_bytes;               /* 累计搬移字节数 */
+    MEM_MUTEX_T mutex;                  /* 区域互斥锁 */
+} mymem_hheap_t;
+
+#define MEM_H_NONE              0XFFFFFFFF
+
+mymem_hheap_t *mymem_hheap_create(uint8_t memx, uint32_t size, uint16_t nhandles);
+void mymem_hheap_delete(mymem_hheap_t *hp);
+mymem_handle_t mymem_halloc(mymem_hheap_t *hp, uint32_t size);
+void mymem_hfree(mymem_hheap_t *hp, mymem_handle_t h);
+void *mymem_hlock(mymem_hheap_t *hp, mymem_handle_t h);
+void mymem_hunlock(mymem_hheap_t *hp, mymem_handle_t h);
+uint8_t mymem_hcompact(mymem_hheap_t *hp, uint32_t budget);
+uint32_t mymem_hheap_largest(mymem_hheap_t *hp);
+void mymem_hcompact_start(mymem_hheap_t *hp, uint32_t budget);
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ ****************************************************************************************************
+ * @file        mempool.c
+ * @brief       定长对象池
+ ****************************************************************************************************
+ */
+
+#include "./mempool.h"
+#include "./mem_lock.h"
+
+/**
+ * @brief       创建对象池
+ * @param       memx     : 所属内存池
+ * @param       obj_size : 对象大小(字节)
+ * @param       count    : 对象个数
+ * @retval      对象池句柄, NULL 表示参数错误或内存不足
+ * @note        控制块和对象一起申请, 对象区紧跟控制块 (控制块大小为4的倍数, 对象4字节对齐)
+ */
+mymem_pool_t *mymem_pool_create(uint8_t memx, uint32_t obj_size, uint32_t count)
+{
+    mymem_pool_t *pool;
+    uint8_t *obj;
+    uint32_t i;
+
+    if (memx >= SRAMBANK || obj_size == 0 || count == 0) return NULL;
+
+    obj_size = (obj_size + 3) & ~3U;                                        /* 按4字节取整, 至少能放下链表指针 */
+    if (obj_size < sizeof(void *)) obj_size = sizeof(void *);
+    if (count > (0xFFFFFFFFU - sizeof(mymem_pool_t)) / obj_size) return NULL;   /* 防止溢出 */
+
+    pool = (mymem_pool_t *)mymalloc(memx, sizeof(mymem_pool_t) + obj_size * count);
+    if (pool == NULL) return NULL;
+
+    pool->base = (uint8_t *)(pool + 1);
+    pool->end = pool->base + obj_size * count;
+    pool->obj_size = obj_size;
+    pool->count = count;
+    pool->free_cnt = count;
+    pool->min_free = count;
+    pool->memx = memx;
+
+    obj = pool->base;                                                       /* 按地址顺序串起空闲链表 */
+    for (i = 0; i < count - 1; i++, obj += obj_size) *(void **)obj = obj + obj_size;
+    *(void **)obj = NULL;
+    pool->free = pool->base;
+    return pool;
+}
+
+/**
+ * @brief       删除对象池 (池中对象全部作废)
+ * @param       pool : 对象池句柄
+ * @retval      无
+ */
+void mymem_pool_delete(mymem_pool_t *pool)
+{
+    if (pool == NULL) return;
+    myfree(pool->memx, pool);
+}
+
+/**
+ * @brief       从对象池取一个对象 (任务/中断均可调用)
+ * @param       pool : 对象池句柄
+ * @retval      对象地址, NULL 表示池已空 (对象内容未初始化)
+ */
+void *mymem_pool_alloc(mymem_pool_t *pool)
+{
+    void *obj;
+    uint32_t s;
+
+    s = MEM_LOCK(pool->memx);
+    obj = pool->free;
+    if (obj) {
+        pool->free = *(void **)obj;
+        if (--pool->free_cnt < pool->min_free) pool->min_free = pool->free_cnt;
+    }
+    MEM_UNLOCK(pool->memx, s);
+    return obj;
+}
+
+/**
+ * @brief       归还对象到对象池 (任务/中断均可调用)
+ * @param       pool : 对象池句柄
+ * @param       obj  : 对象地址
+ * @retval      0, 成功;  1, 地址不属于该池 或 不在对象边界上
+ * @note        不检查重复释放 (那样需要额外的状态位, 会失去O(1)的意义)
+ */
+uint8_t mymem_pool_free(mymem_pool_t *pool, void *obj)
+{
+    uint8_t *p = (uint8_t *)obj;
+    uint32_t s;
+
+    if (p < pool->base || p >= pool->end || (uint32_t)(p - pool->base) % pool->obj_size) return 1;
+
+    s = MEM_LOCK(pool->memx);
+    *(void **)obj = pool->free;
+    pool->free = obj;
+    pool->free_cnt++;
+    MEM_UNLOCK(pool->memx, s);
+    return 0;
+}
+
+/**
+ * @brief       获取对象池当前空闲对象数
+ * @param       pool : 对象池句柄
+ * @retval      空闲对象数
+ */
+uint32_t mymem_pool_free_count(mymem_pool_t *pool)
+{
+    return pool->free_cnt;
+}
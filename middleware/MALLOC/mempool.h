@@ -0,0 +1,40 @@
+/**
+ ****************************************************************************************************
+ * @file        mempool.h
+ * @brief       定长对象池 (消息、帧描述符、定时器等同尺寸对象)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 对象池在创建时从指定内存池(SRAMIN/SRAMCCM/SRAMEX)一次申请 控制块+全部对象,
+ * 空闲对象用侵入式单链表串起 (链表指针就存放在空闲对象自身的前4字节),
+ * 申请/释放都是一次链表头操作, O(1), 在任务和中断中都可以调用.
+ * 对象大小向上取整到4字节, 起始地址4字节对齐.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEMPOOL_H
+#define __MEMPOOL_H
+
+#include "./malloc.h"
+
+/* 对象池控制块 */
+typedef struct
+{
+    void *free;                         /* 空闲链表头 */
+    uint8_t *base;                      /* 第一个对象 */
+    uint8_t *end;                       /* 最后一个对象之后 */
+    uint32_t obj_size;                  /* 对象大小 (已按4字节取整) */
+    uint32_t count;                     /* 对象总数 */
+    uint32_t free_cnt;                  /* 当前空闲数 */
+    uint32_t min_free;                  /* 历史最少空闲数 (用于确定池大小) */
+    uint8_t memx;                       /* 所在内存池 */
+} mymem_pool_t;
+
+mymem_pool_t *mymem_pool_create(uint8_t memx, uint32_t obj_size, uint32_t count);
+void mymem_pool_delete(mymem_pool_t *pool);
+void *mymem_pool_alloc(mymem_pool_t *pool);
+uint8_t mymem_pool_free(mymem_pool_t *pool, void *obj);
+uint32_t mymem_pool_free_count(mymem_pool_t *pool);
+
+#endif
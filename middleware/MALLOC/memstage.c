@@ -0,0 +1,337 @@
+/**
+ ****************************************************************************************************
+ * @file        memstage.c
+ * @brief       分级内存搬运: 外扩SRAM <-> 内部SRAM/CCM 的 DMA 预取/写回, 以及双缓冲流式处理
+ ****************************************************************************************************
+ */
+
+#include "./memstage.h"
+#include "../../driver/DMA/dma.h"
+
+/* 队列锁: 板上抬高BASEPRI (任务和DMA中断都会操作队列), 主机测试为单线程 */
+#ifdef MEM_HOST_BUILD
+#define STAGE_LOCK()            0U
+#define STAGE_UNLOCK(s)         (void)(s)
+#else
+#include "FreeRTOS.h"
+#include "task.h"
+#define STAGE_LOCK()            portSET_INTERRUPT_MASK_FROM_ISR()
+#define STAGE_UNLOCK(s)         portCLEAR_INTERRUPT_MASK_FROM_ISR(s)
+#endif
+
+static mymem_xfer_t *volatile g_stage_tail;                                 /* 队尾, NULL: 队列空 */
+
+static void mymem_stage_kick(mymem_xfer_t *x, uint8_t isr);
+
+/**
+ * @brief       搬运能否交给DMA
+ * @note        长度足够、源/目的对2取模相同 (按半字或字传输), 且两端都不在CCM
+ */
+static uint8_t mymem_stage_dma_ok(const mymem_xfer_t *x)
+{
+    const uint8_t *d = (const uint8_t *)x->des;
+    const uint8_t *s = (const uint8_t *)x->src;
+
+    if (x->len < MEM_STAGE_DMA_MIN || (((uintptr_t)d ^ (uintptr_t)s) & 1)) return 0;
+    return dma_m2m_addr_ok(d) && dma_m2m_addr_ok(d + x->len - 1) && dma_m2m_addr_ok(s) && dma_m2m_addr_ok(s + x->len - 1);
+}
+
+/**
+ * @brief       队首搬运结束: 出队, 唤醒等待该搬运的任务, 返回下一个
+ */
+static mymem_xfer_t *mymem_stage_finish(mymem_xfer_t *x, uint8_t state)
+{
+    mymem_xfer_t *next;
+    void *waiter;
+    uint32_t s = STAGE_LOCK();
+
+    next = x->next;
+    x->next = NULL;
+    if (g_stage_tail == x) g_stage_tail = NULL;
+    x->state = state;
+    waiter = x->waiter;
+    x->waiter = NULL;
+    STAGE_UNLOCK(s);
+
+#ifndef MEM_HOST_BUILD
+    if (waiter) {
+        if (__get_IPSR()) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveIndexedFromISR((TaskHandle_t)waiter, DMA_M2M_NOTIFY_INDEX, &woken);
+            portYIELD_FROM_ISR(woken);
+        } else {
+            xTaskNotifyGiveIndexed((TaskHandle_t)waiter, DMA_M2M_NOTIFY_INDEX);
+        }
+    }
+#else
+    (void)waiter;
+#endif
+    return next;
+}
+
+/**
+ * @brief       DMA完成回调 (中断上下文): 启动队列中的下一个
+ */
+static void mymem_stage_cb(void *arg, uint8_t result)
+{
+    mymem_stage_kick(mymem_stage_finish((mymem_xfer_t *)arg, result == DMA_M2M_OK ? MYMEM_XFER_DONE : MYMEM_XFER_ERROR), 1);
+}
+
+/**
+ * @brief       启动队首的搬运
+ * @note        能用DMA的, 中间部分交给DMA, 启动成功后首尾不对齐的几个字节由CPU拷贝, 完成后在回调里启动下一个;
+ *              不能用DMA的 (或DMA启动失败) 在任务中由CPU直接完成, 接着处理下一个.
+ *              在完成中断里 (isr=1) 不做整块CPU拷贝, 该搬运结束为 MYMEM_XFER_ERROR, 由调用者处理
+ * @param       x   : 队首
+ * @param       isr : 1: 从DMA完成回调调用
+ */
+static void mymem_stage_kick(mymem_xfer_t *x, uint8_t isr)
+{
+    uint8_t *d;
+    const uint8_t *s;
+    uint32_t unit, head, body, lock;
+    uint8_t res;
+
+    while (x) {
+        d = (uint8_t *)x->des;
+        s = (const uint8_t *)x->src;
+
+        if (mymem_stage_dma_ok(x)) {
+            unit = (((uintptr_t)d ^ (uintptr_t)s) & 3) ? 2 : 4;
+            head = (unit - ((uintptr_t)d & (unit - 1))) & (unit - 1);
+            body = (x->len - head) & ~(unit - 1);
+            x->state = MYMEM_XFER_BUSY;
+
+            lock = STAGE_LOCK();                                            /* 首尾写完之前不进完成回调 */
+            res = dma_m2m_start(DMA_M2M_CH_STAGE, d + head, s + head, body, unit == 2 ? DMA_M2M_HALFWORD : DMA_M2M_WORD,
+                                mymem_stage_cb, x);
+            if (res == DMA_M2M_OK) {
+                mymemcpy(d, (void *)s, head);
+                mymemcpy(d + head + body, (void *)(s + head + body), x->len - head - body);
+            }
+            STAGE_UNLOCK(lock);
+            if (res == DMA_M2M_OK) return;
+        }
+
+        if (isr) {                                                          /* 中断里不做整块拷贝, 报告给等待者 */
+            x = mymem_stage_finish(x, MYMEM_XFER_ERROR);
+            continue;
+        }
+        mymemcpy(d, (void *)s, x->len);
+        x = mymem_stage_finish(x, MYMEM_XFER_DONE);
+    }
+}
+
+/**
+ * @brief       提交一次搬运 (排在已提交的搬运之后)
+ * @retval      0: 已提交; 1: 参数错误
+ */
+static uint8_t mymem_stage_submit(mymem_xfer_t *x, void *des, const void *src, uint32_t len)
+{
+    mymem_xfer_t *prev;
+    uint32_t s;
+
+    if (x == NULL || des == NULL || src == NULL) return 1;
+
+    x->des = des;
+    x->src = src;
+    x->len = len;
+    x->next = NULL;
+    x->waiter = NULL;
+
+    if (len == 0) {
+        x->state = MYMEM_XFER_DONE;
+        return 0;
+    }
+
+    if (!mymem_stage_dma_ok(x)) mymem_stage_sync();                        /* CPU拷贝在调用者中完成, 先等前面的搬运完成 */
+
+    s = STAGE_LOCK();
+    prev = g_stage_tail;
+    g_stage_tail = x;
+    x->state = prev ? MYMEM_XFER_QUEUED : MYMEM_XFER_BUSY;
+    if (prev) prev->next = x;
+    STAGE_UNLOCK(s);
+
+    if (prev == NULL) mymem_stage_kick(x, 0);
+    return 0;
+}
+
+/**
+ * @brief       预取: 外扩SRAM -> 内部RAM (异步)
+ * @param       x     : 搬运句柄, 完成前不能复用
+ * @param       local : 内部SRAM/CCM 缓冲区
+ * @param       ext   : 外扩SRAM中的源地址
+ * @param       len   : 字节数
+ * @retval      0: 已提交; 1: 参数错误
+ */
+uint8_t mymem_prefetch(mymem_xfer_t *x, void *local, const void *ext, uint32_t len)
+{
+    return mymem_stage_submit(x, local, ext, len);
+}
+
+/**
+ * @brief       写回: 内部RAM -> 外扩SRAM (异步)
+ * @param       x     : 搬运句柄, 完成前不能复用
+ * @param       ext   : 外扩SRAM中的目的地址
+ * @param       local : 内部SRAM/CCM 缓冲区, 完成前不能修改
+ * @param       len   : 字节数
+ * @retval      0: 已提交; 1: 参数错误
+ */
+uint8_t mymem_writeback(mymem_xfer_t *x, void *ext, const void *local, uint32_t len)
+{
+    return mymem_stage_submit(x, ext, local, len);
+}
+
+/**
+ * @brief       搬运是否已结束
+ * @retval      1: 已结束 (或未提交); 0: 排队中或传输中
+ */
+uint8_t mymem_xfer_done(mymem_xfer_t *x)
+{
+    return x->state != MYMEM_XFER_QUEUED && x->state != MYMEM_XFER_BUSY;
+}
+
+/**
+ * @brief       等待搬运结束 (调度器运行时阻塞, CPU让给其他任务)
+ * @note        等待的任务登记在搬运句柄里, 由该搬运结束时唤醒 (任务通知下标 DMA_M2M_NOTIFY_INDEX),
+ *              多个任务可以同时等待各自的搬运; 同一个句柄只能由一个任务等待
+ * @retval      0: 成功 (或未提交); 1: DMA传输错误, 或在完成中断里无法启动DMA (数据未搬运, 可重新提交)
+ */
+uint8_t mymem_xfer_wait(mymem_xfer_t *x)
+{
+#ifndef MEM_HOST_BUILD
+    uint32_t s;
+
+    if (__get_IPSR() == 0 && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        for (;;) {
+            s = STAGE_LOCK();
+            if (mymem_xfer_done(x)) {
+                STAGE_UNLOCK(s);
+                break;
+            }
+            x->waiter = xTaskGetCurrentTaskHandle();
+            STAGE_UNLOCK(s);
+            ulTaskNotifyTakeIndexed(DMA_M2M_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+        }
+        return x->state == MYMEM_XFER_ERROR;
+    }
+#endif
+
+    while (!mymem_xfer_done(x)) dma_m2m_wait(DMA_M2M_CH_STAGE);             /* 调度器启动前查询 (主机测试: 桩在此完成推迟的传输) */
+
+    return x->state == MYMEM_XFER_ERROR;
+}
+
+/**
+ * @brief       等待所有已提交的搬运结束
+ * @note        等待的是DMA通道 (dma_m2m_wait 支持多个等待者), 多个任务可以同时调用
+ * @param       无
+ * @retval      无
+ */
+void mymem_stage_sync(void)
+{
+    while (g_stage_tail) dma_m2m_wait(DMA_M2M_CH_STAGE);
+}
+
+/**
+ * @brief       打开双缓冲流, 并开始预取第一块
+ * @param       ext   : 外扩SRAM中的数组
+ * @param       total : 数组字节数
+ * @param       tile  : 每块字节数 (最后一块可能较短)
+ * @param       memx  : 两个缓冲区所在的内存池 (SRAMIN 走DMA; SRAMCCM 访问最快但搬运由CPU完成)
+ * @param       mode  : MYMEM_STREAM_RD / MYMEM_STREAM_WR / MYMEM_STREAM_RW
+ * @retval      流句柄, NULL 表示参数错误或内存不足
+ * @note        控制块从 SRAMIN 申请, 两个缓冲区共 2*tile 字节从 memx 申请
+ */
+mymem_stream_t *mymem_stream_open(void *ext, uint32_t total, uint32_t tile, uint8_t memx, uint8_t mode)
+{
+    mymem_stream_t *s;
+
+    if (ext == NULL || total == 0 || tile == 0 || memx >= SRAMBANK || (mode & MYMEM_STREAM_RW) == 0) return NULL;
+
+    s = (mymem_stream_t *)mymalloc(SRAMIN, sizeof(mymem_stream_t));
+    if (s == NULL) return NULL;
+
+    mymemset(s, 0, sizeof(mymem_stream_t));
+    s->buf[0] = (uint8_t *)mymalloc(memx, tile);
+    s->buf[1] = (uint8_t *)mymalloc(memx, tile);
+
+    if (s->buf[0] == NULL || s->buf[1] == NULL) {
+        myfree(memx, s->buf[0]);
+        myfree(memx, s->buf[1]);
+        myfree(SRAMIN, s);
+        return NULL;
+    }
+
+    s->ext = (uint8_t *)ext;
+    s->total = total;
+    s->tile = tile;
+    s->mode = mode;
+    s->memx = memx;
+
+    if (mode & MYMEM_STREAM_RD) mymem_prefetch(&s->in[0], s->buf[0], s->ext, total < tile ? total : tile);
+    return s;
+}
+
+/**
+ * @brief       取下一块
+ * @note        交出上一块 (WR模式提交写回), 等待本块预取完成, 再提交下一块的预取
+ *              (排在另一缓冲区的写回之后), 然后返回; 调用者处理本块时DMA在后台搬运.
+ *              本块的偏移和长度见 s->pos / s->len
+ * @param       s : 流句柄
+ * @retval      本块所在的内部缓冲区 (RD模式已装入数据), NULL 表示已处理完
+ */
+void *mymem_stream_next(mymem_stream_t *s)
+{
+    uint32_t npos;
+    uint8_t c;
+
+    if (s->pos >= s->total) return NULL;
+
+    if (s->len) {
+        if (s->mode & MYMEM_STREAM_WR) mymem_writeback(&s->out[s->cur], s->ext + s->pos, s->buf[s->cur], s->len);
+
+        s->len = 0;
+        s->pos += s->tile;
+        s->cur ^= 1;
+
+        if (s->pos >= s->total) return NULL;
+    }
+
+    c = s->cur;
+    s->len = (s->total - s->pos < s->tile) ? s->total - s->pos : s->tile;
+    s->err |= mymem_xfer_wait(&s->out[c]);                                  /* 该缓冲区两块之前的写回 */
+    s->err |= mymem_xfer_wait(&s->in[c]);                                   /* 本块的预取 */
+
+    npos = s->pos + s->tile;
+    if ((s->mode & MYMEM_STREAM_RD) && npos < s->total) {
+        mymem_prefetch(&s->in[c ^ 1], s->buf[c ^ 1], s->ext + npos, (s->total - npos < s->tile) ? s->total - npos : s->tile);
+    }
+    return s->buf[c];
+}
+
+/**
+ * @brief       关闭流: 写回当前块 (提前结束时), 等待所有搬运完成, 释放缓冲区
+ * @param       s : 流句柄
+ * @retval      0: 成功; 1: 有搬运出现DMA传输错误
+ */
+uint8_t mymem_stream_close(mymem_stream_t *s)
+{
+    uint8_t err, i;
+
+    if (s == NULL) return 0;
+
+    if (s->len && (s->mode & MYMEM_STREAM_WR)) mymem_writeback(&s->out[s->cur], s->ext + s->pos, s->buf[s->cur], s->len);
+
+    err = s->err;
+    for (i = 0; i < 2; i++) {
+        err |= mymem_xfer_wait(&s->in[i]);
+        err |= mymem_xfer_wait(&s->out[i]);
+    }
+
+    myfree(s->memx, s->buf[0]);
+    myfree(s->memx, s->buf[1]);
+    myfree(SRAMIN, s);
+    return err;
+}
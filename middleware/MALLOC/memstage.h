@@ -0,0 +1,87 @@
+/**
+ ****************************************************************************************************
+ * @file        memstage.h
+ * @brief       分级内存搬运: 外扩SRAM <-> 内部SRAM/CCM 的 DMA 预取/写回, 以及双缓冲流式处理
+ ****************************************************************************************************
+ * @attention
+ *
+ * 外扩SRAM每次访问都要经过FSMC (比内部SRAM慢数倍), 数据量大、反复访问的算法 (DSP/图像)
+ * 可以把当前要处理的一段先搬到内部RAM, 算完再搬回去:
+ *   mymem_prefetch / mymem_writeback : 启动一次搬运后立即返回, mymem_xfer_wait 等待完成.
+ *       所有搬运在 DMA_M2M_CH_STAGE 通道上按提交顺序排队执行 (完成中断里启动下一个),
+ *       因此 "写回缓冲区A" 之后提交的 "预取到缓冲区A" 一定在写回完成后才开始.
+ *   mymem_stream_xxx : 对外扩SRAM中的大数组按块双缓冲处理, 处理第k块的同时,
+ *       DMA在后台写回第k-1块、预取第k+1块, 计算与搬运重叠.
+ *
+ * CCM只有CPU能访问: 缓冲区在CCM、长度小于 MEM_STAGE_DMA_MIN、或源/目的地址对2取模不同时,
+ * 退回CPU拷贝 (等前面排队的搬运完成后在调用者中同步完成, 保持顺序).
+ * 排队的搬运在DMA完成中断里启动, 此时DMA启动失败不会在中断里整块拷贝, 该搬运以 MYMEM_XFER_ERROR
+ * 结束 (mymem_xfer_wait 返回1, 数据未搬运), 由调用者重新提交或自行拷贝.
+ *
+ * 等待: 队列由多个任务和DMA中断共同操作. mymem_xfer_wait 把等待的任务登记在搬运句柄里, 由该搬运结束时
+ * (DMA完成中断, 或CPU拷贝完成) 用任务通知唤醒, 多个任务可以同时等待各自的搬运, 不会丢失唤醒.
+ * (主机测试是单线程的, 不覆盖并发等待.)
+ *
+ * 注意: 搬运句柄和流在完成前不能释放/复用; 同一个句柄/流只能由一个任务使用 (等待).
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEMSTAGE_H
+#define __MEMSTAGE_H
+
+#include "./malloc.h"
+
+#define MEM_STAGE_DMA_MIN       64                                          /* 小于该字节数的搬运由CPU完成 */
+
+/* 搬运状态 */
+#define MYMEM_XFER_IDLE         0                                           /* 未提交 */
+#define MYMEM_XFER_QUEUED       1                                           /* 排队等待前面的搬运 */
+#define MYMEM_XFER_BUSY         2                                           /* DMA传输中 */
+#define MYMEM_XFER_DONE         3                                           /* 完成 */
+#define MYMEM_XFER_ERROR        4                                           /* DMA传输错误 */
+
+/* 搬运句柄 */
+typedef struct mymem_xfer
+{
+    void *des;                                                              /* 目的 */
+    const void *src;                                                        /* 源 */
+    uint32_t len;                                                           /* 字节数 */
+    volatile uint8_t state;                                                 /* MYMEM_XFER_xxx */
+    struct mymem_xfer *next;                                                /* 队列中的下一个 */
+    void *volatile waiter;                                                  /* 等待该搬运的任务 (TaskHandle_t), NULL: 无 */
+} mymem_xfer_t;
+
+/* 流模式 */
+#define MYMEM_STREAM_RD         0x01                                        /* 每块处理前从外扩SRAM预取 */
+#define MYMEM_STREAM_WR         0x02                                        /* 每块处理后写回外扩SRAM */
+#define MYMEM_STREAM_RW         (MYMEM_STREAM_RD | MYMEM_STREAM_WR)
+
+/* 双缓冲流 */
+typedef struct
+{
+    uint8_t *ext;                                                           /* 外扩SRAM中的数组 */
+    uint32_t total;                                                         /* 数组字节数 */
+    uint32_t tile;                                                          /* 每块字节数 */
+    uint32_t pos;                                                           /* 当前块在数组中的偏移 */
+    uint32_t len;                                                           /* 当前块字节数 (0: 未开始或已结束) */
+    uint8_t *buf[2];                                                        /* 内部缓冲区 */
+    mymem_xfer_t in[2];                                                     /* 各缓冲区的预取 */
+    mymem_xfer_t out[2];                                                    /* 各缓冲区的写回 */
+    uint8_t cur;                                                            /* 当前块所在缓冲区 */
+    uint8_t mode;                                                           /* MYMEM_STREAM_xxx */
+    uint8_t memx;                                                           /* 缓冲区所在内存池 */
+    uint8_t err;                                                            /* 出现过DMA传输错误 */
+} mymem_stream_t;
+
+uint8_t mymem_prefetch(mymem_xfer_t *x, void *local, const void *ext, uint32_t len);   /* ext -> local */
+uint8_t mymem_writeback(mymem_xfer_t *x, void *ext, const void *local, uint32_t len);  /* local -> ext */
+uint8_t mymem_xfer_done(mymem_xfer_t *x);
+uint8_t mymem_xfer_wait(mymem_xfer_t *x);
+void mymem_stage_sync(void);
+
+mymem_stream_t *mymem_stream_open(void *ext, uint32_t total, uint32_t tile, uint8_t memx, uint8_t mode);
+void *mymem_stream_next(mymem_stream_t *s);
+uint8_t mymem_stream_close(mymem_stream_t *s);
+
+#endif
@@ -0,0 +1,367 @@
+/**
+ ****************************************************************************************************
+ * @file        XMRAM.c
+ * @brief       外扩SRAM芯片上电配置 (原 XMRAM.lib 的源码实现) 及启动自检
+ ****************************************************************************************************
+ * @attention
+ *
+ * 配置时序见 XMRAM.h. 寄存器读写期间引脚为普通GPIO, 由随后的 sram_init 重新配置为FSMC复用功能.
+ *
+ ****************************************************************************************************
+ */
+
+#include "./XMRAM.h"
+
+/* 控制线: NWE / NOE / NE3 与FSMC相同, A10 (PG0) 在寄存器访问时作为 命令/地址 选择 */
+#define XMRAM_A10_PORT          GPIOG
+#define XMRAM_A10_PIN           GPIO_PIN_0
+
+#define XMRAM_PIN(port, pin, x) ((port)->BSRR = (x) ? (uint32_t)(pin) : (uint32_t)(pin) << 16)
+#define XMRAM_WR(x)             XMRAM_PIN(SRAM_WR_GPIO_PORT, SRAM_WR_GPIO_PIN, x)
+#define XMRAM_RD(x)             XMRAM_PIN(SRAM_RD_GPIO_PORT, SRAM_RD_GPIO_PIN, x)
+#define XMRAM_CS(x)             XMRAM_PIN(SRAM_CS_GPIO_PORT, SRAM_CS_GPIO_PIN, x)
+#define XMRAM_A10(x)            XMRAM_PIN(XMRAM_A10_PORT, XMRAM_A10_PIN, x)
+
+typedef struct
+{
+    GPIO_TypeDef *port;
+    uint16_t pin;
+} xmram_io_t;
+
+/* 解锁序列: 依次出现在地址线上 */
+static const uint16_t g_xmram_key[5] = {0x0530, 0x0790, 0x08D0, 0x0A40, 0x06C0};
+
+/* 解锁地址 bit0~11 对应的引脚 (bit3不输出), 与芯片的地址线连接顺序有关, 不是FSMC的A0~A11 */
+static const xmram_io_t g_xmram_addr_io[12] = {
+    {GPIOF, GPIO_PIN_0}, {GPIOG, GPIO_PIN_1}, {GPIOF, GPIO_PIN_2},  {NULL, 0},
+    {GPIOF, GPIO_PIN_1}, {GPIOF, GPIO_PIN_15}, {GPIOG, GPIO_PIN_4}, {GPIOF, GPIO_PIN_14},
+    {GPIOG, GPIO_PIN_5}, {GPIOF, GPIO_PIN_13}, {GPIOF, GPIO_PIN_5}, {GPIOF, GPIO_PIN_3},
+};
+
+/* 数据 bit0~7: FSMC D0~D7 */
+static const xmram_io_t g_xmram_data_io[8] = {
+    {GPIOD, GPIO_PIN_14}, {GPIOD, GPIO_PIN_15}, {GPIOD, GPIO_PIN_0}, {GPIOD, GPIO_PIN_1},
+    {GPIOE, GPIO_PIN_7},  {GPIOE, GPIO_PIN_8},  {GPIOE, GPIO_PIN_9}, {GPIOE, GPIO_PIN_10},
+};
+
+xmram_info_t g_xmram_info;
+
+/**
+ * @brief       DWT周期计数 (计时用)
+ */
+static uint32_t xmram_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+static uint32_t xmram_us(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000);
+}
+
+/**
+ * @brief       一个延时单位 (每个时序边沿之后), 与原库的循环次数相同
+ */
+static void xmram_delay(void)
+{
+    uint32_t i;
+
+    for (i = XMRAM_DELAY_LOOPS; i; i--) __NOP();
+}
+
+/**
+ * @brief       寄存器访问用到的引脚全部设为推挽输出, 控制线置为无效
+ */
+static void xmram_gpio_init(void)
+{
+    GPIO_InitTypeDef gpio_init_struct;
+
+    __HAL_RCC_GPIOD_CLK_ENABLE();
+    __HAL_RCC_GPIOE_CLK_ENABLE();
+    __HAL_RCC_GPIOF_CLK_ENABLE();
+    __HAL_RCC_GPIOG_CLK_ENABLE();
+
+    gpio_init_struct.Mode = GPIO_MODE_OUTPUT_PP;
+    gpio_init_struct.Pull = GPIO_PULLUP;
+    gpio_init_struct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio_init_struct.Alternate = 0;
+
+    gpio_init_struct.Pin = GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15;
+    HAL_GPIO_Init(GPIOD, &gpio_init_struct);                                /* D2/D3, NOE/NWE, A18, D0/D1 */
+    gpio_init_struct.Pin = GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3 | GPIO_PIN_5 | GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15;
+    HAL_GPIO_Init(GPIOF, &gpio_init_struct);                                /* A0~A3, A5, A7~A9 */
+    gpio_init_struct.Pin = GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_4 | GPIO_PIN_5 | GPIO_PIN_10;
+    HAL_GPIO_Init(GPIOG, &gpio_init_struct);                                /* A10/A11, A14/A15, NE3 */
+    gpio_init_struct.Pin = GPIO_PIN_7 | GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10;
+    HAL_GPIO_Init(GPIOE, &gpio_init_struct);                                /* D4~D7 */
+
+    XMRAM_WR(1);
+    XMRAM_CS(1);
+    XMRAM_RD(1);
+    XMRAM_A10(0);
+}
+
+/**
+ * @brief       数据线 D0~D7 改为输入 (读寄存器)
+ */
+static void xmram_gpio_data_in(void)
+{
+    GPIO_InitTypeDef gpio_init_struct;
+
+    gpio_init_struct.Mode = GPIO_MODE_INPUT;
+    gpio_init_struct.Pull = GPIO_PULLUP;
+    gpio_init_struct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    gpio_init_struct.Alternate = 0;
+
+    gpio_init_struct.Pin = GPIO_PIN_7 | GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10;
+    HAL_GPIO_Init(GPIOE, &gpio_init_struct);
+    gpio_init_struct.Pin = GPIO_PIN_0 | GPIO_PIN_1 | GPIO_PIN_14 | GPIO_PIN_15;
+    HAL_GPIO_Init(GPIOD, &gpio_init_struct);
+}
+
+static void xmram_addr_out(uint16_t addr)
+{
+    uint8_t i;
+
+    for (i = 0; i < 12; i++) {
+        if (g_xmram_addr_io[i].port) XMRAM_PIN(g_xmram_addr_io[i].port, g_xmram_addr_io[i].pin, (addr >> i) & 1);
+    }
+}
+
+static void xmram_data_out(uint8_t data)
+{
+    uint8_t i;
+
+    for (i = 0; i < 8; i++) XMRAM_PIN(g_xmram_data_io[i].port, g_xmram_data_io[i].pin, (data >> i) & 1);
+}
+
+static uint8_t xmram_data_in(void)
+{
+    uint8_t i, data = 0;
+
+    for (i = 0; i < 8; i++) {
+        if (g_xmram_data_io[i].port->IDR & g_xmram_data_io[i].pin) data |= 1 << i;
+    }
+    return data;
+}
+
+/**
+ * @brief       NWE打一拍, 同时在数据线上给出一个字节
+ */
+static void xmram_write_byte(uint8_t data)
+{
+    XMRAM_WR(0);
+    xmram_data_out(data);
+    xmram_delay();
+    XMRAM_WR(1);
+    xmram_delay();
+}
+
+/**
+ * @brief       解锁序列 + 寄存器号 (写时高字节bit7置1)
+ */
+static void xmram_reg_begin(uint16_t reg, uint8_t wr)
+{
+    uint8_t i;
+
+    for (i = 0; i < 5; i++) {
+        XMRAM_WR(0);
+        xmram_addr_out(g_xmram_key[i]);
+        xmram_delay();
+        XMRAM_WR(1);
+        xmram_delay();
+    }
+
+    XMRAM_A10(1);
+    xmram_write_byte((wr ? 0x80 : 0) | (reg >> 8));
+    xmram_write_byte(reg & 0xFF);
+}
+
+/**
+ * @brief       结束寄存器访问: NE3打一拍
+ */
+static void xmram_reg_end(void)
+{
+    XMRAM_CS(0);
+    XMRAM_WR(1);
+    XMRAM_RD(1);
+    xmram_delay();
+    XMRAM_CS(1);
+}
+
+/**
+ * @brief       写配置寄存器 (FSMC接管引脚之前调用)
+ * @param       reg : 寄存器号
+ * @param       val : 值
+ * @retval      无
+ */
+void xmram_reg_write(uint16_t reg, uint16_t val)
+{
+    xmram_gpio_init();
+    xmram_delay();
+    xmram_reg_begin(reg, 1);
+    xmram_write_byte(val >> 8);
+    xmram_write_byte(val & 0xFF);
+    xmram_reg_end();
+}
+
+/**
+ * @brief       读配置寄存器 (FSMC接管引脚之前调用)
+ * @param       reg : 寄存器号
+ * @retval      寄存器值
+ */
+uint16_t xmram_reg_read(uint16_t reg)
+{
+    uint16_t val;
+
+    xmram_gpio_init();
+    XMRAM_WR(0);
+    xmram_delay();
+    xmram_reg_begin(reg, 0);
+
+    XMRAM_WR(0);
+    xmram_gpio_data_in();
+    XMRAM_RD(0);
+    xmram_delay();
+
+    XMRAM_WR(1);                                                            /* 高字节 */
+    xmram_delay();
+    val = xmram_data_in() << 8;
+    xmram_delay();
+
+    XMRAM_WR(0);                                                            /* 低字节 */
+    xmram_delay();
+    XMRAM_WR(1);
+    xmram_delay();
+    val |= xmram_data_in();
+    xmram_delay();
+
+    xmram_reg_end();
+    return val;
+}
+
+/**
+ * @brief       外扩SRAM芯片配置 (sram_init 开头调用)
+ * @note        冷启动: 写配置, 读回校验 (不对再写一次), 等待芯片稳定;
+ *              热复位: 先读配置, 已经正确则直接返回 (g_xmram_info.fast = 1)
+ * @param       无
+ * @retval      0: 成功; 1: 配置寄存器读回不对
+ */
+int XmRamInit(void)
+{
+    uint32_t t0;
+    uint16_t i;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    t0 = xmram_now();
+
+    g_xmram_info.csr = RCC->CSR;
+    g_xmram_info.warm = (g_xmram_info.csr & (RCC_CSR_PORRSTF | RCC_CSR_BORRSTF)) == 0;
+    g_xmram_info.fast = 0;
+    RCC->CSR |= RCC_CSR_RMVF;                                               /* 清除复位标志, 下次复位才能区分冷/热 */
+
+    if (g_xmram_info.warm) {
+        g_xmram_info.reg = xmram_reg_read(XMRAM_CFG_REG);
+        g_xmram_info.fast = g_xmram_info.reg == XMRAM_CFG_VAL;
+    }
+
+    if (!g_xmram_info.fast) {
+        xmram_reg_write(XMRAM_CFG_REG, XMRAM_CFG_VAL);
+        g_xmram_info.reg = xmram_reg_read(XMRAM_CFG_REG);
+
+        if (g_xmram_info.reg != XMRAM_CFG_VAL) {
+            xmram_reg_write(XMRAM_CFG_REG, XMRAM_CFG_VAL);
+            g_xmram_info.reg = xmram_reg_read(XMRAM_CFG_REG);
+        }
+
+        for (i = 0; i < XMRAM_SETTLE_DELAYS; i++) xmram_delay();
+    }
+
+    g_xmram_info.init_us = xmram_us(xmram_now() - t0);
+    return g_xmram_info.reg != XMRAM_CFG_VAL;
+}
+
+/**
+ * @brief       抽查整片是否都是 pat
+ * @retval      0: 通过; 否则为出错的偏移 + 1
+ */
+static uint32_t xmram_check(uint32_t pat, uint32_t stride)
+{
+    volatile uint32_t *p = (volatile uint32_t *)SRAM_BASE_ADDR;
+    uint32_t off;
+
+    for (off = 0; off < XMRAM_SIZE; off += stride) {
+        if (p[off / 4] != pat) return off + 1;
+    }
+    if (p[XMRAM_SIZE / 4 - 1] != pat) return XMRAM_SIZE - 4 + 1;            /* 最后一个字 */
+
+    return 0;
+}
+
+/**
+ * @brief       外扩SRAM快速自检 (内容被破坏)
+ * @note        数据线: 0地址走1; 字节选通: 奇/偶字节分别写; 地址线: 2的幂偏移处写入各自编号后全部读回;
+ *              存储阵列: DMA (DMA_M2M_CH_MEM) 以正反两种图案填充整片, CPU每 stride 字节抽查一个字.
+ *              DMA不可用时由CPU填充. 须在 sram_init 和 dma_m2m_init 之后调用
+ * @param       stride : 抽查间隔 (字节, 4的倍数; 4: 全部检查)
+ * @retval      0: 通过; 否则为出错的偏移 (相对SRAM_BASE_ADDR) + 1
+ */
+uint32_t xmram_memtest(uint32_t stride)
+{
+    volatile uint16_t *p16 = (volatile uint16_t *)SRAM_BASE_ADDR;
+    volatile uint8_t *p8 = (volatile uint8_t *)SRAM_BASE_ADDR;
+    uint32_t pat = 0x5AA5C33C, off, k, n, err;
+
+    for (k = 0; k < 16; k++) {                                              /* 数据线 */
+        p16[0] = 1 << k;
+        if (p16[0] != (1 << k)) return 1;
+    }
+
+    p8[1] = 0x12;                                                           /* 字节选通 */
+    p8[0] = 0x34;
+    if (p16[0] != 0x1234) return 1;
+
+    p16[0] = 0xFFFF;                                                        /* 地址线 (半字单位) */
+    for (k = 1, n = 0; k < XMRAM_SIZE / 2; k <<= 1, n++) p16[k] = 0x5A00 | n;
+    if (p16[0] != 0xFFFF) return 1;
+    for (k = 1, n = 0; k < XMRAM_SIZE / 2; k <<= 1, n++) {
+        if (p16[k] != (0x5A00 | n)) return k * 2 + 1;
+    }
+
+    if (stride < 4) stride = 4;
+    for (k = 0; k < 2; k++, pat = ~pat) {                                   /* 存储阵列: 正反图案 */
+        if (dma_m2m_fill(DMA_M2M_CH_MEM, (void *)SRAM_BASE_ADDR, pat, XMRAM_SIZE, DMA_M2M_WORD) != DMA_M2M_OK) {
+            for (off = 0; off < XMRAM_SIZE; off += 4) *(volatile uint32_t *)(SRAM_BASE_ADDR + off) = pat;
+        }
+        err = xmram_check(pat, stride);
+        if (err) return err;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       启动自检 (XMRAM_MEMTEST 为1时) 并输出 配置方式 和 初始化/自检 耗时
+ * @note        在 sram_init、dma_m2m_init 之后, SRAMEX 内存池初始化之前调用
+ * @param       无
+ * @retval      无
+ */
+void xmram_boot_test(void)
+{
+#if XMRAM_MEMTEST
+    uint32_t t0 = xmram_now();
+
+    g_xmram_info.test_err = xmram_memtest(XMRAM_MEMTEST_STRIDE);
+    g_xmram_info.test_us = xmram_us(xmram_now() - t0);
+#endif
+
+    printf("XMRAM: %s%s, 配置 0x%04X, 初始化 %u.%03u ms", g_xmram_info.warm ? "热复位" : "上电",
+           g_xmram_info.fast ? " (快速)" : "", g_xmram_info.reg, g_xmram_info.init_us / 1000, g_xmram_info.init_us % 1000);
+#if XMRAM_MEMTEST
+    printf(", 自检 %u.%03u ms ", g_xmram_info.test_us / 1000, g_xmram_info.test_us % 1000);
+    if (g_xmram_info.test_err) printf("出错 @0x%08X", SRAM_BASE_ADDR + g_xmram_info.test_err - 1);
+    else printf("通过");
+#endif
+    printf("\r\n");
+}
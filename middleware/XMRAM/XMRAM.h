@@ -1,5 +1,61 @@
+/**
+ ****************************************************************************************************
+ * @file        XMRAM.h
+ * @brief       外扩SRAM芯片上电配置 (原 XMRAM.lib 的源码实现) 及启动自检
+ ****************************************************************************************************
+ * @attention
+ *
+ * 板上的外扩SRAM在FSMC接管引脚之前需要先用GPIO模拟时序写一次内部配置寄存器 (0x30 = 6),
+ * 由 sram_init 开头调用 XmRamInit 完成. 时序与原 XMRAM.lib 一致:
+ *   5个解锁周期 (地址线给出 g_xmram_key, NWE打拍) -> A10置1 -> 数据线依次给出 寄存器号高/低字节
+ *   (写时高字节bit7置1) -> 写: 数据高/低字节; 读: 数据线改为输入, NOE拉低后读 高/低字节 -> NE3打拍结束
+ *
+ * 上电 (冷启动) 走完整流程: 写寄存器, 读回校验 (不对再写一次), 再等待 XMRAM_SETTLE_DELAYS 个延时单位 (约100ms).
+ * 热复位 (复位引脚/软件/看门狗, 芯片没有掉电) 时配置还在: 只读一次寄存器, 值正确就跳过写入和等待 (约10ms);
+ * 读回不对时退回完整流程. 冷/热由 RCC->CSR 的 POR/BOR 复位标志判断, 判断后清除复位标志
+ * (原标志保存在 g_xmram_info.csr).
+ *
+ * XMRAM_MEMTEST 置1时, xmram_boot_test (须在FSMC和DMA初始化之后、SRAMEX内存池初始化之前调用)
+ * 对整片SRAM做快速自检: 数据线、地址线, 以及 DMA 填充整片 + CPU 按 XMRAM_MEMTEST_STRIDE 间隔抽查
+ * (正反两种图案). 启动时串口输出配置方式和 初始化/自检 各自耗时.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __XMRAM_H
+#define __XMRAM_H
+
 #include "../../driver/SRAM/sram.h"
 #include "../../driver/usart/usart.h"
 #include "../../driver/delay/delay.h"
 
-int XmRamInit(void);
+#define XMRAM_CFG_REG           0x30                                        /* 配置寄存器 */
+#define XMRAM_CFG_VAL           6                                           /* 配置值 */
+#define XMRAM_DELAY_LOOPS       16800                                       /* 一个延时单位的循环次数 (每个时序边沿之后) */
+#define XMRAM_SETTLE_DELAYS     200                                         /* 冷启动配置后等待的延时单位数 */
+
+#define XMRAM_SIZE              (1024 * 1024)                               /* 芯片容量 (字节) */
+#define XMRAM_MEMTEST           0                                           /* 1: 启动自检 */
+#define XMRAM_MEMTEST_STRIDE    64                                          /* 抽查间隔 (字节, 4的倍数; 4: 全部检查) */
+
+/* 启动信息 */
+typedef struct
+{
+    uint32_t csr;                                                           /* 复位时的 RCC->CSR */
+    uint8_t warm;                                                           /* 1: 热复位 */
+    uint8_t fast;                                                           /* 1: 走了快速路径 (配置已在) */
+    uint16_t reg;                                                           /* 最后读回的配置寄存器值 */
+    uint32_t init_us;                                                       /* XmRamInit 耗时 */
+    uint32_t test_us;                                                       /* 自检耗时 */
+    uint32_t test_err;                                                      /* 自检出错的地址 (相对SRAM_BASE_ADDR) + 1, 0: 通过 */
+} xmram_info_t;
+
+extern xmram_info_t g_xmram_info;
+
+int XmRamInit(void);                                                        /* 0: 成功; 1: 配置寄存器读回不对 */
+uint16_t xmram_reg_read(uint16_t reg);
+void xmram_reg_write(uint16_t reg, uint16_t val);
+uint32_t xmram_memtest(uint32_t stride);
+void xmram_boot_test(void);
+
+#endif
@@ -21,7 +21,7 @@ extern uint32_t SystemCoreClock;
 #define configUSE_16_BIT_TICKS                          0                       /* 1: 定义系统时钟节拍计数器的数据类型为16位无符号数, 无默认需定义 */
 #define configIDLE_SHOULD_YIELD                         1                       /* 1: 使能在抢占式调度下,同优先级的任务能抢占空闲任务, 默认: 1 */
 #define configUSE_TASK_NOTIFICATIONS                    1                       /* 1: 使能任务间直接的消息传递,包括信号量、事件标志组和消息邮箱, 默认: 1 */
-#define configTASK_NOTIFICATION_ARRAY_ENTRIES           1                       /* 定义任务通知数组的大小, 默认: 1 */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES           2                       /* 定义任务通知数组的大小, 默认: 1 (下标1由 dma_m2m_wait 专用, 见 dma.h) */
 #define configUSE_MUTEXES                               1                       /* 1: 使能互斥信号量, 默认: 0 */
 #define configUSE_RECURSIVE_MUTEXES                     1                       /* 1: 使能递归互斥信号量, 默认: 0 */
 #define configUSE_COUNTING_SEMAPHORES                   1                       /* 1: 使能计数信号量, 默认: 0 */
@@ -31,16 +31,20 @@ extern uint32_t SystemCoreClock;
 #define configUSE_TIME_SLICING                          1                       /* 1: 使能时间片调度, 默认: 1 */
 #define configUSE_NEWLIB_REENTRANT                      0                       /* 1: 任务创建时分配Newlib的重入结构体, 默认: 0 */
 #define configENABLE_BACKWARD_COMPATIBILITY             0                       /* 1: 使能兼容老版本, 默认: 1 */
-#define configNUM_THREAD_LOCAL_STORAGE_POINTERS         0                       /* 定义线程本地存储指针的个数, 默认: 0 */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS         1                       /* 定义线程本地存储指针的个数, 默认: 0 (0号: malloc每任务缓存) */
 #define configSTACK_DEPTH_TYPE                          uint16_t                /* 定义任务堆栈深度的数据类型, 默认: uint16_t */
 #define configMESSAGE_BUFFER_LENGTH_TYPE                size_t                  /* 定义消息缓冲区中消息长度的数据类型, 默认: size_t */
 
 /* 内存分配相关定义 */
 #define configSUPPORT_STATIC_ALLOCATION                 0                       /* 1: 支持静态申请内存, 默认: 0 */
 #define configSUPPORT_DYNAMIC_ALLOCATION                1                       /* 1: 支持动态申请内存, 默认: 1 */
-#define configTOTAL_HEAP_SIZE                           ((size_t)(16 * 1024))   /* FreeRTOS堆中可用的RAM总量, 单位: Byte, 无默认需定义 */
+#define configTOTAL_HEAP_SIZE                           ((size_t)(16 * 1024))   /* FreeRTOS堆的内部SRAM部分 (heap_bank另有CCM/外扩SRAM区域), 单位: Byte, 无默认需定义 */
 #define configAPPLICATION_ALLOCATED_HEAP                0                       /* 1: 用户手动分配FreeRTOS内存堆(ucHeap), 默认: 0 */
-#define configSTACK_ALLOCATION_FROM_SEPARATE_HEAP       0                       /* 1: 用户自行实现任务创建时使用的内存申请与释放函数, 默认: 0 */
+#define configSTACK_ALLOCATION_FROM_SEPARATE_HEAP       1                       /* 1: 用户自行实现任务创建时使用的内存申请与释放函数, 默认: 0 (malloc.c: 任务栈放在CCM) */
+#define configRECORD_STACK_HIGH_ADDRESS                 1                       /* 1: 在TCB中记录栈顶地址 (my_mem_stack_print 据此计算每个任务的栈大小), 默认: 0 */
+#define configHEAP_CCM_SIZE                             ((size_t)(16 * 1024))   /* heap_bank: 从MALLOC的SRAMCCM内存池划给FreeRTOS堆的大小, 0: 不使用CCM */
+#define configHEAP_EXT_SIZE                             ((size_t)(128 * 1024))  /* heap_bank: 从MALLOC的SRAMEX内存池划给FreeRTOS堆的大小, 0: 不使用外扩SRAM (申请不到时输出提示且该区域不启用, 800x480屏预留帧缓冲时见 lcd_fb.h) */
+#define configHEAP_DEFAULT_HINT                         heapHINT_FAST           /* heap_bank: pvPortMalloc 的放置提示 (见 heap_bank.h) */
 
 /* 钩子函数相关定义 */
 #define configUSE_IDLE_HOOK                             0                       /* 1: 使能空闲任务钩子函数, 无默认需定义  */
@@ -110,6 +114,18 @@ extern uint32_t FreeRTOSRunTimeTicks;
 #define vAssertCalled(char, int) printf("Error: %s, %d\r\n", char, int)
 #define configASSERT( x ) if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
 
+/* 任务删除时归还其malloc每任务缓存 (middleware/MALLOC); prvDeleteTCB 在临界区外调用 (自删除时在空闲任务中) */
+extern void my_mem_cache_release(void *task);
+#define portCLEAN_UP_TCB( pxTCB )                       my_mem_cache_release( pxTCB )
+
+/* 堆申请/释放记录输出到串口1, 供主机 test/heap/trace_replay 重放 (格式见 middleware/MALLOC/mem_tag.h) */
+#define configHEAP_TRACE                                0                       /* 1: 输出记录, 默认: 0 */
+#if configHEAP_TRACE
+extern void mem_trace(char op, uint8_t heap, void *ptr, uint32_t size);
+#define traceMALLOC( pvAddress, uiSize )                mem_trace( 'm', 3, ( pvAddress ), ( uiSize ) )
+#define traceFREE( pvAddress, uiSize )                  mem_trace( 'f', 3, ( pvAddress ), 0 )
+#endif
+
 /* FreeRTOS MPU 特殊定义 */
 //#define configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS 0
 //#define configTOTAL_MPU_REGIONS                                8
@@ -0,0 +1,411 @@
+/**
+ ****************************************************************************************************
+ * @file        heap_bank.c
+ * @brief       FreeRTOS 多区域堆 (heap_5 方式), 支持按区域放置提示
+ ****************************************************************************************************
+ * @attention
+ *
+ * 空闲块按地址排序串成一条链表, 释放时与前后相邻的空闲块合并 (与 heap_4/heap_5 相同).
+ * 各区域地址互不相邻, 合并不会跨区域. 块头与 heap_4 相同, 块大小最高位表示已分配.
+ * 申请时按提示给出的区域顺序查找: 链表有序, 每个区域只需遍历落在该区域地址范围内的那一段.
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "./heap_bank.h"
+#include "../../../../middleware/MALLOC/malloc.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 0)
+#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#ifndef configHEAP_CCM_SIZE
+#define configHEAP_CCM_SIZE         0
+#endif
+
+#ifndef configHEAP_EXT_SIZE
+#define configHEAP_EXT_SIZE         0
+#endif
+
+#ifndef configHEAP_DEFAULT_HINT
+#define configHEAP_DEFAULT_HINT     heapHINT_FAST
+#endif
+
+#define heapMINIMUM_BLOCK_SIZE      ((size_t)(xHeapStructSize << 1))        /* 拆分后剩余部分的最小值 */
+#define heapSIZE_MAX                (~((size_t)0))
+#define heapBLOCK_ALLOCATED_BITMASK (((size_t)1) << ((sizeof(size_t) * 8) - 1))
+#define heapBLOCK_SIZE_IS_VALID(x)  (((x) & heapBLOCK_ALLOCATED_BITMASK) == 0)
+#define heapBLOCK_IS_ALLOCATED(p)   (((p)->xBlockSize & heapBLOCK_ALLOCATED_BITMASK) != 0)
+
+/* 空闲块头 (按地址排序的单链表, 已分配块的 pxNextFreeBlock 为 NULL) */
+typedef struct A_BLOCK_LINK
+{
+    struct A_BLOCK_LINK *pxNextFreeBlock;
+    size_t xBlockSize;
+} BlockLink_t;
+
+/* 区域 */
+typedef struct
+{
+    void *pvRegion;                     /* 区域原始地址 (CCM/外扩SRAM区域释放时归还给 MALLOC) */
+    uint8_t *pucStart;                  /* 区域起始 (已对齐), NULL 表示未启用 */
+    uint8_t *pucEnd;                    /* 区域结束 */
+    size_t xSize;                       /* 区域可用字节数 */
+    size_t xFree;                       /* 当前空闲字节数 */
+    size_t xMinFree;                    /* 历史最少空闲字节数 */
+} HeapBank_t;
+
+/* 内部SRAM区域 */
+PRIVILEGED_DATA static uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+
+static const size_t xHeapStructSize = (sizeof(BlockLink_t) + ((size_t)(portBYTE_ALIGNMENT - 1))) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+
+PRIVILEGED_DATA static BlockLink_t xStart;                                  /* 链表头 */
+PRIVILEGED_DATA static HeapBank_t xBank[heapBANK_NUM];
+PRIVILEGED_DATA static uint8_t ucHeapReady = 0;
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = 0;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = 0;
+
+/* 各提示的区域查找顺序, heapBANK_NUM 结束 */
+static const uint8_t ucHintOrder[3][heapBANK_NUM + 1] = {
+    {heapBANK_SRAMIN, heapBANK_SRAMEX, heapBANK_NUM, heapBANK_NUM},         /* heapHINT_FAST */
+    {heapBANK_CCM, heapBANK_SRAMIN, heapBANK_SRAMEX, heapBANK_NUM},         /* heapHINT_CCM */
+    {heapBANK_SRAMEX, heapBANK_SRAMIN, heapBANK_NUM, heapBANK_NUM},         /* heapHINT_BULK */
+};
+
+/**
+ * @brief   地址所属区域
+ * @retval  区域编号, heapBANK_NUM 表示不在堆中
+ */
+static uint8_t prvBankOf(const void *pv)
+{
+    uint8_t i;
+    for (i = 0; i < heapBANK_NUM; i++) {
+        if (xBank[i].pucStart && (uint8_t *)pv >= xBank[i].pucStart && (uint8_t *)pv < xBank[i].pucEnd) return i;
+    }
+    return heapBANK_NUM;
+}
+
+/**
+ * @brief   空闲块按地址插入链表, 与前后相邻的空闲块合并
+ */
+static void prvInsertBlockIntoFreeList(BlockLink_t *pxBlockToInsert)
+{
+    BlockLink_t *pxIterator;
+
+    for (pxIterator = &xStart; pxIterator->pxNextFreeBlock != NULL && pxIterator->pxNextFreeBlock < pxBlockToInsert;
+         pxIterator = pxIterator->pxNextFreeBlock) {
+    }
+
+    if (pxIterator != &xStart && (uint8_t *)pxIterator + pxIterator->xBlockSize == (uint8_t *)pxBlockToInsert) {
+        pxIterator->xBlockSize += pxBlockToInsert->xBlockSize;              /* 与前一块合并 */
+        pxBlockToInsert = pxIterator;
+    }
+
+    if (pxIterator->pxNextFreeBlock != NULL &&
+        (uint8_t *)pxBlockToInsert + pxBlockToInsert->xBlockSize == (uint8_t *)pxIterator->pxNextFreeBlock) {
+        pxBlockToInsert->xBlockSize += pxIterator->pxNextFreeBlock->xBlockSize;   /* 与后一块合并 */
+        pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock->pxNextFreeBlock;
+    } else {
+        pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
+    }
+
+    if (pxIterator != pxBlockToInsert) pxIterator->pxNextFreeBlock = pxBlockToInsert;
+}
+
+/**
+ * @brief   加入一个区域
+ */
+static void prvAddBank(uint8_t ucBank, uint8_t *pucAddr, size_t xSize)
+{
+    portPOINTER_SIZE_TYPE uxStart, uxEnd;
+    BlockLink_t *pxBlock;
+
+    if (pucAddr == NULL || xSize <= xHeapStructSize + portBYTE_ALIGNMENT) return;
+
+    uxStart = ((portPOINTER_SIZE_TYPE)pucAddr + portBYTE_ALIGNMENT_MASK) & ~((portPOINTER_SIZE_TYPE)portBYTE_ALIGNMENT_MASK);
+    uxEnd = ((portPOINTER_SIZE_TYPE)pucAddr + xSize) & ~((portPOINTER_SIZE_TYPE)portBYTE_ALIGNMENT_MASK);
+
+    pxBlock = (BlockLink_t *)uxStart;
+    pxBlock->xBlockSize = (size_t)(uxEnd - uxStart);
+    pxBlock->pxNextFreeBlock = NULL;
+
+    xBank[ucBank].pvRegion = pucAddr;
+    xBank[ucBank].pucStart = (uint8_t *)uxStart;
+    xBank[ucBank].pucEnd = (uint8_t *)uxEnd;
+    xBank[ucBank].xSize = pxBlock->xBlockSize;
+    xBank[ucBank].xFree = pxBlock->xBlockSize;
+    xBank[ucBank].xMinFree = pxBlock->xBlockSize;
+    xFreeBytesRemaining += pxBlock->xBlockSize;
+    prvInsertBlockIntoFreeList(pxBlock);
+}
+
+/**
+ * @brief   从 MALLOC 内存池申请一个区域并加入; 申请不到时输出提示 (该区域不启用, 堆只剩其余区域)
+ */
+static void prvAddPoolBank(uint8_t ucBank, uint8_t memx, size_t xSize)
+{
+    uint8_t *pucAddr = (uint8_t *)mymalloc(memx, xSize);
+
+    if (pucAddr == NULL) {
+        printf("heap_bank: 内存池%u 申请不到 %u 字节, 该区域未启用\r\n", memx, (unsigned)xSize);
+        return;
+    }
+
+    prvAddBank(ucBank, pucAddr, xSize);
+}
+
+/**
+ * @brief   第一次申请时建立各区域
+ * @note    CCM / 外扩SRAM 区域从对应的 MALLOC 内存池申请, main 中 my_mem_init 须在创建第一个内核对象前完成
+ */
+static void prvHeapInit(void)
+{
+    xStart.pxNextFreeBlock = NULL;
+    xStart.xBlockSize = 0;
+
+    prvAddBank(heapBANK_SRAMIN, ucHeap, configTOTAL_HEAP_SIZE);
+#if (configHEAP_CCM_SIZE > 0)
+    prvAddPoolBank(heapBANK_CCM, SRAMCCM, configHEAP_CCM_SIZE);
+#endif
+#if (configHEAP_EXT_SIZE > 0)
+    prvAddPoolBank(heapBANK_SRAMEX, SRAMEX, configHEAP_EXT_SIZE);
+#endif
+
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+    ucHeapReady = 1;
+}
+
+/**
+ * @brief   在一个区域中首次适配
+ * @retval  分配到的块, NULL 表示该区域没有足够大的空闲块
+ */
+static BlockLink_t *prvAllocFromBank(uint8_t ucBank, size_t xWantedSize)
+{
+    HeapBank_t *pxBank = &xBank[ucBank];
+    BlockLink_t *pxPrevious = &xStart, *pxBlock, *pxNew;
+
+    if (pxBank->pucStart == NULL || pxBank->xFree < xWantedSize) return NULL;
+
+    for (pxBlock = xStart.pxNextFreeBlock; pxBlock != NULL && (uint8_t *)pxBlock < pxBank->pucEnd;
+         pxPrevious = pxBlock, pxBlock = pxBlock->pxNextFreeBlock) {
+        if ((uint8_t *)pxBlock < pxBank->pucStart || pxBlock->xBlockSize < xWantedSize) continue;
+
+        pxPrevious->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+        if (pxBlock->xBlockSize - xWantedSize > heapMINIMUM_BLOCK_SIZE) {   /* 拆分, 剩余部分留在链表原位置 */
+            pxNew = (BlockLink_t *)((uint8_t *)pxBlock + xWantedSize);
+            pxNew->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+            pxNew->pxNextFreeBlock = pxPrevious->pxNextFreeBlock;
+            pxPrevious->pxNextFreeBlock = pxNew;
+            pxBlock->xBlockSize = xWantedSize;
+        }
+
+        pxBank->xFree -= pxBlock->xBlockSize;
+        if (pxBank->xFree < pxBank->xMinFree) pxBank->xMinFree = pxBank->xFree;
+        xFreeBytesRemaining -= pxBlock->xBlockSize;
+        if (xFreeBytesRemaining < xMinimumEverFreeBytesRemaining) xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+
+        pxBlock->xBlockSize |= heapBLOCK_ALLOCATED_BITMASK;
+        pxBlock->pxNextFreeBlock = NULL;
+        return pxBlock;
+    }
+    return NULL;
+}
+
+/**
+ * @brief   按放置提示申请内存
+ * @param   xWantedSize : 字节数
+ * @param   ucHint      : heapHINT_FAST / heapHINT_CCM / heapHINT_BULK, 可或上 heapHINT_STRICT
+ * @retval  内存地址 (portBYTE_ALIGNMENT 对齐), NULL 表示失败
+ */
+void *pvPortMallocHint(size_t xWantedSize, uint8_t ucHint)
+{
+    const uint8_t *pucOrder = ucHintOrder[(ucHint & ~heapHINT_STRICT) < 3 ? (ucHint & ~heapHINT_STRICT) : 0];
+    BlockLink_t *pxBlock = NULL;
+    void *pvReturn = NULL;
+    size_t xAllocatedBlockSize = 0;
+    uint8_t i;
+
+    if (xWantedSize == 0 || xWantedSize > heapSIZE_MAX - xHeapStructSize - portBYTE_ALIGNMENT) {
+        xWantedSize = 0;
+    } else {
+        xWantedSize += xHeapStructSize;
+        xWantedSize = (xWantedSize + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+    }
+
+    vTaskSuspendAll();
+    {
+        if (!ucHeapReady) prvHeapInit();
+
+        if (xWantedSize > 0 && heapBLOCK_SIZE_IS_VALID(xWantedSize) && xWantedSize <= xFreeBytesRemaining) {
+            for (i = 0; pucOrder[i] < heapBANK_NUM && pxBlock == NULL; i++) {
+                pxBlock = prvAllocFromBank(pucOrder[i], xWantedSize);
+                if (ucHint & heapHINT_STRICT) break;
+            }
+        }
+
+        if (pxBlock) {
+            pvReturn = (uint8_t *)pxBlock + xHeapStructSize;
+            xAllocatedBlockSize = pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK;
+            xNumberOfSuccessfulAllocations++;
+        }
+
+        traceMALLOC(pvReturn, xAllocatedBlockSize);
+        (void)xAllocatedBlockSize;
+    }
+    (void)xTaskResumeAll();
+
+#if (configUSE_MALLOC_FAILED_HOOK == 1)
+    if (pvReturn == NULL) vApplicationMallocFailedHook();
+#endif
+
+    configASSERT((((size_t)pvReturn) & (size_t)portBYTE_ALIGNMENT_MASK) == 0);
+    return pvReturn;
+}
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+    return pvPortMallocHint(xWantedSize, configHEAP_DEFAULT_HINT);
+}
+
+void vPortFree(void *pv)
+{
+    BlockLink_t *pxLink;
+    uint8_t ucBank;
+
+    if (pv == NULL) return;
+
+    pxLink = (BlockLink_t *)((uint8_t *)pv - xHeapStructSize);
+    ucBank = prvBankOf(pxLink);
+    configASSERT(ucBank < heapBANK_NUM);
+    configASSERT(heapBLOCK_IS_ALLOCATED(pxLink));
+    configASSERT(pxLink->pxNextFreeBlock == NULL);
+
+    if (ucBank < heapBANK_NUM && heapBLOCK_IS_ALLOCATED(pxLink) && pxLink->pxNextFreeBlock == NULL) {
+        pxLink->xBlockSize &= ~heapBLOCK_ALLOCATED_BITMASK;
+#if (configHEAP_CLEAR_MEMORY_ON_FREE == 1)
+        (void)memset((uint8_t *)pxLink + xHeapStructSize, 0, pxLink->xBlockSize - xHeapStructSize);
+#endif
+        vTaskSuspendAll();
+        {
+            xBank[ucBank].xFree += pxLink->xBlockSize;
+            xFreeBytesRemaining += pxLink->xBlockSize;
+            traceFREE(pv, pxLink->xBlockSize);
+            prvInsertBlockIntoFreeList(pxLink);
+            xNumberOfSuccessfulFrees++;
+        }
+        (void)xTaskResumeAll();
+    }
+}
+
+void *pvPortCalloc(size_t xNum, size_t xSize)
+{
+    void *pv = NULL;
+
+    if (xNum == 0 || xSize <= heapSIZE_MAX / xNum) {
+        pv = pvPortMalloc(xNum * xSize);
+        if (pv != NULL) (void)memset(pv, 0, xNum * xSize);
+    }
+    return pv;
+}
+
+size_t xPortGetFreeHeapSize(void)
+{
+    return xFreeBytesRemaining;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    return xMinimumEverFreeBytesRemaining;
+}
+
+void xPortResetHeapMinimumEverFreeHeapSize(void)
+{
+    uint8_t i;
+
+    taskENTER_CRITICAL();
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+    for (i = 0; i < heapBANK_NUM; i++) xBank[i].xMinFree = xBank[i].xFree;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief   各区域的 当前空闲 / 历史最少空闲 / 总大小 (字节), 区域未启用时为0
+ */
+size_t xPortGetFreeHeapSizeBank(uint8_t ucBank)
+{
+    return ucBank < heapBANK_NUM ? xBank[ucBank].xFree : 0;
+}
+
+size_t xPortGetMinimumEverFreeHeapSizeBank(uint8_t ucBank)
+{
+    return ucBank < heapBANK_NUM ? xBank[ucBank].xMinFree : 0;
+}
+
+size_t xPortGetHeapSizeBank(uint8_t ucBank)
+{
+    return ucBank < heapBANK_NUM ? xBank[ucBank].xSize : 0;
+}
+
+void vPortInitialiseBlocks(void)
+{
+}
+
+void vPortGetHeapStats(HeapStats_t *pxHeapStats)
+{
+    BlockLink_t *pxBlock;
+    size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY;
+
+    vTaskSuspendAll();
+    {
+        for (pxBlock = ucHeapReady ? xStart.pxNextFreeBlock : NULL; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock) {
+            xBlocks++;
+            if (pxBlock->xBlockSize > xMaxSize) xMaxSize = pxBlock->xBlockSize;
+            if (pxBlock->xBlockSize < xMinSize) xMinSize = pxBlock->xBlockSize;
+        }
+    }
+    (void)xTaskResumeAll();
+
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+    pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief   复位堆状态 (重新启动调度器前调用), CCM/外扩SRAM区域归还给 MALLOC 内存池
+ */
+void vPortHeapResetState(void)
+{
+    uint8_t i;
+
+    if (ucHeapReady) {
+        myfree(SRAMCCM, xBank[heapBANK_CCM].pvRegion);
+        myfree(SRAMEX, xBank[heapBANK_SRAMEX].pvRegion);
+    }
+    for (i = 0; i < heapBANK_NUM; i++) memset(&xBank[i], 0, sizeof(HeapBank_t));
+    ucHeapReady = 0;
+    xFreeBytesRemaining = 0;
+    xMinimumEverFreeBytesRemaining = 0;
+    xNumberOfSuccessfulAllocations = 0;
+    xNumberOfSuccessfulFrees = 0;
+}
@@ -0,0 +1,47 @@
+/**
+ ****************************************************************************************************
+ * @file        heap_bank.h
+ * @brief       FreeRTOS 多区域堆 (SRAMIN + CCM + 外扩SRAM) 及放置提示接口
+ ****************************************************************************************************
+ * @attention
+ *
+ * heap_bank.c 代替 heap_4.c: 与 heap_5 一样把多个不连续的内存区域串在一条按地址排序的空闲链表上,
+ * 另外按区域记账, 申请时可以指定放置提示, 只在指定区域 (及其后备区域) 中查找:
+ *   heapHINT_FAST : 内部SRAM, 不够时用外扩SRAM (pvPortMalloc 的默认提示, 内核对象/队列)
+ *   heapHINT_CCM  : CCM, 不够时依次用内部SRAM、外扩SRAM (只由CPU访问的数据, 如任务栈;
+ *                   CCM 不能被DMA访问, 不要放DMA缓冲区)
+ *   heapHINT_BULK : 外扩SRAM, 不够时用内部SRAM (大缓冲区, 不常访问的数据)
+ * 提示再或上 heapHINT_STRICT 表示不使用后备区域.
+ *
+ * 区域来源:
+ *   内部SRAM: 静态数组 ucHeap[configTOTAL_HEAP_SIZE]
+ *   CCM / 外扩SRAM: 第一次申请时分别从 middleware/MALLOC 的 SRAMCCM / SRAMEX 内存池申请
+ *                   configHEAP_CCM_SIZE / configHEAP_EXT_SIZE 字节 (内存池需已初始化, 否则该区域不启用)
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __HEAP_BANK_H
+#define __HEAP_BANK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 区域编号 (按地址从低到高) */
+#define heapBANK_CCM            0                                           /* CCM, 0x10000000 */
+#define heapBANK_SRAMIN         1                                           /* 内部SRAM, 0x20000000 */
+#define heapBANK_SRAMEX         2                                           /* 外扩SRAM, 0x68000000 */
+#define heapBANK_NUM            3
+
+/* 放置提示 */
+#define heapHINT_FAST           0x00                                        /* 内部SRAM -> 外扩SRAM */
+#define heapHINT_CCM            0x01                                        /* CCM -> 内部SRAM -> 外扩SRAM */
+#define heapHINT_BULK           0x02                                        /* 外扩SRAM -> 内部SRAM */
+#define heapHINT_STRICT         0x80                                        /* 只用首选区域 */
+
+void *pvPortMallocHint(size_t xWantedSize, uint8_t ucHint);
+size_t xPortGetFreeHeapSizeBank(uint8_t ucBank);
+size_t xPortGetMinimumEverFreeHeapSizeBank(uint8_t ucBank);
+size_t xPortGetHeapSizeBank(uint8_t ucBank);
+
+#endif
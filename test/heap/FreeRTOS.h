@@ -0,0 +1,65 @@
+/**
+ ****************************************************************************************************
+ * @file        FreeRTOS.h
+ * @brief       主机编译 FreeRTOS heap_*.c 用的最小替身 (只供 test/heap 下的程序使用)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 单线程重放, 临界区/挂起调度器为空操作; 堆大小由 REPLAY_HEAP_SIZE 决定 (与 mymalloc 比较时相同).
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+
+#ifndef REPLAY_HEAP_SIZE
+#define REPLAY_HEAP_SIZE                    (256 * 1024)
+#endif
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdFALSE                             0
+#define pdTRUE                              1
+#define configSUPPORT_DYNAMIC_ALLOCATION    1
+#define configTOTAL_HEAP_SIZE               REPLAY_HEAP_SIZE
+#define configHEAP_CCM_SIZE                 0                               /* heap_bank 只用一个区域, 与其它堆容量相同 */
+#define configHEAP_EXT_SIZE                 0
+#define configHEAP_CLEAR_MEMORY_ON_FREE     0
+#define configUSE_MALLOC_FAILED_HOOK        0
+#define configENABLE_HEAP_PROTECTOR         0
+#define configAPPLICATION_ALLOCATED_HEAP     0
+#define portBYTE_ALIGNMENT                  8
+#define portBYTE_ALIGNMENT_MASK             0x0007
+#define portPOINTER_SIZE_TYPE               uintptr_t
+#define portMAX_DELAY                       (~(size_t)0)
+#define PRIVILEGED_DATA
+#define PRIVILEGED_FUNCTION
+#define configASSERT(x)                     assert(x)
+#define mtCOVERAGE_TEST_MARKER()
+#define traceMALLOC(pvAddress, uiSize)
+#define traceFREE(pvAddress, uiSize)
+
+typedef struct HeapRegion
+{
+    uint8_t *pucStartAddress;
+    size_t xSizeInBytes;
+} HeapRegion_t;
+
+typedef struct xHeapStats
+{
+    size_t xAvailableHeapSpaceInBytes;
+    size_t xSizeOfLargestFreeBlockInBytes;
+    size_t xSizeOfSmallestFreeBlockInBytes;
+    size_t xNumberOfFreeBlocks;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+} HeapStats_t;
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ ****************************************************************************************************
+ * @file        heap2_host.c
+ * @brief       重放程序适配层: FreeRTOS heap_2 (按大小排序的单链表, 最佳适配, 不合并)
+ ****************************************************************************************************
+ */
+
+#include "heap_host.h"
+#define HEAP_NAME heap2
+#include "../../os/FreeRTOS/portable/MemMang/heap_2.c"
+
+static uint32_t heap2_scan(size_t size)
+{
+    BlockLink_t *pxBlock;
+    uint32_t n = 0;
+    size_t wanted = (size + xHeapStructSize + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+
+    if (xHeapHasBeenInitialised == pdFALSE || wanted > xFreeBytesRemaining) return 0;
+    for (pxBlock = xStart.pxNextFreeBlock; ; pxBlock = pxBlock->pxNextFreeBlock) {
+        n++;
+        if (pxBlock->xBlockSize >= wanted || pxBlock->pxNextFreeBlock == NULL) break;
+    }
+    return n;
+}
+
+/* 链表按大小排序, 最大的空闲块是结束标记 xEnd 之前的那一个 */
+static size_t heap2_largest(void)
+{
+    BlockLink_t *pxBlock;
+    size_t largest = 0;
+
+    if (xHeapHasBeenInitialised == pdFALSE) return configADJUSTED_HEAP_SIZE;
+    for (pxBlock = xStart.pxNextFreeBlock; pxBlock != &xEnd; pxBlock = pxBlock->pxNextFreeBlock) {
+        largest = pxBlock->xBlockSize;
+    }
+    return largest;
+}
+
+const heap_ops_t heap2_ops = {
+    "heap_2", vPortHeapResetState, pvPortMalloc, vPortFree, heap2_scan, heap2_largest, xPortGetFreeHeapSize,
+};
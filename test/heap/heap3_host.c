@@ -0,0 +1,25 @@
+/**
+ ****************************************************************************************************
+ * @file        heap3_host.c
+ * @brief       重放程序适配层: FreeRTOS heap_3 (包装C库 malloc/free, 此处为主机C库, 只作延时参考)
+ ****************************************************************************************************
+ */
+
+#include "heap_host.h"
+#define HEAP_NAME heap3
+#include "../../os/FreeRTOS/portable/MemMang/heap_3.c"
+
+static uint32_t heap3_scan(size_t size)
+{
+    (void)size;
+    return 0;
+}
+
+static size_t heap3_zero(void)
+{
+    return 0;
+}
+
+const heap_ops_t heap3_ops = {
+    "heap_3", vPortHeapResetState, pvPortMalloc, vPortFree, heap3_scan, heap3_zero, heap3_zero,
+};
@@ -0,0 +1,43 @@
+/**
+ ****************************************************************************************************
+ * @file        heap4_host.c
+ * @brief       重放程序适配层: FreeRTOS heap_4 (按地址排序的单链表, 首次适配, 合并相邻空闲块)
+ ****************************************************************************************************
+ */
+
+#include "heap_host.h"
+#define HEAP_NAME heap4
+#include "../../os/FreeRTOS/portable/MemMang/heap_4.c"
+
+/* 与 pvPortMalloc 相同的大小换算 */
+static size_t heap4_wanted(size_t size)
+{
+    size += xHeapStructSize;
+    return (size + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+}
+
+static uint32_t heap4_scan(size_t size)
+{
+    BlockLink_t *pxBlock;
+    uint32_t n = 0;
+    size_t wanted = heap4_wanted(size);
+
+    if (pxEnd == NULL || wanted > xFreeBytesRemaining) return 0;
+    for (pxBlock = xStart.pxNextFreeBlock; ; pxBlock = pxBlock->pxNextFreeBlock) {
+        n++;
+        if (pxBlock->xBlockSize >= wanted || pxBlock->pxNextFreeBlock == NULL) break;
+    }
+    return n;
+}
+
+static size_t heap4_largest(void)
+{
+    HeapStats_t st;
+    if (pxEnd == NULL) return configTOTAL_HEAP_SIZE;
+    vPortGetHeapStats(&st);
+    return st.xSizeOfLargestFreeBlockInBytes;
+}
+
+const heap_ops_t heap4_ops = {
+    "heap_4", vPortHeapResetState, pvPortMalloc, vPortFree, heap4_scan, heap4_largest, xPortGetFreeHeapSize,
+};
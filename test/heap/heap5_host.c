@@ -0,0 +1,44 @@
+/**
+ ****************************************************************************************************
+ * @file        heap5_host.c
+ * @brief       重放程序适配层: FreeRTOS heap_5 (heap_4 的多区域版本, 此处只定义一个区域)
+ ****************************************************************************************************
+ */
+
+#include "heap_host.h"
+#define HEAP_NAME heap5
+#include "../../os/FreeRTOS/portable/MemMang/heap_5.c"
+
+static uint8_t ucRegion[REPLAY_HEAP_SIZE];
+
+static void heap5_reset(void)
+{
+    HeapRegion_t xRegions[] = {{ucRegion, sizeof(ucRegion)}, {NULL, 0}};
+    vPortHeapResetState();
+    vPortDefineHeapRegions(xRegions);
+}
+
+static uint32_t heap5_scan(size_t size)
+{
+    BlockLink_t *pxBlock;
+    uint32_t n = 0;
+    size_t wanted = (size + xHeapStructSize + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+
+    if (wanted > xFreeBytesRemaining) return 0;
+    for (pxBlock = xStart.pxNextFreeBlock; ; pxBlock = pxBlock->pxNextFreeBlock) {
+        n++;
+        if (pxBlock->xBlockSize >= wanted || pxBlock->pxNextFreeBlock == NULL) break;
+    }
+    return n;
+}
+
+static size_t heap5_largest(void)
+{
+    HeapStats_t st;
+    vPortGetHeapStats(&st);
+    return st.xSizeOfLargestFreeBlockInBytes;
+}
+
+const heap_ops_t heap5_ops = {
+    "heap_5", heap5_reset, pvPortMalloc, vPortFree, heap5_scan, heap5_largest, xPortGetFreeHeapSize,
+};
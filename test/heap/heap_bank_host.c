@@ -0,0 +1,49 @@
+/**
+ ****************************************************************************************************
+ * @file        heap_bank_host.c
+ * @brief       重放程序适配层: heap_bank (本工程的 FreeRTOS 多区域堆, 此处只启用内部SRAM区域)
+ ****************************************************************************************************
+ */
+
+#include "heap_host.h"
+#define HEAP_NAME heap_bank
+#include "../../os/FreeRTOS/portable/MemMang/heap_bank.c"
+
+/* 与 prvAllocFromBank 相同的遍历: 按提示顺序, 每个区域从链表头走到区域末尾 */
+static uint32_t heap_bank_scan(size_t size)
+{
+    const uint8_t *pucOrder = ucHintOrder[configHEAP_DEFAULT_HINT];
+    BlockLink_t *pxBlock;
+    HeapBank_t *pxBank;
+    uint32_t n = 0;
+    uint8_t i;
+    size_t wanted = (size + xHeapStructSize + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+
+    if (!ucHeapReady || wanted > xFreeBytesRemaining) return 0;
+    for (i = 0; pucOrder[i] < heapBANK_NUM; i++) {
+        pxBank = &xBank[pucOrder[i]];
+        if (pxBank->pucStart == NULL || pxBank->xFree < wanted) continue;
+        for (pxBlock = xStart.pxNextFreeBlock; pxBlock != NULL && (uint8_t *)pxBlock < pxBank->pucEnd; pxBlock = pxBlock->pxNextFreeBlock) {
+            n++;
+            if ((uint8_t *)pxBlock >= pxBank->pucStart && pxBlock->xBlockSize >= wanted) return n;
+        }
+    }
+    return n;
+}
+
+static size_t heap_bank_largest(void)
+{
+    HeapStats_t st;
+    if (!ucHeapReady) return configTOTAL_HEAP_SIZE;
+    vPortGetHeapStats(&st);
+    return st.xSizeOfLargestFreeBlockInBytes;
+}
+
+static size_t heap_bank_free(void)
+{
+    return ucHeapReady ? xPortGetFreeHeapSize() : configTOTAL_HEAP_SIZE;
+}
+
+const heap_ops_t heap_bank_ops = {
+    "heap_bank", vPortHeapResetState, pvPortMalloc, vPortFree, heap_bank_scan, heap_bank_largest, heap_bank_free,
+};
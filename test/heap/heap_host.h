@@ -0,0 +1,52 @@
+/**
+ ****************************************************************************************************
+ * @file        heap_host.h
+ * @brief       重放程序中各分配器的统一接口
+ ****************************************************************************************************
+ * @attention
+ *
+ * 每个分配器在自己的文件 (heap*_host.c / mymalloc_host.c) 中 #include 其源文件, 这样:
+ *   同名的 pvPortMalloc 等函数通过宏改名 (HEAP_NAME 前缀), 可以链接进同一个程序;
+ *   适配层能直接访问源文件内的静态空闲链表, 统计查找长度, 而不用修改分配器源码.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __HEAP_HOST_H
+#define __HEAP_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    const char *name;
+    void (*reset)(void);                        /* 恢复到初始状态 (整个堆空闲) */
+    void *(*alloc)(size_t size);
+    void (*release)(void *ptr);
+    uint32_t (*scan)(size_t size);              /* 申请 size 字节时将要访问的空闲块/链表节点数, 0 表示不可统计 */
+    size_t (*largest)(void);                    /* 最大连续空闲, 0 表示不可统计 */
+    size_t (*free_bytes)(void);                 /* 总空闲 */
+} heap_ops_t;
+
+extern const heap_ops_t heap2_ops, heap3_ops, heap4_ops, heap5_ops, heap_bank_ops, mymalloc_ops, mymalloc_cache_ops;
+
+/* 给 FreeRTOS 堆的公开函数加前缀, 在 #include heap_x.c 之前定义 HEAP_NAME */
+#define HEAP_CAT2(a, b)                     a##_##b
+#define HEAP_CAT(a, b)                      HEAP_CAT2(a, b)
+#define pvPortMalloc                        HEAP_CAT(HEAP_NAME, pvPortMalloc)
+#define pvPortMallocHint                    HEAP_CAT(HEAP_NAME, pvPortMallocHint)
+#define pvPortCalloc                        HEAP_CAT(HEAP_NAME, pvPortCalloc)
+#define vPortFree                           HEAP_CAT(HEAP_NAME, vPortFree)
+#define xPortGetFreeHeapSize                HEAP_CAT(HEAP_NAME, xPortGetFreeHeapSize)
+#define xPortGetMinimumEverFreeHeapSize     HEAP_CAT(HEAP_NAME, xPortGetMinimumEverFreeHeapSize)
+#define xPortResetHeapMinimumEverFreeHeapSize HEAP_CAT(HEAP_NAME, xPortResetHeapMinimumEverFreeHeapSize)
+#define xPortGetFreeHeapSizeBank            HEAP_CAT(HEAP_NAME, xPortGetFreeHeapSizeBank)
+#define xPortGetMinimumEverFreeHeapSizeBank HEAP_CAT(HEAP_NAME, xPortGetMinimumEverFreeHeapSizeBank)
+#define xPortGetHeapSizeBank                HEAP_CAT(HEAP_NAME, xPortGetHeapSizeBank)
+#define vPortInitialiseBlocks               HEAP_CAT(HEAP_NAME, vPortInitialiseBlocks)
+#define vPortGetHeapStats                   HEAP_CAT(HEAP_NAME, vPortGetHeapStats)
+#define vPortDefineHeapRegions              HEAP_CAT(HEAP_NAME, vPortDefineHeapRegions)
+#define vPortHeapResetState                 HEAP_CAT(HEAP_NAME, vPortHeapResetState)
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ ****************************************************************************************************
+ * @file        mymalloc_host.c
+ * @brief       重放程序适配层: middleware/MALLOC (mymalloc, 两级位图空闲链表)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 使用 SRAMEX 内存池, 先占掉多余部分, 使可用空间与 FreeRTOS 堆相同 (REPLAY_HEAP_SIZE).
+ * 两个版本: 不经过每任务缓存 (只测内存池本身) / 开启每任务缓存 (与设备默认配置相同).
+ * 查找长度: 与 mem_tlsf_find 相同, 位图命中 或 请求所在级别链表的最大段够用 均计1 (查找为 O(1)).
+ *
+ ****************************************************************************************************
+ */
+
+#include "heap_host.h"
+#include "FreeRTOS.h"
+#include "../../middleware/MALLOC/mem_tlsf.c"
+#include "../../middleware/MALLOC/malloc.c"
+
+#define MYMALLOC_BANK       SRAMEX
+
+static void *mymalloc_filler;
+
+static void mymalloc_reset(void)
+{
+    my_mem_cache_flush();
+    my_mem_init(MYMALLOC_BANK);
+    mymalloc_filler = mymalloc(MYMALLOC_BANK, MEM3_MAX_SIZE - REPLAY_HEAP_SIZE);
+}
+
+static void mymalloc_reset_nocache(void)
+{
+    my_mem_cache_enable(0);
+    mymalloc_reset();
+}
+
+static void mymalloc_reset_cache(void)
+{
+    my_mem_cache_enable(1);
+    mymalloc_reset();
+}
+
+static void *mymalloc_alloc(size_t size)
+{
+    return mymalloc(MYMALLOC_BANK, (uint32_t)size);
+}
+
+static void mymalloc_release(void *ptr)
+{
+    myfree(MYMALLOC_BANK, ptr);
+}
+
+static uint32_t mymalloc_scan(size_t size)
+{
+    mem_tlsf_t *t = &memtlsf[MYMALLOC_BANK];
+    uint32_t nmemb = (uint32_t)((size + MEM3_BLOCK_SIZE - 1) / MEM3_BLOCK_SIZE);
+
+    if (nmemb == 0 || nmemb > t->nblocks - t->used) return 0;
+    return 1;
+}
+
+static size_t mymalloc_largest(void)
+{
+    return mem_tlsf_largest(&memtlsf[MYMALLOC_BANK]) * MEM3_BLOCK_SIZE;
+}
+
+static size_t mymalloc_free(void)
+{
+    return (memtlsf[MYMALLOC_BANK].nblocks - memtlsf[MYMALLOC_BANK].used) * MEM3_BLOCK_SIZE;
+}
+
+const heap_ops_t mymalloc_ops = {
+    "mymalloc", mymalloc_reset_nocache, mymalloc_alloc, mymalloc_release, mymalloc_scan, mymalloc_largest, mymalloc_free,
+};
+
+const heap_ops_t mymalloc_cache_ops = {
+    "mymalloc+cache", mymalloc_reset_cache, mymalloc_alloc, mymalloc_release, mymalloc_scan, mymalloc_largest, mymalloc_free,
+};
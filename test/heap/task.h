@@ -0,0 +1,23 @@
+/**
+ ****************************************************************************************************
+ * @file        task.h
+ * @brief       主机编译 FreeRTOS heap_*.c 用的最小替身: 单线程, 临界区与挂起/恢复调度器为空操作
+ ****************************************************************************************************
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+static inline void vTaskSuspendAll(void)
+{
+}
+
+static inline BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+#endif
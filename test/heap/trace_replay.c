@@ -0,0 +1,387 @@
+/**
+ ****************************************************************************************************
+ * @file        trace_replay.c
+ * @brief       分配器重放基准 (主机编译): mymalloc 与 FreeRTOS heap_2/3/4/5/heap_bank 重放同一申请/释放序列
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译 (在仓库根目录):
+ *   gcc -O2 -pthread -DMEM_HOST_BUILD -Itest/heap -Imiddleware/MALLOC -Ios/FreeRTOS/portable/MemMang \
+ *       test/heap/trace_replay.c test/heap/mymalloc_host.c test/heap/heap2_host.c test/heap/heap3_host.c \
+ *       test/heap/heap4_host.c test/heap/heap5_host.c test/heap/heap_bank_host.c test/malloc/dma_stub.c \
+ *       -o trace_replay
+ *   (加 -DREPLAY_HEAP_SIZE=字节数 改变各分配器的容量, 默认256KB)
+ *
+ * 运行:
+ *   ./trace_replay                     内置合成序列 mixed
+ *   ./trace_replay -s fifo|burst|mixed 指定合成序列, -n 事件数
+ *   ./trace_replay [-h 堆编号] uart.log 重放设备采集的记录 (mem_tag.h 中 MEM_TRACE_ENABLE /
+ *                                      FreeRTOSConfig.h 中 configHEAP_TRACE 置1, 串口日志原样保存即可;
+ *                                      -h 只取某个堆的记录, 默认全部合并到一个堆中重放)
+ *
+ * 输出:
+ *   各分配器申请/释放耗时的分位数 (ns, 已扣除计时开销; 主机耗时只用于相对比较),
+ *   申请失败次数, 每次申请访问的空闲块数 (平均/最坏), 以及随时间变化的碎片率
+ *   (1 - 最大连续空闲 / 总空闲, 千分比).
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "heap_host.h"
+#include "FreeRTOS.h"
+
+#define REPLAY_EVENTS       200000                                          /* 合成序列默认事件数 */
+#define REPLAY_FRAG_POINTS  10                                              /* 碎片率采样点数 */
+#define REPLAY_MAX_IDS      (1 << 16)                                       /* 同时存活的对象上限 */
+
+/* 一条记录: 申请 (对象已存活时表示重新分配) 或 释放 */
+typedef struct
+{
+    uint8_t op;                                                             /* 'm' / 'f' */
+    uint32_t id;
+    uint32_t size;
+} replay_op_t;
+
+/* 单个分配器的结果 */
+typedef struct
+{
+    uint32_t allocs, fails, frees;
+    uint32_t scan_max;
+    uint64_t scan_sum;
+    uint32_t *lat_alloc, *lat_free;                                         /* 每次调用耗时 (ns) */
+    uint32_t frag[REPLAY_FRAG_POINTS];                                      /* 各采样点碎片率 (‰), 0xFFFFFFFF 表示不可统计 */
+    uint32_t frag_max;
+} replay_result_t;
+
+static const heap_ops_t *g_heaps[] = {
+    &mymalloc_ops, &mymalloc_cache_ops, &heap_bank_ops, &heap4_ops, &heap5_ops, &heap2_ops, &heap3_ops,
+};
+#define REPLAY_HEAPS        (sizeof(g_heaps) / sizeof(g_heaps[0]))
+
+static replay_op_t *g_ops;
+static uint32_t g_nops, g_cap, g_nids;
+static void *g_live[REPLAY_MAX_IDS];
+static uint32_t g_rng = 12345;
+static uint32_t g_timer_cost;
+
+static uint32_t rnd(void)
+{
+    g_rng = g_rng * 1664525 + 1013904223;
+    return g_rng >> 8;
+}
+
+static void push(uint8_t op, uint32_t id, uint32_t size)
+{
+    if (g_nops == g_cap) {
+        g_cap = g_cap ? g_cap * 2 : 4096;
+        g_ops = realloc(g_ops, g_cap * sizeof(replay_op_t));
+    }
+    g_ops[g_nops].op = op;
+    g_ops[g_nops].id = id;
+    g_ops[g_nops].size = size;
+    g_nops++;
+    if (id + 1 > g_nids) g_nids = id + 1;
+}
+
+/* ==================== 合成序列 ==================== */
+
+/* mixed: 32B~512B 为主的小对象 (1/8 到 4KB), 约10%长期驻留, 另有周期性的 32KB 大缓冲 */
+static void gen_mixed(uint32_t events)
+{
+    static uint32_t death[256];
+    static uint8_t live[256];
+    uint32_t t, k;
+
+    memset(live, 0, sizeof(live));
+    for (t = 1; t <= events; t++) {
+        k = rnd() % 255;
+        if (live[k] && death[k] <= t) {
+            push('f', k, 0);
+            live[k] = 0;
+        } else if (!live[k]) {
+            push('m', k, (rnd() % 8 == 0) ? 512 + rnd() % 3584 : 32 + rnd() % 480);
+            death[k] = t + ((rnd() % 10 == 0) ? 20000 + rnd() % 200000 : rnd() % 4000);
+            live[k] = 1;
+        }
+        if (t % 5000 == 0) push('m', 255, 32 * 1024);                       /* 大缓冲, 持有1000个事件 */
+        if (t % 5000 == 1000) push('f', 255, 0);
+    }
+    for (k = 0; k < 256; k++) if (live[k]) push('f', k, 0);
+}
+
+/* fifo: 消息队列, 64B~1KB 的消息按申请顺序释放, 队列深度在 32~256 之间变化 */
+static void gen_fifo(uint32_t events)
+{
+    uint32_t t, head = 0, tail = 0, depth = 64;
+
+    for (t = 0; t < events; t++) {
+        if (t % 10000 == 0) depth = 32 + rnd() % 224;
+        if (head - tail < depth) push('m', head++ % 1024, 64 + rnd() % 960);
+        else push('f', tail++ % 1024, 0);
+    }
+    while (tail != head) push('f', tail++ % 1024, 0);
+}
+
+/* burst: 突发申请到约80%占用, 再随机释放一半, 反复进行 (如网络包/文件缓冲) */
+static void gen_burst(uint32_t events)
+{
+    static uint32_t size[4096];
+    uint32_t t = 0, k, used = 0;
+
+    memset(size, 0, sizeof(size));
+    while (t < events) {
+        for (k = 0; k < 4096 && used < REPLAY_HEAP_SIZE * 8 / 10 && t < events; k++) {
+            if (size[k]) continue;
+            size[k] = 16 + rnd() % ((rnd() % 4) ? 256 : 2048);
+            push('m', k, size[k]);
+            used += size[k] + 16;
+            t++;
+        }
+        for (k = 0; k < 4096 && t < events; k++) {
+            if (size[k] && rnd() % 2) {
+                push('f', k, 0);
+                used -= size[k] + 16;
+                size[k] = 0;
+                t++;
+            }
+        }
+    }
+    for (k = 0; k < 4096; k++) if (size[k]) push('f', k, 0);
+}
+
+/* ==================== 设备记录 ==================== */
+
+/* 地址 -> 对象编号 (开放寻址) */
+static uint64_t g_key[REPLAY_MAX_IDS * 2];
+static uint32_t g_val[REPLAY_MAX_IDS * 2];
+static uint32_t g_free_ids[REPLAY_MAX_IDS], g_nfree_ids;
+
+static uint32_t *lookup(uint64_t key, uint8_t create)
+{
+    uint32_t i = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 47);
+    while (g_key[i] && g_key[i] != key) i = (i + 1) & (REPLAY_MAX_IDS * 2 - 1);
+    if (g_key[i] == 0) {
+        if (!create) return NULL;
+        g_key[i] = key;
+        g_val[i] = 0xFFFFFFFF;
+    }
+    return &g_val[i];
+}
+
+static void forget(uint64_t key)
+{
+    uint32_t i, j, h;
+    i = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 47);
+    while (g_key[i] != key) i = (i + 1) & (REPLAY_MAX_IDS * 2 - 1);
+    g_key[i] = 0;
+    for (j = (i + 1) & (REPLAY_MAX_IDS * 2 - 1); g_key[j]; j = (j + 1) & (REPLAY_MAX_IDS * 2 - 1)) {
+        h = (uint32_t)((g_key[j] * 0x9E3779B97F4A7C15ULL) >> 47);
+        if (((j - h) & (REPLAY_MAX_IDS * 2 - 1)) >= ((j - i) & (REPLAY_MAX_IDS * 2 - 1))) {
+            g_key[i] = g_key[j];
+            g_val[i] = g_val[j];
+            g_key[j] = 0;
+            i = j;
+        }
+    }
+}
+
+static int load_trace(const char *path, int heap)
+{
+    FILE *f = fopen(path, "r");
+    char line[256], op;
+    unsigned int h, addr, size;
+    uint32_t *id, next = 0, skipped = 0;
+    uint64_t key;
+
+    if (f == NULL) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, " @%c %u %x %u", &op, &h, &addr, &size) != 4) continue;
+        if (heap >= 0 && (int)h != heap) continue;
+        key = ((uint64_t)(h + 1) << 32) | addr;
+        if (op == 'm') {
+            id = lookup(key, 1);
+            if (*id == 0xFFFFFFFF) {
+                if (g_nfree_ids) *id = g_free_ids[--g_nfree_ids];
+                else if (next < REPLAY_MAX_IDS) *id = next++;
+                else {
+                    forget(key);
+                    skipped++;
+                    continue;
+                }
+            }
+            push('m', *id, size);
+        } else if (op == 'f') {
+            id = lookup(key, 0);
+            if (id == NULL) {                                               /* 采集开始前申请的内存 */
+                skipped++;
+                continue;
+            }
+            push('f', *id, 0);
+            g_free_ids[g_nfree_ids++] = *id;
+            forget(key);
+        }
+    }
+    fclose(f);
+    printf("读入 %u 条记录, 忽略 %u 条 (采集前申请的内存的释放 / 存活对象过多)\n", g_nops, skipped);
+    return 0;
+}
+
+/* ==================== 重放 ==================== */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t elapsed(uint64_t t0)
+{
+    uint64_t d = now_ns() - t0;
+    return d > g_timer_cost ? (uint32_t)(d - g_timer_cost) : 0;
+}
+
+static void calibrate(void)
+{
+    uint32_t i;
+    uint64_t t0, d, best = ~0ULL;
+    for (i = 0; i < 10000; i++) {
+        t0 = now_ns();
+        d = now_ns() - t0;
+        if (d < best) best = d;
+    }
+    g_timer_cost = (uint32_t)best;
+}
+
+static uint32_t frag_now(const heap_ops_t *hp)
+{
+    size_t free_bytes = hp->free_bytes(), largest = hp->largest();
+    if (largest == 0 || free_bytes == 0) return 0xFFFFFFFF;
+    return (uint32_t)(1000 - (uint64_t)largest * 1000 / free_bytes);
+}
+
+static void replay(const heap_ops_t *hp, replay_result_t *r)
+{
+    uint32_t i, s, point = 0, nalloc = 0, nfree = 0;
+    uint64_t t0;
+    replay_op_t *o;
+
+    memset(r, 0, sizeof(*r));
+    r->lat_alloc = malloc(g_nops * sizeof(uint32_t));
+    r->lat_free = malloc(g_nops * sizeof(uint32_t));
+    memset(g_live, 0, g_nids * sizeof(void *));
+    hp->reset();
+
+    for (i = 0; i < g_nops; i++) {
+        o = &g_ops[i];
+        if (g_live[o->id]) {                                                /* 释放, 或重新分配时先释放旧的 */
+            t0 = now_ns();
+            hp->release(g_live[o->id]);
+            r->lat_free[nfree++] = elapsed(t0);
+            g_live[o->id] = NULL;
+            r->frees++;
+        }
+        if (o->op == 'm') {
+            s = hp->scan(o->size);
+            r->scan_sum += s;
+            if (s > r->scan_max) r->scan_max = s;
+            t0 = now_ns();
+            g_live[o->id] = hp->alloc(o->size);
+            r->lat_alloc[nalloc++] = elapsed(t0);
+            r->allocs++;
+            if (g_live[o->id] == NULL) r->fails++;
+            else memset(g_live[o->id], 0x5A, o->size < 16 ? o->size : 16); /* 写入开头, 暴露越界的块头 */
+        }
+        if ((uint64_t)(i + 1) * REPLAY_FRAG_POINTS / g_nops > point) {
+            r->frag[point] = frag_now(hp);
+            if (r->frag[point] != 0xFFFFFFFF && r->frag[point] > r->frag_max) r->frag_max = r->frag[point];
+            point++;
+        }
+    }
+    for (i = 0; i < g_nids; i++) if (g_live[i]) hp->release(g_live[i]);
+    r->allocs = nalloc;
+    r->frees = nfree;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t pct(uint32_t *v, uint32_t n, uint32_t permille)
+{
+    if (n == 0) return 0;
+    return v[(uint64_t)(n - 1) * permille / 1000];
+}
+
+int main(int argc, char **argv)
+{
+    static replay_result_t res[REPLAY_HEAPS];
+    const char *kind = "mixed", *path = NULL;
+    uint32_t events = REPLAY_EVENTS, i, k;
+    int heap = -1;
+
+    for (i = 1; i < (uint32_t)argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < (uint32_t)argc) kind = argv[++i];
+        else if (!strcmp(argv[i], "-n") && i + 1 < (uint32_t)argc) events = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-h") && i + 1 < (uint32_t)argc) heap = atoi(argv[++i]);
+        else path = argv[i];
+    }
+
+    if (path) {
+        if (load_trace(path, heap)) {
+            printf("无法打开 %s\n", path);
+            return 1;
+        }
+    } else if (!strcmp(kind, "fifo")) {
+        gen_fifo(events);
+    } else if (!strcmp(kind, "burst")) {
+        gen_burst(events);
+    } else {
+        kind = "mixed";
+        gen_mixed(events);
+    }
+    printf("序列: %s, %u 条操作, 堆容量 %u KB\n\n", path ? path : kind, g_nops, REPLAY_HEAP_SIZE / 1024);
+
+    calibrate();
+    for (k = 0; k < REPLAY_HEAPS; k++) {
+        replay(g_heaps[k], &res[k]);
+        qsort(res[k].lat_alloc, res[k].allocs, sizeof(uint32_t), cmp_u32);
+        qsort(res[k].lat_free, res[k].frees, sizeof(uint32_t), cmp_u32);
+    }
+
+    printf("%-15s %8s %6s | %-33s | %-22s | %s\n", "", "", "", "     申请耗时 (ns)", "   释放耗时 (ns)", "查找长度");
+    printf("%-15s %8s %6s | %6s %6s %6s %6s %6s | %6s %6s %8s | %6s %6s\n", "分配器", "申请", "失败",
+           "p50", "p90", "p99", "p99.9", "max", "p50", "p99", "max", "平均", "最坏");
+    for (k = 0; k < REPLAY_HEAPS; k++) {
+        replay_result_t *r = &res[k];
+        printf("%-15s %8u %6u | %6u %6u %6u %6u %6u | %6u %6u %8u | ", g_heaps[k]->name, r->allocs, r->fails,
+               pct(r->lat_alloc, r->allocs, 500), pct(r->lat_alloc, r->allocs, 900), pct(r->lat_alloc, r->allocs, 990),
+               pct(r->lat_alloc, r->allocs, 999), pct(r->lat_alloc, r->allocs, 1000),
+               pct(r->lat_free, r->frees, 500), pct(r->lat_free, r->frees, 990), pct(r->lat_free, r->frees, 1000));
+        if (r->scan_max) printf("%6.1f %6u\n", r->allocs ? (double)r->scan_sum / r->allocs : 0.0, r->scan_max);
+        else printf("%6s %6s\n", "-", "-");
+    }
+
+    printf("\n碎片率 (‰, 1 - 最大连续空闲/总空闲) 随进度变化:\n%-15s", "进度");
+    for (i = 0; i < REPLAY_FRAG_POINTS; i++) printf(" %5u%%", (i + 1) * 100 / REPLAY_FRAG_POINTS);
+    printf("   最大\n");
+    for (k = 0; k < REPLAY_HEAPS; k++) {
+        if (res[k].frag[0] == 0xFFFFFFFF) continue;
+        printf("%-15s", g_heaps[k]->name);
+        for (i = 0; i < REPLAY_FRAG_POINTS; i++) printf(" %6u", res[k].frag[i]);
+        printf(" %6u\n", res[k].frag_max);
+    }
+
+    for (k = 0; k < REPLAY_HEAPS; k++) {
+        free(res[k].lat_alloc);
+        free(res[k].lat_free);
+    }
+    free(g_ops);
+    return 0;
+}
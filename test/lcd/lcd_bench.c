@@ -0,0 +1,550 @@
+/**
+ ****************************************************************************************************
+ * @file        lcd_bench.c
+ * @brief       LCD 填充/写入 像素速率测试 (板上运行): 逐行设光标 / 单窗口CPU / 单窗口DMA 对比
+ ****************************************************************************************************
+ * @attention
+ *
+ * 使用: 把本文件加入工程, 在 lcd_init / dma_m2m_init / my_mem_init 之后 (任务中或调度器启动前)
+ *       调用 lcd_bench(), 结果经串口1输出, 结束时清屏.
+ *
+ * 每种矩形重复 LCD_BENCH_ROUNDS 次, 用 DWT 周期计数器计时, 换算为 百万像素/秒 (HCLK = SystemCoreClock).
+ *   fill  (纯色填充):
+ *     row       : 原实现, 每行 lcd_set_cursor + 写GRAM, CPU逐像素写
+ *     win       : lcd_set_window 一次, CPU连续写全部像素
+ *     dma       : lcd_fill (单窗口 + DMA), 从启动到完成
+ *     dma(cpu)  : lcd_fill_async 调用者自己花的时间 (设置窗口 + 启动), 其余时间CPU可以做别的事
+ *   blit  (lcd_color_fill, 颜色数组在外扩SRAM):
+ *     row / win / dma / dma(cpu) 含义同上
+ *   点    : lcd_draw_point 逐点, 作参照
+ *   清屏  : lcd_clear
+ *   文字 (非叠加, 每行 LCD_BENCH_TEXT 个字符, 按字形像素数计):
+ *     point     : 原实现, 每个点 lcd_draw_point
+ *     char      : lcd_show_char 逐字符 (每字符一个窗口)
+ *     string    : lcd_show_string (每 LCD_GLYPH_RUN_MAX 个字符一个窗口)
+ *     +cache    : 同上, 字形缓存开启 (先画一遍预热)
+ *   图形 (us/次): point 为原实现 (逐点 lcd_draw_point; 实心圆逐行 lcd_draw_hline), span 为现在的实现
+ *     (水平/垂直线一个窗口, 斜线/圆按段, 实心圆按行段和矩形), 画完读回端点/圆心校验;
+ *     line 为 4:1 的缓斜线 (段较长), line45 为 45° 斜线 (每段1个点, 与圆接近对角线的部分相同)
+ *   帧缓冲刷新 (lcd_fb_enable 成功时): 屏幕的 1%~100% 有改动时 lcd_fb_flush 的耗时 (us), 对比整屏直接填充
+ *     band      : 改动是一条整行宽的带 (一个连续矩形)
+ *     tiles     : 改动是分散的 32x32 方块 (脏矩形合并后的个数见 rects)
+ *     cpu / dma : g_lcd_fb.dma = 0 / 1
+ *   帧同步: 64x64 方块每帧右移4点, 共 LCD_BENCH_FRAMES 帧, 单/双缓冲 × 不同步/定时器vblank,
+ *     输出平均帧率、错过期限的帧数 (共晚了多少个vblank)、lcd_frame_present 最长等待时间 (us);
+ *     双缓冲内存不足时退回单缓冲, 在缓冲一栏标 "*"
+ * 每项完成后读回矩形四角校验, 出错时在该项后面标 "!".
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "../../driver/LCD/lcd.h"
+#include "../../driver/LCD/lcd_fb.h"
+#include "../../middleware/MALLOC/malloc.h"
+#include "./lcd_bench.h"
+
+#define LCD_BENCH_ROUNDS        4
+#define LCD_BENCH_TEXT          "V=3.30 I=1.25"
+#define LCD_BENCH_FRAMES        120
+
+/* 字库 (lcdfont.h 中定义, 由 lcd.c 包含) */
+extern const unsigned char asc2_1206[95][12];
+extern const unsigned char asc2_1608[95][16];
+extern const unsigned char asc2_2412[95][36];
+extern const unsigned char asc2_3216[95][128];
+
+static const uint16_t g_rects[][2] = {{8, 8}, {16, 16}, {32, 32}, {100, 100}, {240, 240}};
+
+static void bench_dwt_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* 周期数 -> 百万像素/秒 (x100, 保留两位小数) */
+static uint32_t bench_rate(uint32_t pixels, uint32_t cycles)
+{
+    if (cycles == 0) return 0;
+    return (uint32_t)((uint64_t)pixels * LCD_BENCH_ROUNDS * (SystemCoreClock / 10000) / cycles);
+}
+
+/* 周期数 -> us */
+static uint32_t bench_us(uint32_t cycles)
+{
+    return (uint32_t)((uint64_t)cycles * 1000000 / SystemCoreClock / LCD_BENCH_ROUNDS);
+}
+
+static void bench_print(uint32_t v, uint8_t bad)
+{
+    printf(" %5u.%02u%c", v / 100, v % 100, bad ? '!' : ' ');
+}
+
+/* 原实现: 每行设置一次光标 */
+static void bench_row_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color)
+{
+    uint16_t i, j;
+
+    for (i = sy; i <= ey; i++) {
+        lcd_set_cursor(sx, i);
+        lcd_write_ram_prepare();
+        for (j = sx; j <= ex; j++) LCD->LCD_RAM = color;
+    }
+}
+
+static void bench_row_blit(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color)
+{
+    uint16_t i, j;
+
+    for (i = sy; i <= ey; i++) {
+        lcd_set_cursor(sx, i);
+        lcd_write_ram_prepare();
+        for (j = sx; j <= ex; j++) LCD->LCD_RAM = *color++;
+    }
+}
+
+/* 单窗口, CPU连续写 */
+static void bench_win_fill(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, uint16_t color)
+{
+    uint32_t n = (uint32_t)(ex - sx + 1) * (ey - sy + 1);
+
+    lcd_set_window(sx, sy, ex - sx + 1, ey - sy + 1);
+    lcd_write_ram_prepare();
+    while (n--) LCD->LCD_RAM = color;
+}
+
+static void bench_win_blit(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color)
+{
+    uint32_t n = (uint32_t)(ex - sx + 1) * (ey - sy + 1);
+
+    lcd_set_window(sx, sy, ex - sx + 1, ey - sy + 1);
+    lcd_write_ram_prepare();
+    while (n--) LCD->LCD_RAM = *color++;
+}
+
+/* 原实现: 逐点画字符 (列优先点阵) */
+static void bench_point_char(uint16_t x, uint16_t y, char chr, uint8_t size, uint16_t color)
+{
+    const uint8_t *pfont;
+    uint16_t r, c, cb = (size + 7) / 8;
+
+    switch (size) {
+        case 12: pfont = asc2_1206[chr - ' ']; break;
+        case 16: pfont = asc2_1608[chr - ' ']; break;
+        case 24: pfont = asc2_2412[chr - ' ']; break;
+        default: pfont = asc2_3216[chr - ' ']; break;
+    }
+
+    for (c = 0; c < size / 2; c++) {
+        for (r = 0; r < size; r++) {
+            lcd_draw_point(x + c, y + r, (pfont[c * cb + r / 8] & (0x80 >> (r % 8))) ? color : g_back_color);
+        }
+    }
+}
+
+/* 原实现: 逐点画线 */
+static void bench_point_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t color)
+{
+    int dx = x2 - x1, dy = y2 - y1, incx = dx < 0 ? -1 : 1, incy = dy < 0 ? -1 : 1, err, n;
+    int x = x1, y = y1;
+
+    dx = dx < 0 ? -dx : dx;
+    dy = dy < 0 ? -dy : dy;
+    if (dx >= dy) {
+        for (err = dx / 2, n = dx; n >= 0; n--, x += incx) {
+            lcd_draw_point(x, y, color);
+            if ((err -= dy) < 0) y += incy, err += dx;
+        }
+    } else {
+        for (err = dy / 2, n = dy; n >= 0; n--, y += incy) {
+            lcd_draw_point(x, y, color);
+            if ((err -= dx) < 0) x += incx, err += dy;
+        }
+    }
+}
+
+/* 原实现: 逐点画圆 */
+static void bench_point_circle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color)
+{
+    int a = 0, b = r, di = 3 - (r << 1);
+
+    while (a <= b) {
+        lcd_draw_point(x0 + a, y0 - b, color);
+        lcd_draw_point(x0 + b, y0 - a, color);
+        lcd_draw_point(x0 + b, y0 + a, color);
+        lcd_draw_point(x0 + a, y0 + b, color);
+        lcd_draw_point(x0 - a, y0 + b, color);
+        lcd_draw_point(x0 - b, y0 + a, color);
+        lcd_draw_point(x0 - a, y0 - b, color);
+        lcd_draw_point(x0 - b, y0 - a, color);
+        a++;
+        if (di < 0) di += 4 * a + 6;
+        else di += 10 + 4 * (a - b--);
+    }
+}
+
+/* 原实现: 实心圆逐行 */
+static void bench_row_circle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color)
+{
+    int y, w = r;
+
+    for (y = 0; y <= r; y++) {
+        while (w > 0 && w * w + y * y > r * r + r) w--;
+        lcd_draw_hline(x0 - w, y0 - y, 2 * w + 1, color);
+        if (y) lcd_draw_hline(x0 - w, y0 + y, 2 * w + 1, color);
+    }
+}
+
+/* 图形: point / span */
+static void bench_shapes(void)
+{
+    static const char *names[] = {"hline", "vline", "line", "line45", "rect", "circle", "fill"};
+    uint16_t r = (lcddev.width < lcddev.height ? lcddev.width : lcddev.height) / 2 - 8;
+    uint16_t cx = lcddev.width / 2, cy = lcddev.height / 2, l = 2 * r;
+    uint16_t x0 = cx - r, y0 = cy - r, x1 = cx + r, y1 = y0 + r / 2;
+    uint32_t i, k, t0, cyc[2];
+    uint8_t bad;
+
+    printf("%7s | %8s %8s (us, 长度/半径 %u)\r\n", "shape", "point", "span", r);
+
+    for (k = 0; k < sizeof(names) / sizeof(names[0]); k++) {
+        memset(cyc, 0, sizeof(cyc));
+        bad = 0;
+
+        for (i = 0; i < 2 * LCD_BENCH_ROUNDS; i++) {
+            uint16_t color = (i & 1) ? BLUE : RED;
+
+            t0 = DWT->CYCCNT;
+            switch (k) {
+                case 0: if (i & 1) lcd_draw_hline(x0, cy, l, color); else bench_point_line(x0, cy, x0 + l - 1, cy, color); break;
+                case 1: if (i & 1) lcd_draw_vline(cx, y0, l, color); else bench_point_line(cx, y0, cx, y0 + l - 1, color); break;
+                case 2: if (i & 1) lcd_draw_line(x0, y0, x1, y1, color); else bench_point_line(x0, y0, x1, y1, color); break;
+                case 3: if (i & 1) lcd_draw_line(x0, y0, x0 + r, y0 + r, color); else bench_point_line(x0, y0, x0 + r, y0 + r, color); break;
+                case 4:
+                    if (i & 1) lcd_draw_rectangle(x0, y0, x1, y1, color);
+                    else {
+                        bench_point_line(x0, y0, x1, y0, color);
+                        bench_point_line(x0, y0, x0, y1, color);
+                        bench_point_line(x0, y1, x1, y1, color);
+                        bench_point_line(x1, y0, x1, y1, color);
+                    }
+                    break;
+                case 5: if (i & 1) lcd_draw_circle(cx, cy, r, color); else bench_point_circle(cx, cy, r, color); break;
+                default: if (i & 1) lcd_fill_circle(cx, cy, r, color); else bench_row_circle(cx, cy, r, color); break;
+            }
+            lcd_dma_wait();
+            cyc[i & 1] += DWT->CYCCNT - t0;
+
+            if (i & 1) {
+                switch (k) {
+                    case 0: bad |= lcd_read_point(x0, cy) != color || lcd_read_point(x0 + l - 1, cy) != color; break;
+                    case 1: bad |= lcd_read_point(cx, y0) != color || lcd_read_point(cx, y0 + l - 1) != color; break;
+                    case 2:
+                    case 4: bad |= lcd_read_point(x0, y0) != color || lcd_read_point(x1, y1) != color; break;
+                    case 3: bad |= lcd_read_point(x0, y0) != color || lcd_read_point(x0 + r, y0 + r) != color; break;
+                    case 5: bad |= lcd_read_point(cx, cy - r) != color || lcd_read_point(cx + r, cy) != color; break;
+                    default: bad |= lcd_read_point(cx, cy) != color || lcd_read_point(cx, cy + r) != color; break;
+                }
+            }
+        }
+
+        printf("%7s | %8u %8u%c\r\n", names[k], bench_us(cyc[0]), bench_us(cyc[1]), bad ? '!' : ' ');
+        lcd_clear(WHITE);
+    }
+}
+
+/* 文字: 各字号 point / char / string / +cache */
+static void bench_text(void)
+{
+    static const uint8_t sizes[] = {12, 16, 24, 32};
+    const char *txt = LCD_BENCH_TEXT;
+    uint32_t i, k, r, n, t0, len = strlen(txt), cyc[4];
+    uint8_t size, cached = 0;
+
+    printf("%7s | %8s %8s %8s %8s\r\n", "text", "point", "char", "string", "+cache");
+
+    for (k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        size = sizes[k];
+        if (len * (size / 2) > lcddev.width) continue;
+        n = len * (size / 2) * size;
+        memset(cyc, 0, sizeof(cyc));
+
+        for (r = 0; r < LCD_BENCH_ROUNDS; r++) {
+            t0 = DWT->CYCCNT;
+            for (i = 0; i < len; i++) bench_point_char(i * (size / 2), 0, txt[i], size, BLUE);
+            cyc[0] += DWT->CYCCNT - t0;
+
+#if LCD_GLYPH_CACHE_NUM
+            lcd_glyph_cache_enable(0);
+#endif
+            t0 = DWT->CYCCNT;
+            for (i = 0; i < len; i++) lcd_show_char(i * (size / 2), size, txt[i], size, 0, BLUE);
+            cyc[1] += DWT->CYCCNT - t0;
+
+            t0 = DWT->CYCCNT;
+            lcd_show_string(0, size * 2, lcddev.width, size, size, (char *)txt, BLUE);
+            cyc[2] += DWT->CYCCNT - t0;
+
+#if LCD_GLYPH_CACHE_NUM
+            if (lcd_glyph_cache_enable(1) == 0) {
+                cached = 1;
+                lcd_show_string(0, size * 3, lcddev.width, size, size, (char *)txt, BLUE);  /* 预热 */
+                t0 = DWT->CYCCNT;
+                lcd_show_string(0, size * 3, lcddev.width, size, size, (char *)txt, BLUE);
+                cyc[3] += DWT->CYCCNT - t0;
+            }
+#endif
+        }
+
+        printf("%3u pt  |", size);
+        for (i = 0; i < 4; i++) {
+            if (i == 3 && !cached) printf(" %8s", "-");
+            else bench_print(bench_rate(n, cyc[i]), 0);
+        }
+        printf("\r\n");
+    }
+
+#if LCD_GLYPH_CACHE_NUM
+    lcd_glyph_cache_enable(LCD_GLYPH_CACHE_BOOT);                   /* 恢复启动时的设置 (默认关闭, 归还CCM) */
+#endif
+}
+
+/* 在帧缓冲中画出屏幕 pct% 的改动, 返回合并后的脏矩形个数 */
+static uint32_t bench_fb_damage(uint32_t pct, uint8_t tiles, uint16_t color)
+{
+    uint32_t area = (uint32_t)lcddev.width * lcddev.height * pct / 100;
+    uint32_t i, n, cols = lcddev.width / 32, rows = lcddev.height / 32;
+
+    if (!tiles) {
+        n = area / lcddev.width;
+        lcd_fill(0, 0, lcddev.width - 1, n ? n - 1 : 0, color);
+        return g_lcd_fb.ndirty;
+    }
+
+    n = area / (32 * 32);
+    if (n == 0) n = 1;
+    if (n > cols * rows) n = cols * rows;
+    for (i = 0; i < n; i++) {                                              /* 按步长分散到整个屏幕 */
+        uint32_t t = (i * 11) % (cols * rows);                             /* 11与各屏的行列数互质, 不重复 */
+        lcd_fill((t % cols) * 32, (t / cols) * 32, (t % cols) * 32 + 31, (t / cols) * 32 + 31, color);
+    }
+    return g_lcd_fb.ndirty;
+}
+
+/* 帧缓冲刷新耗时 - 改动比例 */
+static void bench_fb(void)
+{
+    static const uint8_t pcts[] = {1, 5, 10, 25, 50, 100};
+    uint32_t i, k, r, t0, cyc[5], rects = 0;
+
+    t0 = DWT->CYCCNT;                                                       /* 参照: 整屏直接填充 */
+    for (r = 0; r < LCD_BENCH_ROUNDS; r++) lcd_fill(0, 0, lcddev.width - 1, lcddev.height - 1, (r & 1) ? BLUE : RED);
+    cyc[0] = DWT->CYCCNT - t0;
+
+    if (lcd_fb_enable(1)) {
+        printf("帧缓冲: 内存不足 (%u 字节)\r\n", lcddev.width * lcddev.height * 2);
+        return;
+    }
+    lcd_fb_flush();
+
+    printf("帧缓冲刷新 (us), 整屏直接填充 %u us\r\n", bench_us(cyc[0]));
+    printf("%5s | %8s %8s | %8s %8s %6s\r\n", "pct", "band cpu", "band dma", "tile cpu", "tile dma", "rects");
+
+    for (k = 0; k < sizeof(pcts) / sizeof(pcts[0]); k++) {
+        memset(cyc, 0, sizeof(cyc));
+        for (r = 0; r < LCD_BENCH_ROUNDS; r++) {
+            for (i = 0; i < 4; i++) {
+                rects = bench_fb_damage(pcts[k], i >> 1, (r & 1) ? BLUE : RED);
+                g_lcd_fb.dma = i & 1;
+                t0 = DWT->CYCCNT;
+                lcd_fb_flush();
+                cyc[i] += DWT->CYCCNT - t0;
+            }
+        }
+        g_lcd_fb.dma = 1;
+
+        printf("%4u%% |", pcts[k]);
+        for (i = 0; i < 4; i++) {
+            printf(" %8u", bench_us(cyc[i]));
+            if (i == 1) printf(" |");
+        }
+        printf(" %6u\r\n", rects);
+    }
+
+    lcd_fb_enable(0);
+}
+
+/* 帧同步: 移动方块 */
+static void bench_frame(void)
+{
+    static const uint8_t modes[][2] = {{LCD_FB_SINGLE, LCD_VSYNC_NONE}, {LCD_FB_DOUBLE, LCD_VSYNC_NONE},
+                                       {LCD_FB_SINGLE, LCD_VSYNC_TIMER}, {LCD_FB_DOUBLE, LCD_VSYNC_TIMER}};
+    lcd_frame_stats_t st;
+    uint16_t x, y, size = 64;
+    uint32_t i, k;
+
+    y = (lcddev.height - size) / 2;
+    printf("帧同步: 方块 %ux%u, %u 帧, vblank %u Hz\r\n", size, size, LCD_BENCH_FRAMES, LCD_VSYNC_HZ);
+    printf("%7s %6s | %6s %6s %6s %9s\r\n", "buf", "vsync", "fps", "missed", "late", "wait max");
+
+    for (k = 0; k < sizeof(modes) / sizeof(modes[0]); k++) {
+        if (lcd_fb_enable(modes[k][0])) {
+            printf("帧缓冲: 内存不足\r\n");
+            break;
+        }
+        lcd_frame_init(modes[k][1], 1);
+        lcd_fill(0, 0, lcddev.width - 1, lcddev.height - 1, WHITE);
+        lcd_fb_flush();
+        lcd_frame_stats_clear();
+
+        for (i = 0, x = 0; i < LCD_BENCH_FRAMES; i++) {
+            lcd_fill(x, y, x + size - 1, y + size - 1, WHITE);
+            x = (x + 4) % (lcddev.width - size);
+            lcd_fill(x, y, x + size - 1, y + size - 1, RED);
+            lcd_frame_present();
+        }
+        lcd_frame_stats(&st);                                               /* 最后一帧可能还在等vblank, 不影响平均帧率 */
+        lcd_fb_flush();
+
+        printf("%6s%c %6s | %4u.%u %6u %6u %9u\r\n", modes[k][0] == LCD_FB_DOUBLE ? "double" : "single",
+               (modes[k][0] == LCD_FB_DOUBLE && g_lcd_fb.front == NULL) ? '*' : ' ',
+               modes[k][1] == LCD_VSYNC_NONE ? "none" : "timer", st.fps_x10 / 10, st.fps_x10 % 10, st.missed,
+               st.late_vsyncs, st.wait_max_us);
+    }
+
+    lcd_frame_init(LCD_VSYNC_NONE, 1);
+    lcd_fb_enable(LCD_FB_OFF);
+}
+
+/* 读回四角 (lcd_read_point 会恢复全屏窗口) */
+static uint8_t bench_check(uint16_t sx, uint16_t sy, uint16_t ex, uint16_t ey, const uint16_t *color, uint16_t fill)
+{
+    uint32_t w = ex - sx + 1, h = ey - sy + 1;
+
+    if (color == NULL) {
+        return lcd_read_point(sx, sy) != fill || lcd_read_point(ex, sy) != fill ||
+               lcd_read_point(sx, ey) != fill || lcd_read_point(ex, ey) != fill;
+    }
+    return lcd_read_point(sx, sy) != color[0] || lcd_read_point(ex, sy) != color[w - 1] ||
+           lcd_read_point(sx, ey) != color[(h - 1) * w] || lcd_read_point(ex, ey) != color[h * w - 1];
+}
+
+/**
+ * @brief       运行像素速率测试, 结果输出到串口1
+ * @param       无
+ * @retval      无
+ */
+void lcd_bench(void)
+{
+    static const uint16_t fills[2] = {0xF81F, 0x07E0};
+    uint16_t *src, w, h, sx, sy, ex, ey;
+    uint32_t i, k, r, n, t0, cyc[8], bad[8];
+
+    src = mymalloc(SRAMEX, 240 * 240 * 2 + 4);
+    if (!src) {
+        printf("lcd_bench: 内存不足\r\n");
+        return;
+    }
+    for (i = 0; i < 240 * 240 + 2; i++) src[i] = (uint16_t)(i * 0x9E37 + 0x1234);
+    bench_dwt_init();
+
+    printf("\r\nLCD 像素速率 (百万像素/秒), ID %04X %ux%u, HCLK %u MHz\r\n", lcddev.id, lcddev.width, lcddev.height,
+           SystemCoreClock / 1000000);
+    printf("%7s | %8s %8s %8s %8s | %8s %8s %8s %8s\r\n", "rect", "fill row", "fill win", "fill dma", "dma(cpu)",
+           "blit row", "blit win", "blit dma", "dma(cpu)");
+
+    for (k = 0; k < sizeof(g_rects) / sizeof(g_rects[0]); k++) {
+        w = g_rects[k][0] < lcddev.width ? g_rects[k][0] : lcddev.width;
+        h = g_rects[k][1] < lcddev.height ? g_rects[k][1] : lcddev.height;
+        sx = (lcddev.width - w) / 2;                                       /* 放在屏幕中间, 起点不在0列 */
+        sy = (lcddev.height - h) / 2;
+        ex = sx + w - 1;
+        ey = sy + h - 1;
+        n = (uint32_t)w * h;
+        memset(cyc, 0, sizeof(cyc));
+        memset(bad, 0, sizeof(bad));
+
+        for (r = 0; r < LCD_BENCH_ROUNDS; r++) {
+            t0 = DWT->CYCCNT;
+            bench_row_fill(sx, sy, ex, ey, fills[r & 1]);
+            cyc[0] += DWT->CYCCNT - t0;
+            bad[0] |= bench_check(sx, sy, ex, ey, NULL, fills[r & 1]);
+
+            t0 = DWT->CYCCNT;
+            bench_win_fill(sx, sy, ex, ey, fills[~r & 1]);
+            cyc[1] += DWT->CYCCNT - t0;
+            bad[1] |= bench_check(sx, sy, ex, ey, NULL, fills[~r & 1]);
+
+            t0 = DWT->CYCCNT;
+            lcd_fill(sx, sy, ex, ey, fills[r & 1]);
+            cyc[2] += DWT->CYCCNT - t0;
+            bad[2] |= bench_check(sx, sy, ex, ey, NULL, fills[r & 1]);
+
+            t0 = DWT->CYCCNT;
+            lcd_fill_async(sx, sy, ex, ey, fills[~r & 1], NULL, NULL);
+            cyc[3] += DWT->CYCCNT - t0;
+            bad[3] |= lcd_dma_wait() || bench_check(sx, sy, ex, ey, NULL, fills[~r & 1]);
+
+            t0 = DWT->CYCCNT;
+            bench_row_blit(sx, sy, ex, ey, src);
+            cyc[4] += DWT->CYCCNT - t0;
+            bad[4] |= bench_check(sx, sy, ex, ey, src, 0);
+
+            t0 = DWT->CYCCNT;
+            bench_win_blit(sx, sy, ex, ey, src + 1);
+            cyc[5] += DWT->CYCCNT - t0;
+            bad[5] |= bench_check(sx, sy, ex, ey, src + 1, 0);
+
+            t0 = DWT->CYCCNT;
+            lcd_color_fill(sx, sy, ex, ey, src + (r & 1));                 /* 4字节对齐和不对齐交替 */
+            cyc[6] += DWT->CYCCNT - t0;
+            bad[6] |= bench_check(sx, sy, ex, ey, src + (r & 1), 0);
+
+            t0 = DWT->CYCCNT;
+            lcd_color_fill_async(sx, sy, ex, ey, src + 2, NULL, NULL);
+            cyc[7] += DWT->CYCCNT - t0;
+            bad[7] |= lcd_dma_wait() || bench_check(sx, sy, ex, ey, src + 2, 0);
+        }
+
+        printf("%3ux%-3u |", w, h);
+        for (i = 0; i < 8; i++) {
+            bench_print(bench_rate(n, cyc[i]), bad[i]);
+            if (i == 3) printf(" |");
+        }
+        printf("\r\n");
+    }
+
+    /* 逐点参照: 100x100 */
+    w = lcddev.width < 100 ? lcddev.width : 100;
+    h = lcddev.height < 100 ? lcddev.height : 100;
+    t0 = DWT->CYCCNT;
+    for (r = 0; r < LCD_BENCH_ROUNDS; r++) {
+        for (sy = 0; sy < h; sy++) {
+            for (sx = 0; sx < w; sx++) lcd_draw_point(sx, sy, fills[r & 1]);
+        }
+    }
+    cyc[0] = DWT->CYCCNT - t0;
+
+    /* 清屏 */
+    t0 = DWT->CYCCNT;
+    for (r = 0; r < LCD_BENCH_ROUNDS; r++) lcd_clear(fills[r & 1]);
+    cyc[1] = DWT->CYCCNT - t0;
+    bad[1] = bench_check(0, 0, lcddev.width - 1, lcddev.height - 1, NULL, fills[(LCD_BENCH_ROUNDS - 1) & 1]);
+
+    printf("点 %ux%u:", w, h);
+    bench_print(bench_rate((uint32_t)w * h, cyc[0]), 0);
+    printf("   清屏 %ux%u:", lcddev.width, lcddev.height);
+    bench_print(bench_rate((uint32_t)lcddev.width * lcddev.height, cyc[1]), bad[1]);
+    printf("\r\n");
+
+    lcd_clear(WHITE);
+    bench_text();
+    lcd_clear(WHITE);
+    bench_shapes();
+    myfree(SRAMEX, src);
+    bench_fb();                                                             /* 先释放测试数组, 帧缓冲要整屏大小 */
+    bench_frame();
+    lcd_clear(WHITE);
+}
@@ -0,0 +1,13 @@
+/**
+ ****************************************************************************************************
+ * @file        lcd_bench.h
+ * @brief       LCD 填充/写入 像素速率测试 (板上运行)
+ ****************************************************************************************************
+ */
+
+#ifndef __LCD_BENCH_H
+#define __LCD_BENCH_H
+
+void lcd_bench(void);
+
+#endif
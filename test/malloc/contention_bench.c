@@ -0,0 +1,106 @@
+/**
+ ****************************************************************************************************
+ * @file        contention_bench.c
+ * @brief       多任务竞争基准测试 (主机编译): 每任务缓存 开/关 对比
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -pthread -DMEM_HOST_BUILD -Imiddleware/MALLOC test/malloc/contention_bench.c \
+ *       test/malloc/dma_stub.c middleware/MALLOC/malloc.c middleware/MALLOC/mem_tlsf.c \
+ *       -o contention_bench && ./contention_bench
+ *
+ * 仓库中没有FreeRTOS的POSIX移植, 这里用pthread线程模拟任务: 主机编译时 malloc.c 的内存池锁
+ * 为每池一把互斥锁, 每任务缓存指针放在线程局部变量中 (见 malloc.c 开头).
+ * N 个线程 (1/2/4/8) 在同一内存池上各自执行随机的 申请/释放 序列, 大小以 1~4 块的小内存为主,
+ * 少量大块; 线程结束前清空自己的缓存, 最后检查内存池使用率回到0.
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "malloc.h"
+
+#define BENCH_OPS           400000                                          /* 每线程操作次数 */
+#define BENCH_LIVE          64                                              /* 每线程同时持有的内存数 */
+#define BENCH_MAX_THREADS   8
+
+typedef struct
+{
+    uint8_t memx;
+    uint32_t seed;
+    uint32_t fail;
+} bench_arg_t;
+
+static void *bench_thread(void *param)
+{
+    bench_arg_t *arg = (bench_arg_t *)param;
+    void *live[BENCH_LIVE] = {0};
+    uint32_t i, k, size;
+
+    for (i = 0; i < BENCH_OPS; i++) {
+        arg->seed = arg->seed * 1103515245 + 12345;
+        k = (arg->seed >> 8) % BENCH_LIVE;
+        if (live[k]) {
+            myfree(arg->memx, live[k]);
+            live[k] = NULL;
+        } else {
+            size = ((arg->seed >> 16) & 15) == 0 ? 512 + (arg->seed & 1023) : 1 + ((arg->seed >> 4) & 127);
+            live[k] = mymalloc(arg->memx, size);
+            if (!live[k]) arg->fail++;
+        }
+    }
+    for (k = 0; k < BENCH_LIVE; k++) myfree(arg->memx, live[k]);
+    my_mem_cache_flush();
+    return NULL;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_run(uint8_t memx, uint32_t nthreads, uint8_t cache)
+{
+    pthread_t tid[BENCH_MAX_THREADS];
+    bench_arg_t arg[BENCH_MAX_THREADS];
+    uint32_t i, fail = 0;
+    double t0, t1;
+
+    my_mem_init(memx);
+    my_mem_cache_enable(cache);
+    t0 = now_s();
+    for (i = 0; i < nthreads; i++) {
+        arg[i].memx = memx;
+        arg[i].seed = 7919 * (i + 1);
+        arg[i].fail = 0;
+        pthread_create(&tid[i], NULL, bench_thread, &arg[i]);
+    }
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(tid[i], NULL);
+        fail += arg[i].fail;
+    }
+    t1 = now_s();
+
+    printf("  %u线程  缓存%s  %8.2f Mops/s  %7.1f ns/op  失败 %u  结束使用率 %u‰\n", nthreads, cache ? "开" : "关",
+           nthreads * (double)BENCH_OPS / (t1 - t0) / 1e6, (t1 - t0) * 1e9 / BENCH_OPS, fail, my_mem_perused(memx));
+}
+
+int main(void)
+{
+    static const uint32_t threads[] = {1, 2, 4, 8};
+    uint32_t i;
+
+    my_mem_init(MEM_MAG_BANK);                                              /* 缓存结构所在内存池 */
+    printf("SRAMIN 竞争测试 (每线程 %u 次操作):\n", BENCH_OPS);
+    for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        bench_run(SRAMIN, threads[i], 0);
+        bench_run(SRAMIN, threads[i], 1);
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ ****************************************************************************************************
+ * @file        frag_sim.c
+ * @brief       长期运行碎片模拟 (主机编译): mymalloc 与 可移动句柄内存区(带空闲整理) 对比
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -pthread -DMEM_HOST_BUILD -Imiddleware/MALLOC test/malloc/frag_sim.c test/malloc/dma_stub.c \
+ *       middleware/MALLOC/malloc.c middleware/MALLOC/mem_tlsf.c middleware/MALLOC/memhandle.c \
+ *       -o frag_sim && ./frag_sim
+ *
+ * 两种方式在同样大小的区域上重放同一个随机事件序列 (模拟数月运行):
+ *   小对象 (32B ~ 2KB, 约10%长期驻留) 持续申请释放, 存活数量随负载周期起伏;
+ *   周期性申请 200KB 图像缓冲, 持有期间钉住, 一段时间后释放.
+ * 句柄方式中约 2% 的短寿命小对象在存活期间一直钉住 (模拟DMA缓冲区), 每个事件之间调用一次
+ * mymem_hcompact (SIM_BUDGET 字节) 模拟空闲时间的整理. 统计图像缓冲申请失败次数
+ * (只计总空闲足够但申请失败的情况), 以及各阶段的 最大连续空闲 / 总空闲.
+ * 句柄方式的每个对象写入校验图案, 释放前检查, 验证搬移不破坏数据.
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "malloc.h"
+#include "memhandle.h"
+
+#define SIM_REGION          (512 * 1024)                                    /* 区域大小 */
+#define SIM_EVENTS          4000000                                         /* 事件数 */
+#define SIM_SLOTS           600                                             /* 同时存活的小对象上限 */
+#define SIM_BIG_SIZE        (200 * 1024)                                    /* 图像缓冲大小 */
+#define SIM_BIG_PERIOD      2000                                            /* 每隔多少事件申请一次图像缓冲 */
+#define SIM_BIG_HOLD        500                                             /* 图像缓冲持有事件数 */
+#define SIM_BUDGET          256                                             /* 每个事件间隔的整理预算 (字节) */
+#define SIM_PHASE           400000                                          /* 负载周期: 存活对象数在 SIM_SLOTS/8 ~ SIM_SLOTS 之间往复 */
+#define SIM_REPORT          10                                              /* 报告次数 */
+
+typedef struct
+{
+    uint32_t size;
+    uint32_t death;                                                         /* 释放时刻 */
+    uint32_t seed;                                                          /* 校验图案 */
+    void *ptr;                                                              /* mymalloc 方式 */
+    mymem_handle_t h;                                                       /* 句柄方式 */
+    uint8_t pinned;
+} sim_obj_t;
+
+static sim_obj_t g_obj[SIM_SLOTS];
+static uint32_t g_rng;
+
+static uint32_t rnd(void)
+{
+    g_rng = g_rng * 1664525 + 1013904223;
+    return g_rng >> 8;
+}
+
+/* ==================== 两种分配方式的统一接口 ==================== */
+static mymem_hheap_t *g_hp;
+static uint8_t g_mode;                                                      /* 0: mymalloc, 1: 句柄 */
+static uint32_t g_used;                                                     /* 已申请字节 (按块/8字节取整) */
+static uint32_t g_errors;
+
+static uint32_t sim_round(uint32_t size)
+{
+    return g_mode ? ((size + 8 + 7) & ~7U) : ((size + 31) & ~31U);
+}
+
+static void sim_fill(uint8_t *p, uint32_t size, uint32_t seed)
+{
+    uint32_t i;
+    for (i = 0; i < size; i += 64) p[i] = (uint8_t)(seed + i);
+}
+
+static uint32_t sim_check(uint8_t *p, uint32_t size, uint32_t seed)
+{
+    uint32_t i;
+    for (i = 0; i < size; i += 64) if (p[i] != (uint8_t)(seed + i)) return 1;
+    return 0;
+}
+
+static uint8_t sim_alloc(sim_obj_t *o)
+{
+    uint8_t *p;
+    if (g_mode == 0) {
+        o->ptr = mymalloc(SRAMEX, o->size);
+        if (o->ptr == NULL) return 0;
+    } else {
+        o->h = mymem_halloc(g_hp, o->size);
+        if (o->h == 0) return 0;
+        p = mymem_hlock(g_hp, o->h);
+        sim_fill(p, o->size, o->seed);
+        if (!o->pinned) mymem_hunlock(g_hp, o->h);                          /* 钉住的对象一直不解锁 */
+    }
+    g_used += sim_round(o->size);
+    return 1;
+}
+
+static void sim_free(sim_obj_t *o)
+{
+    if (g_mode == 0) {
+        myfree(SRAMEX, o->ptr);
+        o->ptr = NULL;
+    } else {
+        g_errors += sim_check(mymem_hlock(g_hp, o->h), o->size, o->seed);
+        mymem_hfree(g_hp, o->h);
+        o->h = 0;
+    }
+    g_used -= sim_round(o->size);
+}
+
+static uint32_t sim_largest(void)
+{
+    mem_stats_t st;
+    if (g_mode) return mymem_hheap_largest(g_hp);
+    my_mem_stats(SRAMEX, &st);
+    return st.largest_free;
+}
+
+static uint8_t sim_live(sim_obj_t *o)
+{
+    return g_mode ? o->h != 0 : o->ptr != NULL;
+}
+
+/* ==================== 模拟 ==================== */
+static void sim_run(uint8_t mode)
+{
+    sim_obj_t big = {0};
+    void *filler = NULL;
+    uint32_t t, k, tries = 0, fails = 0, big_until = 0, report = 0;
+    uint32_t region, phase, limit;
+
+    g_mode = mode;
+    g_rng = 12345;
+    g_used = 0;
+    g_errors = 0;
+    memset(g_obj, 0, sizeof(g_obj));
+    my_mem_init(SRAMEX);
+    if (mode == 0) {
+        filler = mymalloc(SRAMEX, MEM3_MAX_SIZE - SIM_REGION);            /* 占掉多余部分, 使可用空间与句柄方式相同 */
+        region = SIM_REGION;
+    } else {
+        g_hp = mymem_hheap_create(SRAMEX, SIM_REGION, SIM_SLOTS + 1);
+        region = g_hp->size;
+    }
+
+    printf("%s:\n", mode ? "可移动句柄 + 空闲整理" : "mymalloc");
+    printf("    进度   已用KB  最大连续空闲KB  空闲KB  图像缓冲失败/尝试\n");
+    for (t = 1; t <= SIM_EVENTS; t++) {
+        /* 小对象: 到期释放, 空槽位随机补充 (只补充 limit 以内的槽位, 模拟负载高低起伏) */
+        phase = t % SIM_PHASE;
+        phase = phase < SIM_PHASE / 2 ? phase : SIM_PHASE - phase;
+        limit = SIM_SLOTS / 8 + (uint32_t)((uint64_t)(SIM_SLOTS - SIM_SLOTS / 8) * phase / (SIM_PHASE / 2));
+        k = rnd() % SIM_SLOTS;
+        if (sim_live(&g_obj[k]) && g_obj[k].death <= t) {
+            sim_free(&g_obj[k]);
+        } else if (!sim_live(&g_obj[k]) && k < limit) {
+            g_obj[k].size = (rnd() % 8 == 0) ? 512 + rnd() % 1536 : 32 + rnd() % 480;
+            g_obj[k].death = t + ((rnd() % 10 == 0) ? 200000 + rnd() % 2000000 : rnd() % 20000);
+            g_obj[k].seed = rnd();
+            g_obj[k].pinned = (g_obj[k].death - t < 20000 && rnd() % 50 == 0);    /* 只有短寿命对象被钉住 */
+            sim_alloc(&g_obj[k]);
+        }
+
+        /* 图像缓冲 */
+        if (big_until && t >= big_until) {
+            sim_free(&big);
+            big_until = 0;
+        }
+        if (t % SIM_BIG_PERIOD == 0 && !big_until) {
+            big.size = SIM_BIG_SIZE;
+            big.seed = rnd();
+            big.pinned = 1;                                                 /* 图像缓冲持有期间一直钉住 (DMA刷屏) */
+            if (region - g_used >= sim_round(SIM_BIG_SIZE)) {              /* 总空闲足够时才计入 */
+                tries++;
+                if (sim_alloc(&big)) big_until = t + SIM_BIG_HOLD;
+                else fails++;
+            }
+        }
+
+        if (mode) mymem_hcompact(g_hp, SIM_BUDGET);
+
+        if (t % (SIM_EVENTS / SIM_REPORT) == 0) {
+            report++;
+            printf("    %3u%%  %7u  %14u  %6u  %6u / %u\n", report * 100 / SIM_REPORT, g_used / 1024,
+                   sim_largest() / 1024, (region - g_used) / 1024, fails, tries);
+        }
+    }
+
+    for (k = 0; k < SIM_SLOTS; k++) if (sim_live(&g_obj[k])) sim_free(&g_obj[k]);
+    if (big_until) sim_free(&big);
+    if (mode) {
+        printf("    累计搬移 %u 块 / %u KB, 数据校验 %s\n", g_hp->moves, g_hp->moved_bytes / 1024, g_errors ? "失败" : "通过");
+        mymem_hheap_delete(g_hp);
+    } else {
+        myfree(SRAMEX, filler);
+    }
+    if (my_mem_perused(SRAMEX)) printf("    !! 内存泄漏\n");
+}
+
+int main(void)
+{
+    my_mem_cache_enable(0);
+    sim_run(0);
+    sim_run(1);
+    return 0;
+}
@@ -0,0 +1,189 @@
+/**
+ ****************************************************************************************************
+ * @file        malloc_bench.c
+ * @brief       内存管理基准测试 (主机编译): mem_tlsf 引擎 与 原线性扫描实现 对比
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -pthread -DMEM_HOST_BUILD -Imiddleware/MALLOC test/malloc/malloc_bench.c test/malloc/dma_stub.c \
+ *       middleware/MALLOC/malloc.c middleware/MALLOC/mem_tlsf.c -o malloc_bench && ./malloc_bench
+ *
+ * 对三个内存池 (块数与板上配置一致) 分别执行相同的随机分配/释放序列,
+ * 统计每次 分配/释放/失败分配 的平均和最大耗时. 原实现按 malloc.c 的旧代码原样复制,
+ * 只操作状态表 (与原实现一致, 不访问池内存).
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "malloc.h"
+
+extern const uint32_t memsize[SRAMBANK];
+
+#define BENCH_OPS           200000                                          /* 每个池的操作次数 */
+#define BENCH_LIVE_MAX      512                                             /* 同时存活的最大分配数 */
+
+/* ==================== 原线性扫描实现 (旧 malloc.c) ==================== */
+static uint16_t legacy_map[MEM3_ALLOC_TABLE_SIZE];
+static uint32_t legacy_tblsize;
+static uint32_t legacy_blksize;
+
+static uint32_t legacy_malloc(uint32_t size)
+{
+    signed long offset = 0;
+    uint32_t nmemb, cmemb = 0, i;
+    nmemb = size / legacy_blksize;
+    if (size % legacy_blksize) nmemb++;
+    for (offset = legacy_tblsize - 1; offset >= 0; offset--) {
+        if (!legacy_map[offset]) cmemb++;
+        else cmemb = 0;
+        if (cmemb == nmemb) {
+            for (i = 0; i < nmemb; i++) {
+                legacy_map[offset + i] = nmemb;
+            }
+            return offset * legacy_blksize;
+        }
+    }
+    return 0XFFFFFFFF;
+}
+
+static void legacy_free(uint32_t offset)
+{
+    int i, index, nmemb;
+    index = offset / legacy_blksize;
+    nmemb = legacy_map[index];
+    for (i = 0; i < nmemb; i++) {
+        legacy_map[index + i] = 0;
+    }
+}
+
+/* ==================== 计时统计 ==================== */
+typedef struct
+{
+    double sum;
+    double max;
+    uint32_t cnt;
+} bench_stat_t;
+
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_add(bench_stat_t *s, double ns)
+{
+    s->sum += ns;
+    if (ns > s->max) s->max = ns;
+    s->cnt++;
+}
+
+static void bench_print(const char *name, bench_stat_t *s)
+{
+    printf("    %-14s avg %9.1f ns   max %10.1f ns   (%u次)\n", name,
+           s->cnt ? s->sum / s->cnt : 0.0, s->max, s->cnt);
+}
+
+/* ==================== 测试序列 ==================== */
+typedef struct
+{
+    uint32_t size;
+    uint32_t offset;                                                        /* 0XFFFFFFFF: 空槽 */
+} bench_slot_t;
+
+/**
+ * @brief   随机分配/释放序列, use_tlsf=1 走 mymalloc/myfree, 0 走原线性扫描
+ */
+static void bench_run(uint8_t memx, uint32_t maxsize, int use_tlsf)
+{
+    static bench_slot_t slot[BENCH_LIVE_MAX];
+    bench_stat_t st_alloc = {0}, st_free = {0}, st_fail = {0};
+    uint32_t i, k, size, offset;
+    double t0, t1;
+    void *p;
+
+    srand(1234 + memx);
+    for (k = 0; k < BENCH_LIVE_MAX; k++) slot[k].offset = 0XFFFFFFFF;
+    if (use_tlsf) {
+        my_mem_init(memx);
+    } else {
+        memset(legacy_map, 0, sizeof(legacy_map));
+    }
+
+    for (i = 0; i < BENCH_OPS; i++) {
+        k = rand() % BENCH_LIVE_MAX;
+        if (slot[k].offset == 0XFFFFFFFF) {
+            size = 1 + rand() % maxsize;
+            t0 = bench_now_ns();
+            if (use_tlsf) {
+                p = mymalloc(memx, size);
+                offset = p ? (uint32_t)((uint8_t *)p - mallco_dev.membase[memx]) : 0XFFFFFFFF;
+            } else {
+                offset = legacy_malloc(size);
+            }
+            t1 = bench_now_ns();
+            if (offset == 0XFFFFFFFF) {
+                bench_add(&st_fail, t1 - t0);
+            } else {
+                bench_add(&st_alloc, t1 - t0);
+                slot[k].size = size;
+                slot[k].offset = offset;
+            }
+        } else {
+            t0 = bench_now_ns();
+            if (use_tlsf) myfree(memx, mallco_dev.membase[memx] + slot[k].offset);
+            else legacy_free(slot[k].offset);
+            t1 = bench_now_ns();
+            bench_add(&st_free, t1 - t0);
+            slot[k].offset = 0XFFFFFFFF;
+        }
+    }
+
+    /* 最坏情况: 请求超过剩余连续空间, 必然失败 */
+    for (i = 0; i < 1000; i++) {
+        t0 = bench_now_ns();
+        if (use_tlsf) p = mymalloc(memx, memsize[memx]);
+        else offset = legacy_malloc(memsize[memx]);
+        t1 = bench_now_ns();
+        bench_add(&st_fail, t1 - t0);
+    }
+
+    /* 全部释放后应能重新申请整个内存池 (检查合并是否正确) */
+    if (use_tlsf) {
+        for (k = 0; k < BENCH_LIVE_MAX; k++) {
+            if (slot[k].offset != 0XFFFFFFFF) myfree(memx, mallco_dev.membase[memx] + slot[k].offset);
+        }
+        p = mymalloc(memx, memsize[memx]);
+        if (my_mem_perused(memx) != 1000 || p != mallco_dev.membase[memx]) {
+            printf("  mem_tlsf: 释放后合并错误!\n");
+        }
+    }
+
+    printf("  %s\n", use_tlsf ? "mem_tlsf:" : "线性扫描:");
+    bench_print("malloc", &st_alloc);
+    bench_print("free", &st_free);
+    bench_print("malloc(失败)", &st_fail);
+}
+
+int main(void)
+{
+    static const char *name[SRAMBANK] = {"SRAMIN", "SRAMCCM", "SRAMEX"};
+    static const uint32_t blocks[SRAMBANK] = {MEM1_ALLOC_TABLE_SIZE, MEM2_ALLOC_TABLE_SIZE, MEM3_ALLOC_TABLE_SIZE};
+    static const uint32_t maxsize[SRAMBANK] = {1024, 512, 8192};
+    uint8_t memx;
+
+    my_mem_cache_enable(0);                                                 /* 只测分配引擎本身 */
+    for (memx = 0; memx < SRAMBANK; memx++) {
+        printf("%s: %u块, 单次申请 1~%u 字节\n", name[memx], blocks[memx], maxsize[memx]);
+        legacy_tblsize = blocks[memx];
+        legacy_blksize = MEM1_BLOCK_SIZE;
+        bench_run(memx, maxsize[memx], 0);
+        bench_run(memx, maxsize[memx], 1);
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ ****************************************************************************************************
+ * @file        memhandle_test.c
+ * @brief       可移动句柄内存区 (memhandle.c) 正确性测试 (主机编译)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -pthread -DMEM_HOST_BUILD -Imiddleware/MALLOC test/malloc/memhandle_test.c test/malloc/dma_stub.c \
+ *       middleware/MALLOC/malloc.c middleware/MALLOC/mem_tlsf.c middleware/MALLOC/memhandle.c \
+ *       -o memhandle_test && ./memhandle_test
+ *
+ *   脏内存: 先申请一块同样大小的内存写满 0xA5 再释放 (进入每任务缓存), 区域在这块内存上创建,
+ *           句柄表和控制块必须被正确初始化: 能申请满全部句柄, 统计为0
+ *   随机  : 随机 申请/释放/钉住/解除, 每个事件之间用很小的预算整理 (分段搬移几乎一直在进行),
+ *           钉住或释放正在搬移的块也会发生; 钉住时和释放前检查数据图案, 空闲字节数与实际一致
+ *   结束  : 全部释放后整理到紧凑, 最大连续空闲应等于整个区域
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "malloc.h"
+#include "memhandle.h"
+
+#define T_REGION        (64 * 1024)
+#define T_HANDLES       200
+#define T_EVENTS        400000
+#define T_BUDGET        48
+
+typedef struct
+{
+    mymem_handle_t h;
+    uint32_t size;
+    uint32_t seed;
+    uint8_t pinned;
+} t_obj_t;
+
+static t_obj_t g_obj[T_HANDLES];
+static uint32_t g_rng = 1;
+
+static uint32_t rnd(void)
+{
+    g_rng = g_rng * 1664525 + 1013904223;
+    return g_rng >> 8;
+}
+
+static void fill(uint8_t *p, const t_obj_t *o)
+{
+    uint32_t i;
+    for (i = 0; i < o->size; i++) p[i] = (uint8_t)(o->seed + i * 13);
+}
+
+static uint32_t check(const uint8_t *p, const t_obj_t *o)
+{
+    uint32_t i;
+    for (i = 0; i < o->size; i++) if (p[i] != (uint8_t)(o->seed + i * 13)) return 1;
+    return 0;
+}
+
+/* ==================== 脏内存上创建 ==================== */
+static uint32_t test_dirty(void)
+{
+    uint32_t head = (sizeof(mymem_hheap_t) + T_HANDLES * sizeof(uint8_t *) + 31) & ~31U;
+    mymem_hheap_t *hp;
+    void *p;
+    uint32_t i, err = 0;
+
+    p = mymalloc(SRAMEX, head + T_REGION);
+    if (p == NULL) return 1;
+    memset(p, 0xA5, head + T_REGION);
+    myfree(SRAMEX, p);
+
+    hp = mymem_hheap_create(SRAMEX, T_REGION, T_HANDLES);
+    if (hp == NULL) return 1;
+    err += (void *)hp != p;                                                 /* 确实拿到了脏内存 */
+    err += hp->moves != 0 || hp->moved_bytes != 0 || hp->cur != 0 || hp->free != T_REGION;
+    for (i = 0; i < T_HANDLES; i++) {
+        if (mymem_halloc(hp, 16) != i + 1) err++;
+    }
+    err += mymem_halloc(hp, 16) != 0;                                       /* 句柄用完 */
+    for (i = 1; i <= T_HANDLES; i++) mymem_hfree(hp, i);
+    err += mymem_hheap_largest(hp) != T_REGION;
+    mymem_hheap_delete(hp);
+    return err;
+}
+
+/* ==================== 随机 ==================== */
+static uint32_t test_random(void)
+{
+    mymem_hheap_t *hp;
+    t_obj_t *o;
+    uint8_t *p;
+    uint32_t t, k, used = 0, err = 0, mid = 0, n;
+
+    hp = mymem_hheap_create(SRAMEX, T_REGION, T_HANDLES);
+    if (hp == NULL) return 1;
+    memset(g_obj, 0, sizeof(g_obj));
+
+    for (t = 0; t < T_EVENTS; t++) {
+        o = &g_obj[rnd() % T_HANDLES];
+        k = rnd() % 8;
+        if (hp->mv_src != MEM_H_NONE) mid++;
+
+        if (o->h == 0) {
+            o->size = (rnd() % 16 == 0) ? 1024 + rnd() % 4096 : 1 + rnd() % 200;
+            o->seed = rnd();
+            o->h = mymem_halloc(hp, o->size);
+            if (o->h) {
+                p = (uint8_t *)mymem_hlock(hp, o->h);
+                fill(p, o);
+                mymem_hunlock(hp, o->h);
+                used += (o->size + 8 + 7) & ~7U;
+            }
+        } else if (k < 3) {                                                 /* 释放 (可能正在搬移) */
+            p = (uint8_t *)mymem_hlock(hp, o->h);
+            err += check(p, o);
+            mymem_hunlock(hp, o->h);
+            if (o->pinned) mymem_hunlock(hp, o->h);
+            if (k == 0) {                                                   /* 不先钉住, 直接释放 */
+                mymem_hcompact(hp, T_BUDGET);
+            }
+            mymem_hfree(hp, o->h);
+            used -= (o->size + 8 + 7) & ~7U;
+            o->h = 0;
+            o->pinned = 0;
+        } else if (k < 5 && !o->pinned) {                                   /* 钉住一段时间 */
+            p = (uint8_t *)mymem_hlock(hp, o->h);
+            err += check(p, o);
+            o->pinned = 1;
+        } else if (k < 7 && o->pinned) {
+            mymem_hunlock(hp, o->h);
+            o->pinned = 0;
+        }
+
+        mymem_hcompact(hp, T_BUDGET);
+        if (t % 1000 == 0) {
+            n = mymem_hheap_largest(hp);
+            err += n > hp->free;
+        }
+    }
+
+    for (k = 0; k < T_HANDLES; k++) {
+        o = &g_obj[k];
+        if (o->h == 0) continue;
+        p = (uint8_t *)mymem_hlock(hp, o->h);
+        err += check(p, o);
+        mymem_hfree(hp, o->h);
+        used -= (o->size + 8 + 7) & ~7U;
+    }
+    err += used != 0 || hp->free != hp->size;
+    for (t = 0; t < 1000000 && !mymem_hcompact(hp, T_BUDGET); t++);
+    err += mymem_hheap_largest(hp) != hp->size;
+
+    printf("随机: 搬移 %u 块 / %u KB, 事件发生在分段搬移途中 %u 次\n", hp->moves, hp->moved_bytes / 1024, mid);
+    mymem_hheap_delete(hp);
+    return err;
+}
+
+int main(void)
+{
+    uint32_t e_dirty, e_random;
+
+    my_mem_init(SRAMIN);
+    my_mem_init(SRAMEX);
+
+    e_dirty = test_dirty();
+    e_random = test_random();
+
+    printf("脏内存上创建 %s, 随机 %s\n", e_dirty ? "失败" : "通过", e_random ? "失败" : "通过");
+    if (my_mem_perused(SRAMEX)) printf("内存泄漏: SRAMEX %u‰\n", my_mem_perused(SRAMEX));
+    return e_dirty || e_random;
+}
@@ -0,0 +1,146 @@
+/**
+ ****************************************************************************************************
+ * @file        memops_test.c
+ * @brief       mymemcpy/mymemset 及其DMA路径 正确性与吞吐量测试 (主机编译)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -pthread -fno-tree-vectorize -fno-tree-loop-distribute-patterns -DMEM_HOST_BUILD -Imiddleware/MALLOC \
+ *       test/malloc/memops_test.c test/malloc/dma_stub.c middleware/MALLOC/malloc.c \
+ *       middleware/MALLOC/mem_tlsf.c -o memops_test && ./memops_test
+ *   (关闭自动向量化和库函数替换, 使主机上的循环与Cortex-M4上的代码形态接近)
+ *
+ * 主机上没有DMA2, 由 dma_stub.c 的同步桩函数代替 driver/DMA/dma.c, 可模拟通道忙,
+ * 检查退回CPU路径是否正确.
+ * 正确性: 源/目的 0~7 字节偏移 × 0~300 字节长度 全组合, 以及跨越DMA门限的大块, 检查前后保护区.
+ * 吞吐量: 原逐字节实现 与 新实现 在不同长度下的 MB/s.
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "malloc.h"
+#include "../../driver/DMA/dma.h"
+
+/* DMA 桩实现 (dma_stub.c) 的控制变量 */
+extern uint8_t g_dma_busy;
+extern uint32_t g_dma_bytes;
+extern uint32_t g_dma_errors;
+
+/* ==================== 原逐字节实现 ==================== */
+static void legacy_memcpy(void *des, void *src, uint32_t n)
+{
+    uint8_t *xdes = (uint8_t *)des;
+    uint8_t *xsrc = (uint8_t *)src;
+    while (n--) *xdes++ = *xsrc++;
+}
+
+static void legacy_memset(void *s, uint8_t c, uint32_t count)
+{
+    uint8_t *xs = (uint8_t *)s;
+    while (count--) *xs++ = c;
+}
+
+/* ==================== 正确性 ==================== */
+#define GUARD       16
+#define BUF_MAX     (64 * 1024)
+
+static uint8_t g_src[BUF_MAX + 2 * GUARD] __attribute__((aligned(32)));
+static uint8_t g_dst[BUF_MAX + 2 * GUARD] __attribute__((aligned(32)));
+static uint8_t g_ref[BUF_MAX + 2 * GUARD] __attribute__((aligned(32)));
+
+static uint32_t check_copy(void (*fn)(void *, void *, uint32_t), uint32_t soff, uint32_t doff, uint32_t n)
+{
+    memset(g_dst, 0xA5, sizeof(g_dst));
+    memcpy(g_ref, g_dst, sizeof(g_ref));
+    memcpy(g_ref + GUARD + doff, g_src + GUARD + soff, n);
+    fn(g_dst + GUARD + doff, g_src + GUARD + soff, n);
+    return memcmp(g_dst, g_ref, sizeof(g_dst)) != 0;
+}
+
+static uint32_t check_set(void (*fn)(void *, uint8_t, uint32_t), uint32_t off, uint32_t n)
+{
+    uint8_t c = (uint8_t)rand();
+    memset(g_dst, 0xA5, sizeof(g_dst));
+    memcpy(g_ref, g_dst, sizeof(g_ref));
+    memset(g_ref + GUARD + off, c, n);
+    fn(g_dst + GUARD + off, c, n);
+    return memcmp(g_dst, g_ref, sizeof(g_dst)) != 0;
+}
+
+static void test_correctness(void)
+{
+    static const uint32_t big[] = {MEM_DMA_MIN_SIZE - 1, MEM_DMA_MIN_SIZE, MEM_DMA_MIN_SIZE + 3, 4099, 40000, BUF_MAX - 8};
+    uint32_t soff, doff, n, i, err_cpu = 0, err_dma = 0, err_fb = 0;
+
+    for (i = 0; i < sizeof(g_src); i++) g_src[i] = (uint8_t)rand();
+
+    for (soff = 0; soff < 8; soff++) {
+        for (doff = 0; doff < 8; doff++) {
+            for (n = 0; n <= 300; n++) {
+                err_cpu += check_copy(mymemcpy, soff, doff, n);
+            }
+            for (i = 0; i < sizeof(big) / sizeof(big[0]); i++) {
+                err_cpu += check_copy(mymemcpy, soff, doff, big[i]);
+                err_dma += check_copy(mymemcpy_dma, soff, doff, big[i]);
+                g_dma_busy = 1;
+                err_fb += check_copy(mymemcpy_dma, soff, doff, big[i]);
+                g_dma_busy = 0;
+            }
+        }
+        for (n = 0; n <= 300; n++) err_cpu += check_set(mymemset, soff, n);
+        for (i = 0; i < sizeof(big) / sizeof(big[0]); i++) {
+            err_cpu += check_set(mymemset, soff, big[i]);
+            err_dma += check_set(mymemset_dma, soff, big[i]);
+            g_dma_busy = 1;
+            err_fb += check_set(mymemset_dma, soff, big[i]);
+            g_dma_busy = 0;
+        }
+    }
+    printf("正确性: CPU路径 %s, DMA路径 %s (DMA传输 %u 字节, 非法请求 %u), 通道忙退回 %s\n",
+           err_cpu ? "失败" : "通过", err_dma ? "失败" : "通过", g_dma_bytes, g_dma_errors,
+           err_fb ? "失败" : "通过");
+}
+
+/* ==================== 吞吐量 ==================== */
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void test_throughput(void)
+{
+    static const uint32_t sizes[] = {64, 1024, 16 * 1024, 64 * 1024 - 8};
+    uint32_t i, k, reps;
+    double t0, t1, t2, t3, t4;
+
+    printf("\n吞吐量 (MB/s)     长度   原memcpy   mymemcpy   原memset   mymemset\n");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        reps = (64u * 1024 * 1024) / sizes[i];
+        t0 = now_s();
+        for (k = 0; k < reps; k++) legacy_memcpy(g_dst + 8, g_src + 8, sizes[i]);
+        t1 = now_s();
+        for (k = 0; k < reps; k++) mymemcpy(g_dst + 8, g_src + 8, sizes[i]);
+        t2 = now_s();
+        for (k = 0; k < reps; k++) legacy_memset(g_dst + 8, (uint8_t)k, sizes[i]);
+        t3 = now_s();
+        for (k = 0; k < reps; k++) mymemset(g_dst + 8, (uint8_t)k, sizes[i]);
+        t4 = now_s();
+        printf("               %8u %10.0f %10.0f %10.0f %10.0f\n", sizes[i],
+               64.0 / (t1 - t0), 64.0 / (t2 - t1), 64.0 / (t3 - t2), 64.0 / (t4 - t3));
+    }
+}
+
+int main(void)
+{
+    srand(1);
+    test_correctness();
+    test_throughput();
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ ****************************************************************************************************
+ * @file        memstage_test.c
+ * @brief       分级内存搬运 (memstage.c) 正确性测试 (主机编译)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -pthread -DMEM_HOST_BUILD -Imiddleware/MALLOC test/malloc/memstage_test.c \
+ *       test/malloc/dma_stub.c middleware/MALLOC/memstage.c middleware/MALLOC/malloc.c \
+ *       middleware/MALLOC/mem_tlsf.c middleware/MALLOC/mem_tag.c -o memstage_test && ./memstage_test
+ *
+ * 主机上没有DMA2, 由 dma_stub.c 代替 driver/DMA/dma.c; 置 g_dma_defer 后传输推迟到 dma_m2m_wait
+ * 时才完成, 这样队列里会真的积压多个搬运, 能检查执行顺序.
+ *   预取/写回 : 源/目的 0~7 字节偏移 × 跨越DMA门限的长度, 同步和推迟两种完成方式, 检查前后保护区
+ *   顺序      : 写回缓冲区后立即提交预取到同一缓冲区, 写回必须拿到旧数据;
+ *               完成回调里启动下一个失败时, 下一个以错误结束且不写任何数据
+ *   流        : RD / WR / RW 三种模式, 块长不整除数组长, 以及中途关闭
+ *   退回CPU   : 通道被占用时全部由CPU完成
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "malloc.h"
+#include "memstage.h"
+
+/* DMA 桩实现 (dma_stub.c) 的控制变量 */
+extern uint8_t g_dma_busy;
+extern uint8_t g_dma_defer;
+extern uint32_t g_dma_bytes;
+extern uint32_t g_dma_errors;
+
+#define GUARD       16
+#define BUF_MAX     (16 * 1024)
+#define ARR_SIZE    (100 * 1000 + 3)                                        /* 流测试数组 (外扩SRAM中) */
+
+static uint8_t g_src[BUF_MAX + 2 * GUARD] __attribute__((aligned(32)));
+static uint8_t g_dst[BUF_MAX + 2 * GUARD] __attribute__((aligned(32)));
+static uint8_t g_ref[BUF_MAX + 2 * GUARD] __attribute__((aligned(32)));
+
+/* ==================== 预取/写回 ==================== */
+static uint32_t check_xfer(uint8_t wb, uint32_t soff, uint32_t doff, uint32_t n)
+{
+    mymem_xfer_t x;
+
+    memset(g_dst, 0xA5, sizeof(g_dst));
+    memcpy(g_ref, g_dst, sizeof(g_ref));
+    memcpy(g_ref + GUARD + doff, g_src + GUARD + soff, n);
+
+    if (wb) mymem_writeback(&x, g_dst + GUARD + doff, g_src + GUARD + soff, n);
+    else mymem_prefetch(&x, g_dst + GUARD + doff, g_src + GUARD + soff, n);
+
+    if (mymem_xfer_wait(&x) || !mymem_xfer_done(&x)) return 1;
+    return memcmp(g_dst, g_ref, sizeof(g_dst)) != 0;
+}
+
+static uint32_t test_xfer(void)
+{
+    static const uint32_t len[] = {0, 1, MEM_STAGE_DMA_MIN - 1, MEM_STAGE_DMA_MIN, MEM_STAGE_DMA_MIN + 3, 1001, BUF_MAX - 8};
+    uint32_t soff, doff, i, err = 0;
+
+    for (soff = 0; soff < 8; soff++) {
+        for (doff = 0; doff < 8; doff++) {
+            for (i = 0; i < sizeof(len) / sizeof(len[0]); i++) {
+                err += check_xfer(0, soff, doff, len[i]);
+                err += check_xfer(1, soff, doff, len[i]);
+                g_dma_defer = 1;
+                err += check_xfer(0, soff, doff, len[i]);
+                g_dma_defer = 0;
+            }
+        }
+    }
+    return err;
+}
+
+/* ==================== 顺序 ==================== */
+static uint32_t test_order(void)
+{
+    static uint8_t ext_a[4096], ext_b[4096], buf[4096];
+    mymem_xfer_t x[3];
+    uint32_t err = 0;
+
+    memset(ext_a, 0x11, sizeof(ext_a));
+    memset(ext_b, 0x22, sizeof(ext_b));
+    memset(buf, 0x33, sizeof(buf));
+
+    g_dma_defer = 1;
+    mymem_writeback(&x[0], ext_a, buf, sizeof(buf));                       /* buf -> A */
+    mymem_prefetch(&x[1], buf, ext_b, sizeof(buf));                        /* B -> buf, 必须在上一个之后 */
+    mymem_writeback(&x[2], ext_a + 1, buf + 1, 10);                        /* 走CPU, 必须等前两个完成 */
+    err += x[0].state != MYMEM_XFER_DONE || x[1].state != MYMEM_XFER_DONE; /* CPU路径在提交时同步了队列 */
+    g_dma_defer = 0;
+
+    err += mymem_xfer_wait(&x[2]);
+    err += ext_a[0] != 0x33 || ext_a[1] != 0x22 || ext_a[11] != 0x33 || buf[0] != 0x22;
+
+    g_dma_defer = 1;
+    mymem_prefetch(&x[0], buf, ext_a, sizeof(buf));
+    mymem_prefetch(&x[1], ext_b, ext_a, sizeof(buf));
+    err += x[1].state != MYMEM_XFER_QUEUED;
+    mymem_stage_sync();
+    err += !mymem_xfer_done(&x[0]) || !mymem_xfer_done(&x[1]);
+
+    memset(ext_b, 0x44, sizeof(ext_b));                                     /* 完成中断里启动下一个失败 */
+    mymem_prefetch(&x[0], buf, ext_a, sizeof(buf));
+    mymem_prefetch(&x[1], ext_b + 1, ext_a + 1, sizeof(buf) - 2);
+    g_dma_busy = 1;
+    err += mymem_xfer_wait(&x[0]) != 0;
+    err += mymem_xfer_wait(&x[1]) != 1;                                     /* 报告错误, 首尾也没有写 */
+    err += ext_b[1] != 0x44 || ext_b[sizeof(ext_b) - 2] != 0x44;
+    g_dma_busy = 0;
+    g_dma_defer = 0;
+    return err;
+}
+
+/* ==================== 流 ==================== */
+static uint32_t test_stream(uint8_t mode, uint32_t tile, uint32_t stop)
+{
+    uint8_t *ext = (uint8_t *)mymalloc(SRAMEX, ARR_SIZE);
+    mymem_stream_t *s;
+    uint8_t *p;
+    uint32_t i, k, err = 0, blocks = 0, done = 0;
+
+    if (ext == NULL) return 1;
+    for (i = 0; i < ARR_SIZE; i++) ext[i] = (uint8_t)(i * 7);
+
+    s = mymem_stream_open(ext, ARR_SIZE, tile, SRAMIN, mode);
+    if (s == NULL) {
+        myfree(SRAMEX, ext);
+        return 1;
+    }
+
+    while ((p = (uint8_t *)mymem_stream_next(s)) != NULL) {
+        if (s->pos != done) err++;
+        for (k = 0; k < s->len; k++) {
+            if ((mode & MYMEM_STREAM_RD) && p[k] != (uint8_t)((s->pos + k) * 7)) err++;
+            p[k] = (uint8_t)((s->pos + k) * 7 + 1);
+        }
+        done += s->len;
+        if (++blocks == stop) break;
+    }
+    err += mymem_stream_close(s);
+
+    for (i = 0; i < ARR_SIZE; i++) {                                       /* 处理过的块是否写回, 其余是否未动 */
+        k = (mode & MYMEM_STREAM_WR) && i < done ? 1 : 0;
+        if (ext[i] != (uint8_t)(i * 7 + k)) err++;
+    }
+    if (stop == 0 && done != ARR_SIZE) err++;
+
+    myfree(SRAMEX, ext);
+    return err;
+}
+
+static uint32_t test_streams(void)
+{
+    static const uint8_t modes[] = {MYMEM_STREAM_RD, MYMEM_STREAM_WR, MYMEM_STREAM_RW};
+    static const uint32_t tiles[] = {4096, 3000, 61, 65536};
+    uint32_t m, t, err = 0;
+
+    for (m = 0; m < 3; m++) {
+        for (t = 0; t < sizeof(tiles) / sizeof(tiles[0]); t++) {
+            err += test_stream(modes[m], tiles[t], 0);
+            err += test_stream(modes[m], tiles[t], 3);
+            g_dma_defer = 1;
+            err += test_stream(modes[m], tiles[t], 0);
+            err += test_stream(modes[m], tiles[t], 3);
+            g_dma_defer = 0;
+        }
+    }
+    return err;
+}
+
+int main(void)
+{
+    uint32_t i, e_xfer, e_order, e_stream, e_fb, bytes;
+
+    my_mem_init(SRAMIN);
+    my_mem_init(SRAMEX);
+    srand(1);
+    for (i = 0; i < sizeof(g_src); i++) g_src[i] = (uint8_t)rand();
+
+    e_xfer = test_xfer();
+    e_order = test_order();
+    e_stream = test_streams();
+    bytes = g_dma_bytes;
+
+    g_dma_busy = 1;                                                         /* 通道被占用: 全部退回CPU */
+    e_fb = test_xfer() + test_streams();
+    g_dma_busy = 0;
+
+    printf("预取/写回 %s, 顺序 %s, 流 %s (DMA传输 %u 字节, 非法请求 %u), 通道忙退回 %s\n",
+           e_xfer ? "失败" : "通过", e_order ? "失败" : "通过", e_stream ? "失败" : "通过",
+           bytes, g_dma_errors, e_fb ? "失败" : "通过");
+    printf("内存池使用率: SRAMIN %u%%, SRAMEX %u%%\n", my_mem_perused(SRAMIN) / 10, my_mem_perused(SRAMEX) / 10);
+    return e_xfer || e_order || e_stream || e_fb || g_dma_errors;
+}
@@ -0,0 +1,182 @@
+/**
+ ****************************************************************************************************
+ * @file        realloc_bench.c
+ * @brief       myrealloc 增长模式基准测试 (主机编译): 原地调整 与 原"申请-拷贝-释放"实现 对比
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -pthread -DMEM_HOST_BUILD -Imiddleware/MALLOC test/malloc/realloc_bench.c test/malloc/dma_stub.c \
+ *       middleware/MALLOC/malloc.c middleware/MALLOC/mem_tlsf.c -o realloc_bench && ./realloc_bench
+ *
+ * 每个内存池上执行以下增长模式, 统计总耗时、原地完成次数和拷贝字节数:
+ *   小步增长: 缓冲区每次增加 step 字节直到上限 (协议缓冲区的典型用法)
+ *   倍增增长: 每次容量翻倍
+ *   交错增长: 两个缓冲区交替小步增长 (互相阻挡, 原地扩大经常失败)
+ *   先增后缩: 小步增长到上限后再小步缩小
+ * 原实现按旧 myrealloc 代码原样复制 (总是重新申请, 按新长度逐字节拷贝).
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "malloc.h"
+
+extern const uint32_t memsize[SRAMBANK];
+
+typedef void *(*realloc_fn)(uint8_t memx, void *ptr, uint32_t size);
+
+static uint32_t g_inplace;                                                  /* 原地完成次数 */
+static uint32_t g_calls;                                                    /* 调用次数 */
+
+/**
+ * @brief   旧 myrealloc 实现
+ */
+static void *legacy_realloc(uint8_t memx, void *ptr, uint32_t size)
+{
+    uint8_t *newptr, *xsrc = (uint8_t *)ptr;
+    uint32_t n = size;
+    if (ptr == NULL) return mymalloc(memx, size);
+    if (size == 0) {
+        myfree(memx, ptr);
+        return NULL;
+    }
+    newptr = mymalloc(memx, size);
+    if (newptr) {
+        while (n--) newptr[n] = xsrc[n];                                    /* 原 mymemcpy 为逐字节拷贝 */
+        myfree(memx, ptr);
+    }
+    return newptr;
+}
+
+/**
+ * @brief   调用并统计是否原地完成
+ */
+static void *bench_call(realloc_fn fn, uint8_t memx, void *ptr, uint32_t size)
+{
+    void *p = fn(memx, ptr, size);
+    g_calls++;
+    if (p && p == ptr) g_inplace++;
+    return p;
+}
+
+static double bench_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* ==================== 增长模式 ==================== */
+static void pattern_step(realloc_fn fn, uint8_t memx, uint32_t limit, uint32_t step)
+{
+    uint32_t size;
+    void *p = NULL;
+    for (size = step; size <= limit; size += step) p = bench_call(fn, memx, p, size);
+    myfree(memx, p);
+}
+
+static void pattern_double(realloc_fn fn, uint8_t memx, uint32_t limit, uint32_t step)
+{
+    uint32_t size;
+    void *p = NULL;
+    for (size = step; size <= limit; size *= 2) p = bench_call(fn, memx, p, size);
+    myfree(memx, p);
+}
+
+static void pattern_interleave(realloc_fn fn, uint8_t memx, uint32_t limit, uint32_t step)
+{
+    uint32_t size;
+    void *a = NULL, *b = NULL;
+    for (size = step; size <= limit / 2; size += step) {
+        a = bench_call(fn, memx, a, size);
+        b = bench_call(fn, memx, b, size);
+    }
+    myfree(memx, a);
+    myfree(memx, b);
+}
+
+static void pattern_shrink(realloc_fn fn, uint8_t memx, uint32_t limit, uint32_t step)
+{
+    uint32_t size;
+    void *p = NULL;
+    for (size = step; size <= limit; size += step) p = bench_call(fn, memx, p, size);
+    for (size = limit; size >= step; size -= step) p = bench_call(fn, memx, p, size);
+    myfree(memx, p);
+}
+
+typedef struct
+{
+    const char *name;
+    void (*run)(realloc_fn fn, uint8_t memx, uint32_t limit, uint32_t step);
+} bench_pattern_t;
+
+static const bench_pattern_t pattern[] = {
+    {"小步增长", pattern_step},
+    {"倍增增长", pattern_double},
+    {"交错增长", pattern_interleave},
+    {"先增后缩", pattern_shrink},
+};
+
+static void bench_one(const bench_pattern_t *pt, realloc_fn fn, uint8_t memx, uint32_t limit, uint32_t step)
+{
+    double t0, t1;
+    my_mem_init(memx);
+    g_inplace = 0;
+    g_calls = 0;
+    t0 = bench_now_ms();
+    pt->run(fn, memx, limit, step);
+    t1 = bench_now_ms();
+    printf("    %-8s %-10s %9.3f ms   原地 %5u / %5u 次\n", pt->name,
+           fn == myrealloc ? "myrealloc" : "原实现", t1 - t0, g_inplace, g_calls);
+    if (my_mem_perused(memx) != 0) printf("    !! 内存泄漏\n");
+}
+
+/**
+ * @brief   正确性检查: 扩大/缩小后原有数据保持不变
+ */
+static void bench_check(uint8_t memx)
+{
+    uint8_t *p = NULL, *q;
+    uint32_t size, i, err = 0;
+    my_mem_init(memx);
+    q = mymalloc(memx, 64);                                                 /* 中途插入阻挡块, 迫使一次搬移 */
+    for (size = 16; size <= 4096; size += 16) {
+        p = myrealloc(memx, p, size);
+        for (i = 0; i < size - 16; i++) if (p[i] != (uint8_t)i) err++;
+        for (i = size - 16; i < size; i++) p[i] = (uint8_t)i;
+        if (size == 1024) {
+            myfree(memx, q);
+            q = mymalloc(memx, 32);
+        }
+    }
+    for (size = 4096; size >= 16; size -= 16) {
+        p = myrealloc(memx, p, size);
+        for (i = 0; i < size; i++) if (p[i] != (uint8_t)i) err++;
+    }
+    myfree(memx, p);
+    myfree(memx, q);
+    printf("  数据校验: %s\n", (err || my_mem_perused(memx)) ? "失败" : "通过");
+}
+
+int main(void)
+{
+    static const char *name[SRAMBANK] = {"SRAMIN", "SRAMCCM", "SRAMEX"};
+    static const uint32_t limit[SRAMBANK] = {32 * 1024, 16 * 1024, 256 * 1024};
+    static const uint32_t step[SRAMBANK] = {16, 16, 64};
+    uint8_t memx;
+    uint32_t i;
+
+    my_mem_cache_enable(0);                                                 /* 只测分配引擎本身 */
+    for (memx = 0; memx < SRAMBANK; memx++) {
+        printf("%s: 上限 %u 字节, 步长 %u 字节\n", name[memx], limit[memx], step[memx]);
+        bench_check(memx);
+        for (i = 0; i < sizeof(pattern) / sizeof(pattern[0]); i++) {
+            bench_one(&pattern[i], legacy_realloc, memx, limit[memx], step[memx]);
+            bench_one(&pattern[i], myrealloc, memx, limit[memx], step[memx]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ ****************************************************************************************************
+ * @file        tlsf_test.c
+ * @brief       内存池分配引擎 (mem_tlsf.c) 正确性测试 (主机编译)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 -DMEM_HOST_BUILD -Imiddleware/MALLOC test/malloc/tlsf_test.c middleware/MALLOC/mem_tlsf.c \
+ *       -o tlsf_test && ./tlsf_test
+ *
+ *   同级别: 请求所在级别有5个空闲段, 只有最后挂入链表的那个够用 (前4个各短1块), 分配必须成功
+ *   随机  : 随机 分配/释放/原地调整, 定期按占用位图逐块统计最大连续空闲, 与 mem_tlsf_largest 比较,
+ *           并且申请该大小必须成功 (申请后立即释放)
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include "mem_tlsf.h"
+
+#define T_BLKSIZE       32
+#define T_NBLOCKS       4096
+#define T_SLOTS         256
+#define T_EVENTS        200000
+
+static uint8_t g_pool[T_NBLOCKS * T_BLKSIZE] __attribute__((aligned(32)));
+static uint32_t g_map[MEM_TLSF_MAP_WORDS(T_NBLOCKS)];
+static mem_tlsf_t g_tlsf;
+static uint32_t g_slot[T_SLOTS];
+static uint32_t g_rng = 1;
+
+static uint32_t rnd(void)
+{
+    g_rng = g_rng * 1664525 + 1013904223;
+    return g_rng >> 8;
+}
+
+/* 按占用位图逐块统计的最大连续空闲块数 */
+static uint32_t largest_ref(mem_tlsf_t *t)
+{
+    uint32_t i, run = 0, max = 0;
+
+    for (i = 0; i < t->nblocks; i++) {
+        if ((t->usedmap[i >> 5] >> (i & 31)) & 1) run = 0;
+        else if (++run > max) max = run;
+    }
+    return max;
+}
+
+/* ==================== 同级别 ==================== */
+static uint32_t test_same_class(void)
+{
+    static const uint32_t len[] = {21, 20, 20, 20, 20};                    /* 20~21块在同一级别 */
+    uint32_t idx[5], sep[5], rest, i, got, err = 0;
+
+    mem_tlsf_init(&g_tlsf, g_pool, g_map, T_BLKSIZE, T_NBLOCKS);
+    for (i = 0; i < 5; i++) {
+        idx[i] = mem_tlsf_alloc(&g_tlsf, len[i]);
+        sep[i] = mem_tlsf_alloc(&g_tlsf, 1);                                /* 隔开, 释放后不合并 */
+    }
+    rest = mem_tlsf_alloc(&g_tlsf, g_tlsf.nblocks - g_tlsf.used);
+    err += rest == MEM_TLSF_NONE;
+    for (i = 0; i < 5; i++) mem_tlsf_free(&g_tlsf, idx[i]);                 /* 21块的段最先挂入, 排在链表最后 */
+
+    err += mem_tlsf_largest(&g_tlsf) != 21;
+    got = mem_tlsf_alloc(&g_tlsf, 21);
+    err += got != idx[0];
+    err += mem_tlsf_largest(&g_tlsf) != 20;
+    err += mem_tlsf_alloc(&g_tlsf, 21) != MEM_TLSF_NONE;                    /* 确实没有够用的了 */
+
+    (void)sep;
+    return err;
+}
+
+/* ==================== 随机 ==================== */
+static uint32_t test_random(void)
+{
+    uint32_t t, k, n, ref, err = 0, checks = 0;
+
+    mem_tlsf_init(&g_tlsf, g_pool, g_map, T_BLKSIZE, T_NBLOCKS);
+    for (k = 0; k < T_SLOTS; k++) g_slot[k] = MEM_TLSF_NONE;
+
+    for (t = 0; t < T_EVENTS; t++) {
+        k = rnd() % T_SLOTS;
+        n = (rnd() % 8 == 0) ? 1 + rnd() % 300 : 1 + rnd() % 24;
+        if (g_slot[k] == MEM_TLSF_NONE) {
+            g_slot[k] = mem_tlsf_alloc(&g_tlsf, n);
+        } else if (rnd() % 4 == 0) {
+            mem_tlsf_resize(&g_tlsf, g_slot[k], n);
+        } else {
+            mem_tlsf_free(&g_tlsf, g_slot[k]);
+            g_slot[k] = MEM_TLSF_NONE;
+        }
+
+        if (t % 97 == 0) {
+            ref = largest_ref(&g_tlsf);
+            err += mem_tlsf_largest(&g_tlsf) != ref;
+            if (ref) {
+                n = mem_tlsf_alloc(&g_tlsf, ref);
+                if (n == MEM_TLSF_NONE) err++;
+                else mem_tlsf_free(&g_tlsf, n);
+            }
+            checks++;
+        }
+    }
+
+    printf("随机: 检查 %u 次\n", checks);
+    return err;
+}
+
+int main(void)
+{
+    uint32_t e_class, e_random;
+
+    e_class = test_same_class();
+    e_random = test_random();
+
+    printf("同级别 %s, 随机 %s\n", e_class ? "失败" : "通过", e_random ? "失败" : "通过");
+    return e_class || e_random;
+}
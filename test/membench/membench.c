@@ -0,0 +1,179 @@
+/**
+ ****************************************************************************************************
+ * @file        membench.c
+ * @brief       各存储区 带宽/延迟 基准测试 (板上运行): SRAM1 / SRAM2 / CCM / 外扩SRAM / FLASH / LCD GRAM
+ ****************************************************************************************************
+ * @attention
+ *
+ * 使用: 把 membench.c、membench_kern.c 加入工程, 在 lcd_init / sram_init / dma_m2m_init / my_mem_init
+ *       之后调用 membench(), 结果经串口1输出. 最好在启动调度器之前调用, 或在任务中挂起调度器前后调用,
+ *       否则任务切换和中断会计入测得的时间.
+ *
+ * 用 DWT 周期计数器计时. 各存储区的测试缓冲区 MB_SIZE 字节:
+ *   SRAM1 / SRAM2 : 从 SRAMIN 内存池申请, 反复申请直到落在对应地址范围内 (申请不到则跳过)
+ *   CCM / SRAMEX  : 从各自内存池申请; CCM不能DMA
+ *   FLASH         : 从 0x08000000 开始的 MB_SIZE 字节, 只读; 分 ART加速器(预取+指令/数据缓存) 开/关 两行,
+ *                   关闭时测试程序本身也从flash无缓存取指, 反映的是整体效果
+ *   LCD GRAM      : 写GRAM端口 (固定地址) MB_SIZE 字节, 32位写由FSMC拆成两个像素; 读为读GRAM命令后的
+ *                   端口读, 只反映总线速度. 测完后屏幕左上角是乱的, 需要重画
+ * dma rd / dma wr 为 DMA2 (DMA_M2M_CH_MEM) 该区 <-> SRAM1 的32位传输 (GRAM为16位、目的地址固定),
+ * 从启动到完成的时间.
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include "../../driver/LCD/lcd.h"
+#include "../../driver/DMA/dma.h"
+#include "../../middleware/MALLOC/malloc.h"
+#include "./membench.h"
+
+#define MB_SIZE                 8192                                        /* 每个区的测试字节数 (2的幂) */
+#define MB_ALLOC_TRIES          32                                          /* 在指定地址范围内申请的最多次数 */
+
+#define MB_SRAM1_BASE           0x20000000                                  /* SRAM1: 112KB */
+#define MB_SRAM2_BASE           0x2001C000                                  /* SRAM2: 16KB */
+#define MB_SRAM2_END            0x20020000
+
+uint32_t g_mb_tick_hz;
+uint32_t g_mb_cpu_hz;
+
+uint32_t mb_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief       从 SRAMIN 申请一块完全落在 [lo, hi) 内的内存
+ * @note        申请到范围外的先留着 (迫使下次申请换位置), 最后全部释放
+ * @retval      内存地址, NULL: 申请不到
+ */
+static void *mb_alloc_in(uint32_t lo, uint32_t hi, uint32_t size)
+{
+    void *p[MB_ALLOC_TRIES], *hit = NULL;
+    uint32_t i, n;
+
+    for (n = 0; n < MB_ALLOC_TRIES; n++) {
+        p[n] = mymalloc(SRAMIN, size);
+
+        if (p[n] == NULL) break;
+
+        if ((uint32_t)p[n] >= lo && (uint32_t)p[n] + size <= hi) {
+            hit = p[n];
+            break;
+        }
+    }
+
+    for (i = 0; i < n; i++) myfree(SRAMIN, p[i]);
+
+    return hit;
+}
+
+/**
+ * @brief       DMA 该区 <-> SRAM1 的传输速率
+ * @param       r       : 存储区
+ * @param       scratch : SRAM1 中的 MB_SIZE 字节缓冲区
+ * @param       res     : 填 dma_rd / dma_wr
+ */
+static void mb_run_dma(const mb_region_t *r, void *scratch, mb_result_t *res)
+{
+    uint32_t t0, k, t_rd = 0, t_wr = 0;
+    uint8_t ok_rd = 1, ok_wr = 1;
+
+    if (r->buf == NULL || (r->flags & MB_NODMA)) return;
+
+    for (k = 0; k < MB_ROUNDS; k++) {
+        if (r->flags & MB_PORT) {
+            t0 = mb_now();
+            ok_wr &= dma_m2m_xfer(DMA_M2M_CH_MEM, r->buf, scratch, MB_SIZE, DMA_M2M_HALFWORD | DMA_M2M_DST_FIXED) == DMA_M2M_OK;
+            t_wr += mb_now() - t0;
+            continue;
+        }
+
+        t0 = mb_now();
+        ok_rd &= dma_m2m_xfer(DMA_M2M_CH_MEM, scratch, r->buf, MB_SIZE, DMA_M2M_WORD) == DMA_M2M_OK;
+        t_rd += mb_now() - t0;
+
+        if (r->flags & MB_RO) continue;
+
+        t0 = mb_now();
+        ok_wr &= dma_m2m_xfer(DMA_M2M_CH_MEM, r->buf, scratch, MB_SIZE, DMA_M2M_WORD) == DMA_M2M_OK;
+        t_wr += mb_now() - t0;
+    }
+
+    if (t_rd && ok_rd) res->dma_rd = mb_rate(MB_SIZE * MB_ROUNDS, t_rd);
+    if (t_wr && ok_wr) res->dma_wr = mb_rate(MB_SIZE * MB_ROUNDS, t_wr);
+}
+
+/**
+ * @brief       运行全部测试, 结果输出到串口1
+ * @param       无
+ * @retval      无
+ */
+void membench(void)
+{
+    mb_region_t r[7] = {
+        {"SRAM1",       NULL, MB_SIZE, 0},
+        {"SRAM2",       NULL, MB_SIZE, 0},
+        {"CCM",         NULL, MB_SIZE, MB_NODMA},
+        {"SRAMEX",      NULL, MB_SIZE, 0},
+        {"FLASH ART",   (void *)FLASH_BASE, MB_SIZE, MB_RO},
+        {"FLASH noART", (void *)FLASH_BASE, MB_SIZE, MB_RO},
+        {"LCD GRAM",    (void *)&LCD->LCD_RAM, MB_SIZE, MB_PORT},
+    };
+    mb_result_t res;
+    uint32_t acr, i;
+    void *scratch;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    g_mb_tick_hz = SystemCoreClock;
+    g_mb_cpu_hz = SystemCoreClock;
+
+    scratch = mb_alloc_in(MB_SRAM1_BASE, MB_SRAM2_BASE, MB_SIZE);           /* DMA的另一端, 先占用, 避免SRAM1测试区与之重叠 */
+    r[0].buf = mb_alloc_in(MB_SRAM1_BASE, MB_SRAM2_BASE, MB_SIZE);
+    r[1].buf = mb_alloc_in(MB_SRAM2_BASE, MB_SRAM2_END, MB_SIZE);
+    r[2].buf = mymalloc(SRAMCCM, MB_SIZE);
+    r[3].buf = mymalloc(SRAMEX, MB_SIZE);
+
+    if (scratch == NULL) {
+        printf("membench: 内存不足\r\n");
+        goto out;
+    }
+
+    printf("\r\n存储区带宽/延迟, HCLK %u MHz, FLASH %u 等待周期, 每项 %u 字节 x %u 次\r\n",
+           SystemCoreClock / 1000000, (uint32_t)(FLASH->ACR & FLASH_ACR_LATENCY), MB_SIZE, MB_ROUNDS);
+    mb_print_head();
+
+    for (i = 0; i < 7; i++) {
+        acr = FLASH->ACR;
+
+        if (i == 5) {                                                       /* 关闭 ART: 预取 + 指令/数据缓存 */
+            FLASH->ACR = acr & ~(FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+        }
+
+        if (r[i].flags & MB_PORT) {
+            lcd_set_cursor(0, 0);
+            lcd_write_ram_prepare();
+        }
+
+        mb_run(&r[i], &res);
+        mb_run_dma(&r[i], scratch, &res);
+
+        if (i == 5) {                                                       /* 复位缓存后恢复 */
+            FLASH->ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+            FLASH->ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+            FLASH->ACR = acr;
+        }
+
+        mb_print(&r[i], &res);
+    }
+
+out:
+    myfree(SRAMIN, scratch);
+    myfree(SRAMIN, r[0].buf);
+    myfree(SRAMIN, r[1].buf);
+    myfree(SRAMCCM, r[2].buf);
+    myfree(SRAMEX, r[3].buf);
+}
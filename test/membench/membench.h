@@ -0,0 +1,90 @@
+/**
+ ****************************************************************************************************
+ * @file        membench.h
+ * @brief       各存储区 带宽/延迟 基准测试: 公共测试核 (板上和主机共用)
+ ****************************************************************************************************
+ * @attention
+ *
+ * membench_kern.c 是与平台无关的测试核和结果表输出, 板上由 membench.c 提供计时 (DWT) 和各存储区,
+ * 主机由 membench_host.c 提供 (clock_gettime + malloc 缓冲区), 两边跑的是同一份测试核.
+ *
+ * 每个存储区测:
+ *   rd8/16/32, wr8/16/32 : 顺序读/写, 按指定宽度 volatile 访问 (不会被编译器合并或换成库函数)
+ *   copy                 : 区内32位拷贝 (前半 -> 后半)
+ *   rnd rd / rnd wr      : 随机地址32位读/写 (线性同余生成下标, 各访问互不依赖)
+ *   lat                  : 单次访问延迟, 随机环形链表追指针 (每次读依赖上一次读出的地址)
+ *   dma rd / dma wr      : (仅板上) 该区 -> SRAM1 / SRAM1 -> 该区 的DMA2传输
+ * 带宽单位 MB/s (1MB = 10^6 字节), 延迟单位 ns 和 CPU周期.
+ *
+ ****************************************************************************************************
+ */
+
+#ifndef __MEMBENCH_H
+#define __MEMBENCH_H
+
+#include <stdint.h>
+
+#define MB_ROUNDS               4                                           /* 每项重复次数 */
+
+/* 存储区属性 */
+#define MB_RO                   0x01                                        /* 只读 (flash): 不测写/拷贝 */
+#define MB_PORT                 0x02                                        /* 固定地址数据端口 (LCD GRAM): 只测顺序读写 */
+#define MB_NODMA                0x04                                        /* DMA不可访问 (CCM) */
+
+/* 结果中未测的项 */
+#define MB_NA                   0xFFFFFFFF
+
+typedef struct
+{
+    const char *name;                                                       /* 名称 */
+    void *buf;                                                              /* 测试缓冲区 (NULL: 跳过) */
+    uint32_t size;                                                          /* 字节数, 2的幂; MB_PORT 时为每项访问的字节数 */
+    uint8_t flags;                                                          /* MB_RO / MB_PORT / MB_NODMA */
+} mb_region_t;
+
+/* 带宽为 MB/s x10, 延迟为 ns x10 / 周期 x10 */
+typedef struct
+{
+    uint32_t rd[3];                                                         /* 8/16/32位顺序读 */
+    uint32_t wr[3];                                                         /* 8/16/32位顺序写 */
+    uint32_t copy;                                                          /* 区内拷贝 */
+    uint32_t rnd_rd;                                                        /* 随机读 */
+    uint32_t rnd_wr;                                                        /* 随机写 */
+    uint32_t lat_ns;                                                        /* 延迟 (ns) */
+    uint32_t lat_cyc;                                                       /* 延迟 (CPU周期) */
+    uint32_t dma_rd;                                                        /* DMA 该区 -> SRAM1 */
+    uint32_t dma_wr;                                                        /* DMA SRAM1 -> 该区 */
+} mb_result_t;
+
+/* 由平台提供 */
+uint32_t mb_now(void);                                                      /* 当前计时值 (32位, 回绕) */
+extern uint32_t g_mb_tick_hz;                                               /* 计时频率 */
+extern uint32_t g_mb_cpu_hz;                                                /* CPU频率, 0: 未知 (不输出周期数) */
+
+/* 测试核 */
+uint32_t mb_read8(const void *buf, uint32_t bytes);
+uint32_t mb_read16(const void *buf, uint32_t bytes);
+uint32_t mb_read32(const void *buf, uint32_t bytes);
+void mb_write8(void *buf, uint32_t bytes, uint32_t v);
+void mb_write16(void *buf, uint32_t bytes, uint32_t v);
+void mb_write32(void *buf, uint32_t bytes, uint32_t v);
+void mb_copy32(void *des, const void *src, uint32_t bytes);
+uint32_t mb_rand_read32(const void *buf, uint32_t bytes, uint32_t n, uint32_t seed);
+void mb_rand_write32(void *buf, uint32_t bytes, uint32_t n, uint32_t seed);
+void mb_chase_init(void *buf, uint32_t bytes, uint32_t seed);
+void *mb_chase(void *p, uint32_t n);
+uint32_t mb_port_read16(const void *port, uint32_t n);
+uint32_t mb_port_read32(const void *port, uint32_t n);
+void mb_port_write16(void *port, uint32_t n, uint32_t v);
+void mb_port_write32(void *port, uint32_t n, uint32_t v);
+
+uint32_t mb_rate(uint32_t bytes, uint32_t ticks);                           /* 字节数/计时值 -> MB/s x10 */
+void mb_run(const mb_region_t *r, mb_result_t *res);                        /* 跑完一个区的CPU测试项 (dma项置 MB_NA) */
+void mb_print_head(void);
+void mb_print(const mb_region_t *r, const mb_result_t *res);
+
+extern volatile uint32_t g_mb_sink;                                         /* 读测试结果写到这里, 防止被优化掉 */
+
+void membench(void);                                                        /* 板上入口 (membench.c) */
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ ****************************************************************************************************
+ * @file        membench_host.c
+ * @brief       各存储区 带宽/延迟 基准测试: 主机版本 (测试核回归基线)
+ ****************************************************************************************************
+ * @attention
+ *
+ * 编译运行 (在仓库根目录):
+ *   gcc -O2 test/membench/membench_host.c test/membench/membench_kern.c -o membench && ./membench
+ *
+ * 与板上 membench() 跑同一份测试核 (membench_kern.c), 用 clock_gettime 计时, 缓冲区为 malloc 申请的
+ * 几种大小 (大致对应 L1 / L2 / 主存), 外加一个固定地址变量模拟数据端口. 主机没有 DMA, dma 两列为 "-",
+ * 也不知道CPU频率, 延迟只给 ns. 修改测试核或编译选项后, 对比前后的输出即可发现测试核本身的变化.
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "./membench.h"
+
+uint32_t g_mb_tick_hz = 1000000000;
+uint32_t g_mb_cpu_hz = 0;
+
+static volatile uint32_t g_port;                                            /* 模拟数据端口 */
+
+uint32_t mb_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+int main(void)
+{
+    mb_region_t r[4] = {
+        {"host 16K",  NULL, 16 * 1024, 0},
+        {"host 256K", NULL, 256 * 1024, 0},
+        {"host 8M",   NULL, 8 * 1024 * 1024, 0},
+        {"host port", (void *)&g_port, 8192, MB_PORT},
+    };
+    mb_result_t res;
+    int i;
+
+    printf("存储区带宽/延迟 (主机), 每项 x %u 次\r\n", MB_ROUNDS);
+    mb_print_head();
+
+    for (i = 0; i < 4; i++) {
+        if (r[i].buf == NULL) r[i].buf = aligned_alloc(64, r[i].size);
+
+        mb_run(&r[i], &res);
+        mb_print(&r[i], &res);
+    }
+
+    for (i = 0; i < 3; i++) free(r[i].buf);
+    return 0;
+}
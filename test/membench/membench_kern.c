@@ -0,0 +1,323 @@
+/**
+ ****************************************************************************************************
+ * @file        membench_kern.c
+ * @brief       各存储区 带宽/延迟 基准测试: 测试核 与 结果表 (板上和主机共用, 不依赖HAL)
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "./membench.h"
+
+volatile uint32_t g_mb_sink;
+
+/* ==================== 测试核 ==================== */
+
+/* 顺序读: volatile 保证访问宽度和次数, 每次循环展开4次 */
+uint32_t mb_read8(const void *buf, uint32_t bytes)
+{
+    const volatile uint8_t *p = (const volatile uint8_t *)buf;
+    uint32_t s = 0, n = bytes / 4;
+
+    while (n--) {
+        s += p[0]; s += p[1]; s += p[2]; s += p[3];
+        p += 4;
+    }
+    return s;
+}
+
+uint32_t mb_read16(const void *buf, uint32_t bytes)
+{
+    const volatile uint16_t *p = (const volatile uint16_t *)buf;
+    uint32_t s = 0, n = bytes / 8;
+
+    while (n--) {
+        s += p[0]; s += p[1]; s += p[2]; s += p[3];
+        p += 4;
+    }
+    return s;
+}
+
+uint32_t mb_read32(const void *buf, uint32_t bytes)
+{
+    const volatile uint32_t *p = (const volatile uint32_t *)buf;
+    uint32_t s = 0, n = bytes / 16;
+
+    while (n--) {
+        s += p[0]; s += p[1]; s += p[2]; s += p[3];
+        p += 4;
+    }
+    return s;
+}
+
+void mb_write8(void *buf, uint32_t bytes, uint32_t v)
+{
+    volatile uint8_t *p = (volatile uint8_t *)buf;
+    uint32_t n = bytes / 4;
+
+    while (n--) {
+        p[0] = v; p[1] = v; p[2] = v; p[3] = v;
+        p += 4;
+    }
+}
+
+void mb_write16(void *buf, uint32_t bytes, uint32_t v)
+{
+    volatile uint16_t *p = (volatile uint16_t *)buf;
+    uint32_t n = bytes / 8;
+
+    while (n--) {
+        p[0] = v; p[1] = v; p[2] = v; p[3] = v;
+        p += 4;
+    }
+}
+
+void mb_write32(void *buf, uint32_t bytes, uint32_t v)
+{
+    volatile uint32_t *p = (volatile uint32_t *)buf;
+    uint32_t n = bytes / 16;
+
+    while (n--) {
+        p[0] = v; p[1] = v; p[2] = v; p[3] = v;
+        p += 4;
+    }
+}
+
+void mb_copy32(void *des, const void *src, uint32_t bytes)
+{
+    volatile uint32_t *d = (volatile uint32_t *)des;
+    const volatile uint32_t *s = (const volatile uint32_t *)src;
+    uint32_t a, b, c, e, n = bytes / 16;
+
+    while (n--) {
+        a = s[0]; b = s[1]; c = s[2]; e = s[3];                             /* 先连续读再连续写, 与 memcpy 的LDM/STM方式相当 */
+        d[0] = a; d[1] = b; d[2] = c; d[3] = e;
+        s += 4;
+        d += 4;
+    }
+}
+
+#define MB_LCG(x)               ((x) = (x) * 1664525 + 1013904223)
+
+/* 随机读/写: 下标由线性同余生成, 与读出的数据无关, CPU可以连续发出访问 */
+uint32_t mb_rand_read32(const void *buf, uint32_t bytes, uint32_t n, uint32_t seed)
+{
+    const volatile uint32_t *p = (const volatile uint32_t *)buf;
+    uint32_t mask = bytes / 4 - 1, s = 0;
+
+    while (n--) {
+        MB_LCG(seed);
+        s += p[(seed >> 8) & mask];
+    }
+    return s;
+}
+
+void mb_rand_write32(void *buf, uint32_t bytes, uint32_t n, uint32_t seed)
+{
+    volatile uint32_t *p = (volatile uint32_t *)buf;
+    uint32_t mask = bytes / 4 - 1;
+
+    while (n--) {
+        MB_LCG(seed);
+        p[(seed >> 8) & mask] = seed;
+    }
+}
+
+/**
+ * @brief       建立随机环形链表 (Sattolo 洗牌, 保证所有节点在同一个环上)
+ * @note        每个节点是一个指针, 指向下一个节点; 先在原位存下标, 洗牌后再换成地址
+ */
+void mb_chase_init(void *buf, uint32_t bytes, uint32_t seed)
+{
+    uintptr_t *p = (uintptr_t *)buf, t;
+    uint32_t n = bytes / sizeof(uintptr_t), i, j;
+
+    for (i = 0; i < n; i++) p[i] = i;
+
+    for (i = n - 1; i > 0; i--) {
+        MB_LCG(seed);
+        j = (seed >> 8) % i;
+        t = p[i]; p[i] = p[j]; p[j] = t;
+    }
+
+    for (i = 0; i < n; i++) p[i] = (uintptr_t)&p[p[i]];
+}
+
+/* 追指针: 每次读的地址来自上一次读的结果, 测得的是单次访问的完整延迟 */
+void *mb_chase(void *p, uint32_t n)
+{
+    void *volatile *q = (void *volatile *)p;
+
+    while (n--) q = (void *volatile *)*q;
+    return (void *)q;
+}
+
+/* 只读区的相关读: 下一次的下标由这次读出的数据决定 (多一次加法和与运算) */
+static uint32_t mb_dep_read32(const void *buf, uint32_t bytes, uint32_t n)
+{
+    const volatile uint32_t *p = (const volatile uint32_t *)buf;
+    uint32_t mask = bytes / 4 - 1, i = 0;
+
+    while (n--) i = (i + 1 + p[i]) & mask;
+    return i;
+}
+
+/* 固定地址端口: n 次访问同一地址 */
+uint32_t mb_port_read16(const void *port, uint32_t n)
+{
+    const volatile uint16_t *p = (const volatile uint16_t *)port;
+    uint32_t s = 0;
+
+    while (n--) s += *p;
+    return s;
+}
+
+uint32_t mb_port_read32(const void *port, uint32_t n)
+{
+    const volatile uint32_t *p = (const volatile uint32_t *)port;
+    uint32_t s = 0;
+
+    while (n--) s += *p;
+    return s;
+}
+
+void mb_port_write16(void *port, uint32_t n, uint32_t v)
+{
+    volatile uint16_t *p = (volatile uint16_t *)port;
+
+    while (n--) *p = v;
+}
+
+void mb_port_write32(void *port, uint32_t n, uint32_t v)
+{
+    volatile uint32_t *p = (volatile uint32_t *)port;
+
+    while (n--) *p = v;
+}
+
+/* ==================== 测试流程 ==================== */
+
+uint32_t mb_rate(uint32_t bytes, uint32_t ticks)
+{
+    if (ticks == 0) return MB_NA;
+    return (uint32_t)((uint64_t)bytes * g_mb_tick_hz / ticks / 100000);
+}
+
+#define MB_TIME(acc, expr)      do{ t0 = mb_now(); expr; (acc) += mb_now() - t0; }while(0)
+
+/**
+ * @brief       跑一个存储区的全部CPU测试项
+ * @param       r   : 存储区
+ * @param       res : 结果, 不适用的项为 MB_NA
+ */
+void mb_run(const mb_region_t *r, mb_result_t *res)
+{
+    uint32_t t[10], t0, k, n, half = r->size / 2;
+    uint8_t *b = (uint8_t *)r->buf;
+    void *q = b;
+
+    memset(res, 0xFF, sizeof(mb_result_t));
+    memset(t, 0, sizeof(t));
+
+    if (r->buf == NULL) return;
+
+    if (r->flags & MB_PORT) {                                               /* 端口: size 为每项的总字节数 */
+        for (k = 0; k < MB_ROUNDS; k++) {
+            MB_TIME(t[0], g_mb_sink += mb_port_read16(b, r->size / 2));
+            MB_TIME(t[1], g_mb_sink += mb_port_read32(b, r->size / 4));
+            MB_TIME(t[2], mb_port_write16(b, r->size / 2, k));
+            MB_TIME(t[3], mb_port_write32(b, r->size / 4, k));
+        }
+        res->rd[1] = mb_rate(r->size * MB_ROUNDS, t[0]);
+        res->rd[2] = mb_rate(r->size * MB_ROUNDS, t[1]);
+        res->wr[1] = mb_rate(r->size * MB_ROUNDS, t[2]);
+        res->wr[2] = mb_rate(r->size * MB_ROUNDS, t[3]);
+        return;
+    }
+
+    n = r->size / 4;                                                        /* 随机访问次数 */
+
+    for (k = 0; k < MB_ROUNDS; k++) {
+        MB_TIME(t[0], g_mb_sink += mb_read8(b, r->size));
+        MB_TIME(t[1], g_mb_sink += mb_read16(b, r->size));
+        MB_TIME(t[2], g_mb_sink += mb_read32(b, r->size));
+        MB_TIME(t[7], g_mb_sink += mb_rand_read32(b, r->size, n, k));
+
+        if (r->flags & MB_RO) {
+            MB_TIME(t[9], g_mb_sink += mb_dep_read32(b, r->size, n));
+            continue;
+        }
+
+        MB_TIME(t[3], mb_write8(b, r->size, k));
+        MB_TIME(t[4], mb_write16(b, r->size, k));
+        MB_TIME(t[5], mb_write32(b, r->size, k));
+        MB_TIME(t[6], mb_copy32(b + half, b, half));
+        MB_TIME(t[8], mb_rand_write32(b, r->size, n, k));
+    }
+
+    res->rd[0] = mb_rate(r->size * MB_ROUNDS, t[0]);
+    res->rd[1] = mb_rate(r->size * MB_ROUNDS, t[1]);
+    res->rd[2] = mb_rate(r->size * MB_ROUNDS, t[2]);
+    res->rnd_rd = mb_rate(n * 4 * MB_ROUNDS, t[7]);
+
+    if (!(r->flags & MB_RO)) {
+        res->wr[0] = mb_rate(r->size * MB_ROUNDS, t[3]);
+        res->wr[1] = mb_rate(r->size * MB_ROUNDS, t[4]);
+        res->wr[2] = mb_rate(r->size * MB_ROUNDS, t[5]);
+        res->copy = mb_rate(half * MB_ROUNDS, t[6]);
+        res->rnd_wr = mb_rate(n * 4 * MB_ROUNDS, t[8]);
+
+        n = r->size / sizeof(void *);                                       /* 延迟: 整个环走 MB_ROUNDS 圈 */
+        mb_chase_init(b, r->size, 1);
+        MB_TIME(t[9], q = mb_chase(q, n * MB_ROUNDS));
+        g_mb_sink += (uint32_t)(uintptr_t)q;
+    }
+
+    res->lat_ns = (uint32_t)((uint64_t)t[9] * 10000 / (g_mb_tick_hz / 1000000) / (n * MB_ROUNDS));
+
+    if (g_mb_cpu_hz) {
+        res->lat_cyc = (uint32_t)((uint64_t)res->lat_ns * g_mb_cpu_hz / 1000000000);
+    }
+}
+
+/* ==================== 结果表 ==================== */
+
+static void mb_print_val(uint32_t v)
+{
+    if (v == MB_NA) {
+        printf(" %7s", "-");
+    } else {
+        printf(" %5u.%u", v / 10, v % 10);
+    }
+}
+
+void mb_print_head(void)
+{
+    printf("%-12s %7s %7s %7s %7s %7s %7s %7s %7s %7s %7s %7s %7s %7s\r\n", "MB/s", "rd8", "rd16", "rd32",
+           "wr8", "wr16", "wr32", "copy", "rnd rd", "rnd wr", "lat ns", "cyc", "dma rd", "dma wr");
+}
+
+void mb_print(const mb_region_t *r, const mb_result_t *res)
+{
+    printf("%-12s", r->name);
+
+    if (r->buf == NULL) {
+        printf(" (不可用)\r\n");
+        return;
+    }
+
+    mb_print_val(res->rd[0]);
+    mb_print_val(res->rd[1]);
+    mb_print_val(res->rd[2]);
+    mb_print_val(res->wr[0]);
+    mb_print_val(res->wr[1]);
+    mb_print_val(res->wr[2]);
+    mb_print_val(res->copy);
+    mb_print_val(res->rnd_rd);
+    mb_print_val(res->rnd_wr);
+    mb_print_val(res->lat_ns);
+    mb_print_val(res->lat_cyc);
+    mb_print_val(res->dma_rd);
+    mb_print_val(res->dma_wr);
+    printf("\r\n");
+}
@@ -0,0 +1,139 @@
+/**
+ ****************************************************************************************************
+ * @file        sram_bench.c
+ * @brief       外扩SRAM 读写吞吐量测试 (板上运行): 逐字节 / sram_write,sram_read / DMA 对比
+ ****************************************************************************************************
+ * @attention
+ *
+ * 使用: 把本文件加入工程, 在 sram_init / dma_m2m_init / my_mem_init 之后 (任务中或调度器启动前)
+ *       调用 sram_bench(), 结果经串口1输出.
+ *
+ * 每种大小重复 SRAM_BENCH_ROUNDS 次取平均, 用 DWT 周期计数器计时, 换算为 MB/s (HCLK = SystemCoreClock).
+ *   byte       : 原实现的逐字节 volatile 循环
+ *   cpu        : sram_write / sram_read (SRAM端对齐后按32位访问)
+ *   cpu+1      : 同上, 内部缓冲区地址+1 (内部端不对齐, SRAM端仍对齐)
+ *   dma        : sram_write_dma / sram_read_dma + sram_dma_wait, 从启动到完成
+ *   dma(cpu)   : DMA方式中调用者自己花的时间 (启动 + 首尾拷贝), 其余时间CPU可以做别的事
+ * 每项写入后读回校验, 出错时在该项后面标 "!".
+ *
+ ****************************************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "../../driver/SRAM/sram.h"
+#include "../../middleware/MALLOC/malloc.h"
+#include "./sram_bench.h"
+
+#define SRAM_BENCH_ROUNDS       8
+#define SRAM_BENCH_MAX          (32 * 1024)
+
+static const uint32_t g_sizes[] = {16, 64, 256, 1024, 4096, 16384, 32768};
+
+static void bench_dwt_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* 周期数 -> MB/s (x10, 保留一位小数) */
+static uint32_t bench_rate(uint32_t bytes, uint32_t cycles)
+{
+    if (cycles == 0) return 0;
+    return (uint32_t)((uint64_t)bytes * SRAM_BENCH_ROUNDS * (SystemCoreClock / 100000) / cycles);
+}
+
+static void bench_byte_write(uint8_t *pbuf, uint32_t addr, uint32_t len)
+{
+    for (; len != 0; len--) *(volatile uint8_t *)(SRAM_BASE_ADDR + addr++) = *pbuf++;
+}
+
+static void bench_byte_read(uint8_t *pbuf, uint32_t addr, uint32_t len)
+{
+    for (; len != 0; len--) *pbuf++ = *(volatile uint8_t *)(SRAM_BASE_ADDR + addr++);
+}
+
+static void bench_print(uint32_t v, uint8_t bad)
+{
+    printf(" %6u.%u%c", v / 10, v % 10, bad ? '!' : ' ');
+}
+
+/**
+ * @brief       运行吞吐量测试, 结果输出到串口1
+ * @param       无
+ * @retval      无
+ */
+void sram_bench(void)
+{
+    uint8_t *buf, *chk, *ext;
+    uint32_t addr, i, k, r, n, t0, cyc[7], bad[7];
+
+    buf = mymalloc(SRAMIN, SRAM_BENCH_MAX + 4);
+    chk = mymalloc(SRAMIN, SRAM_BENCH_MAX + 4);
+    ext = mymalloc(SRAMEX, SRAM_BENCH_MAX + 4);
+    if (!buf || !chk || !ext) {
+        printf("sram_bench: 内存不足\r\n");
+        goto out;
+    }
+    addr = (uint32_t)ext - SRAM_BASE_ADDR;
+    for (i = 0; i < SRAM_BENCH_MAX + 4; i++) buf[i] = (uint8_t)(i * 7 + 3);
+    bench_dwt_init();
+
+    printf("\r\nSRAM 吞吐量 (MB/s), HCLK %u MHz\r\n", SystemCoreClock / 1000000);
+    printf("%6s | %8s %8s %8s %8s %8s | %8s %8s\r\n", "bytes", "wr byte", "wr cpu", "wr cpu+1", "wr dma", "dma(cpu)",
+           "rd cpu", "rd dma");
+
+    for (k = 0; k < sizeof(g_sizes) / sizeof(g_sizes[0]); k++) {
+        n = g_sizes[k];
+        memset(cyc, 0, sizeof(cyc));
+        memset(bad, 0, sizeof(bad));
+        for (r = 0; r < SRAM_BENCH_ROUNDS; r++) {
+            t0 = DWT->CYCCNT;
+            bench_byte_write(buf, addr, n);
+            cyc[0] += DWT->CYCCNT - t0;
+            bench_byte_read(chk, addr, n);
+            bad[0] |= memcmp(chk, buf, n) != 0;
+
+            t0 = DWT->CYCCNT;
+            sram_write(buf, addr, n);
+            cyc[1] += DWT->CYCCNT - t0;
+
+            t0 = DWT->CYCCNT;
+            sram_read(chk, addr, n);
+            cyc[5] += DWT->CYCCNT - t0;
+            bad[1] |= bad[5] |= memcmp(chk, buf, n) != 0;
+
+            t0 = DWT->CYCCNT;
+            sram_write(buf + 1, addr, n);
+            cyc[2] += DWT->CYCCNT - t0;
+            sram_read(chk, addr, n);
+            bad[2] |= memcmp(chk, buf + 1, n) != 0;
+
+            t0 = DWT->CYCCNT;
+            sram_write_dma(buf, addr, n, NULL, NULL);
+            cyc[4] += DWT->CYCCNT - t0;
+            sram_dma_wait();
+            cyc[3] += DWT->CYCCNT - t0;
+
+            memset(chk, 0, n);
+            t0 = DWT->CYCCNT;
+            sram_read_dma(chk, addr, n, NULL, NULL);
+            sram_dma_wait();
+            cyc[6] += DWT->CYCCNT - t0;
+            bad[3] |= bad[6] |= memcmp(chk, buf, n) != 0;
+        }
+
+        printf("%6u |", n);
+        for (i = 0; i < 5; i++) bench_print(bench_rate(n, cyc[i]), bad[i]);
+        printf(" |");
+        bench_print(bench_rate(n, cyc[5]), bad[5]);
+        bench_print(bench_rate(n, cyc[6]), bad[6]);
+        printf("\r\n");
+    }
+
+out:
+    myfree(SRAMIN, buf);
+    myfree(SRAMIN, chk);
+    myfree(SRAMEX, ext);
+}
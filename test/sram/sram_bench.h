@@ -0,0 +1,13 @@
+/**
+ ****************************************************************************************************
+ * @file        sram_bench.h
+ * @brief       外扩SRAM 读写吞吐量测试 (板上运行)
+ ****************************************************************************************************
+ */
+
+#ifndef __SRAM_BENCH_H
+#define __SRAM_BENCH_H
+
+void sram_bench(void);
+
+#endif